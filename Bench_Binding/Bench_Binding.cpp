@@ -0,0 +1,633 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (C) 2024 Florian Thake, <contact |at| tea-age.solutions>.
+ * SPDX-License-Identifier: MIT
+ */
+
+// Benchmarking the binding of a frame in host memory (e.g. a camera frame) to TeaScript VS ChaiScript VS C++.
+//
+// The frame lives in a std::vector or in a memory mapped file of several hundred MB and is exposed to the engine as
+// cheap as possible (by reference where the engine supports it, otherwise by move or copy). Then a script does some
+// reads and writes spread over the whole frame. The measured time is the time of the accesses, in addition reported are
+//   bind-us         - the time for make the frame available to the engine,
+//   bind-heap-bytes - the heap bytes retained by the binding (a hidden copy shows up here, needs BENCH_ALLOC_HOOKS),
+//   same-address    - 1 if the engine accesses the host memory (checked via the address of the data),
+//   host-visible    - 1 if the writes of the script are visible in the host memory afterwards.
+
+// === BENCH CONFIG ===
+
+#define BENCH_ENABLE_CHAI  1                    // 1 == Enable ChaiScript, 0 == Disable
+#define BENCH_ENABLE_TEA   1                    // 1 == Enable TeaScript, 0 == Disable
+
+#define BENCH_WARMUP_RUNS      1                // runs of each test before measuring (not part of the statistic).
+#define BENCH_MIN_RUNS         3                // minimum count of measured runs for each test.
+#define BENCH_MAX_RUNS         10               // maximum count of measured runs for each test.
+#define BENCH_TARGET_REL_ERROR 0.05             // repeat until the 95% confidence interval of the mean is within +-5% (or BENCH_MAX_RUNS is reached).
+
+#define BENCH_FRAME_MB         256              // default for --size-mb, the size of the frame.
+#define BENCH_ACCESSES         1000000          // default for --accesses, count of read + write accesses spread over the frame.
+#define BENCH_FRAME_FILE       "bench_frame.bin" // default for --file (in the temp directory), the mapped file (created and removed).
+
+// NOTE: all tests of the enabled languages are compiled in. Which are run and with which parameters can be selected
+//       via command line, e.g. --source=vector,mmap --size-mb=512 --engine=tea-view,chai-ref (see --help)
+
+
+// handle some annoying compile errors on MSVC
+#if defined _MSC_VER  && !defined _SILENCE_CXX17_CODECVT_HEADER_DEPRECATION_WARNING
+# define _SILENCE_CXX17_CODECVT_HEADER_DEPRECATION_WARNING
+#endif
+#if defined _MSC_VER  && !defined _SILENCE_CXX20_U8PATH_DEPRECATION_WARNING
+# define _SILENCE_CXX20_U8PATH_DEPRECATION_WARNING
+#endif
+#if defined _MSC_VER  && !defined _CRT_SECURE_NO_WARNINGS
+# define _CRT_SECURE_NO_WARNINGS
+#endif
+
+//for VS use /Zc:__cplusplus
+#if __cplusplus < 202002L
+# if defined _MSVC_LANG // fallback without /Zc:__cplusplus
+#  if !_HAS_CXX20
+#   error must use at least C++20
+#  endif
+# else
+#  error must use at least C++20
+# endif
+#endif
+
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib> // EXIT_SUCCESS
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#if defined( _WIN32 )
+# if !defined NOMINMAX
+#  define NOMINMAX
+# endif
+# if !defined WIN32_LEAN_AND_MEAN
+#  define WIN32_LEAN_AND_MEAN
+# endif
+# include <windows.h>
+#else
+# include <fcntl.h>
+# include <sys/mman.h>
+# include <unistd.h>
+#endif
+
+#include "../Common/BenchCore.hpp"
+#include "../Common/BenchCmdLine.hpp"
+#if !defined BENCH_DRIVER
+# define BENCH_ALLOC_IMPLEMENTATION // this is the main translation unit
+#endif
+#include "../Common/BenchMain.hpp"
+
+#if BENCH_ENABLE_TEA
+#include <teascript/Engine.hpp>
+#endif
+#if BENCH_ENABLE_CHAI
+#if defined(_WIN32)
+#  define NOMINMAX
+#  define WIN32_LEAN_AND_MEAN
+# endif
+# if defined( _MSC_VER )
+#  pragma warning( push )
+#  pragma warning( disable: 4244 )
+# endif
+#include <chaiscript/chaiscript.hpp>
+# if defined( _MSC_VER )
+#  pragma warning( pop )
+# endif
+#endif
+
+
+namespace {
+
+// a file mapped read/write into memory. the file is created with the given size and removed in the destructor.
+class MappedFile
+{
+    std::string     mPath;
+    unsigned char  *mpData = nullptr;
+    size_t          mSize  = 0;
+#if defined( _WIN32 )
+    HANDLE          mFile    = INVALID_HANDLE_VALUE;
+    HANDLE          mMapping = nullptr;
+#else
+    int             mFd = -1;
+#endif
+
+public:
+    MappedFile( std::string path, size_t const size )
+        : mPath( std::move( path ) )
+        , mSize( size )
+    {
+#if defined( _WIN32 )
+        mFile = CreateFileA( mPath.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr );
+        if( mFile == INVALID_HANDLE_VALUE ) {
+            throw std::runtime_error( "cannot create " + mPath );
+        }
+        mMapping = CreateFileMappingA( mFile, nullptr, PAGE_READWRITE, static_cast<DWORD>(static_cast<std::uint64_t>(size) >> 32),
+                                       static_cast<DWORD>(size & 0xFFFFFFFFu), nullptr );
+        if( mMapping != nullptr ) {
+            mpData = static_cast<unsigned char *>(MapViewOfFile( mMapping, FILE_MAP_ALL_ACCESS, 0, 0, size ));
+        }
+#else
+        mFd = ::open( mPath.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600 );
+        if( mFd < 0 ) {
+            throw std::runtime_error( "cannot create " + mPath );
+        }
+        if( ::ftruncate( mFd, static_cast<off_t>(size) ) == 0 ) {
+            void *p = ::mmap( nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, mFd, 0 );
+            mpData  = p == MAP_FAILED ? nullptr : static_cast<unsigned char *>(p);
+        }
+#endif
+        if( mpData == nullptr ) {
+            Close();
+            throw std::runtime_error( "cannot map " + mPath );
+        }
+    }
+
+    ~MappedFile()
+    {
+        Close();
+    }
+
+    MappedFile( MappedFile const & ) = delete;
+    MappedFile &operator=( MappedFile const & ) = delete;
+
+    unsigned char *Data() const noexcept { return mpData; }
+    size_t Size() const noexcept { return mSize; }
+
+private:
+    void Close() noexcept
+    {
+#if defined( _WIN32 )
+        if( mpData != nullptr ) {
+            UnmapViewOfFile( mpData );
+        }
+        if( mMapping != nullptr ) {
+            CloseHandle( mMapping );
+        }
+        if( mFile != INVALID_HANDLE_VALUE ) {
+            CloseHandle( mFile );
+            DeleteFileA( mPath.c_str() );
+        }
+        mMapping = nullptr;
+        mFile    = INVALID_HANDLE_VALUE;
+#else
+        if( mpData != nullptr ) {
+            ::munmap( mpData, mSize );
+        }
+        if( mFd >= 0 ) {
+            ::close( mFd );
+            ::unlink( mPath.c_str() );
+        }
+        mFd = -1;
+#endif
+        mpData = nullptr;
+    }
+};
+
+// a view to the frame in host memory, this is bound by reference where possible.
+struct Frame
+{
+    unsigned char  *data = nullptr;
+    size_t          size = 0;
+};
+
+// the frame in host memory: a std::vector or a mapped file.
+struct HostFrame
+{
+    std::vector<unsigned char>   vec;
+    std::unique_ptr<MappedFile>  file;
+
+    Frame View() noexcept
+    {
+        return file ? Frame{ file->Data(), file->Size() } : Frame{ vec.data(), vec.size() };
+    }
+};
+
+// reading / writing unsigned 32 bit data in host byte order. mimic the CoreLibrary behavior but without TeaScript types (0 / false on error).
+unsigned long long FrameGetU32( Frame const &f, size_t const pos )
+{
+    std::uint32_t  val = 0;
+    if( pos > f.size || f.size - pos < sizeof( val ) ) {
+        return 0;
+    }
+    ::memcpy( &val, f.data + pos, sizeof( val ) );
+    return val;
+}
+
+bool FrameSetU32( Frame &f, size_t const pos, unsigned long long const val )
+{
+    if( val > std::numeric_limits<std::uint32_t>::max() ) {
+        return false;
+    }
+    auto const valu32 = static_cast<std::uint32_t>(val);
+    if( pos > f.size || f.size - pos < sizeof( valu32 ) ) {
+        return false;
+    }
+    ::memcpy( f.data + pos, &valu32, sizeof( valu32 ) );
+    return true;
+}
+
+
+// binds the frame and runs the accesses: bind() makes the frame available to the engine and returns the address of the data
+// the engine will use, run() does the accesses (the measured region), unbind() is called after (e.g. for move the frame back).
+template< typename Bind, typename Run, typename Unbind >
+double measure_binding( HostFrame &host, Bind &&bind, Run &&run, Unbind &&unbind )
+{
+    auto const  host_address = host.View().data;
+    auto const  before       = FrameGetU32( host.View(), 0 );
+    void const *address      = nullptr;
+    double       bind_secs   = 0.0;
+    std::int64_t bind_heap   = 0;
+    {
+        bench::HeapScope  heap;
+        auto const start = bench::Clock::now();
+        address          = bind();
+        auto const end   = bench::Clock::now();
+        bind_secs = bench::CalcTimeInSecs( start, end );
+        bind_heap = heap.LiveBytes();
+    }
+
+    auto const secs = run();
+    unbind();
+    if( secs < 0.0 ) {
+        return -1.0;
+    }
+
+    // each run increments the value at position 0 once.
+    bool const visible = FrameGetU32( host.View(), 0 ) == ((before + 1) & 0xFFFFFFFFu);
+    bench::AddMetric( "bind-us", bind_secs * 1e6 );
+    bench::AddMetric( "bind-heap-bytes", static_cast<double>(bind_heap) );
+    bench::AddMetric( "same-address", address == host_address ? 1.0 : 0.0 );
+    bench::AddMetric( "host-visible", visible ? 1.0 : 0.0 );
+
+    return secs;
+}
+
+constexpr auto no_unbind = [] {};
+
+
+// the reference: direct access to the host memory.
+double exec_cpp( HostFrame &host, long long const accesses, size_t const stride )
+{
+    Frame  frame;
+    return measure_binding( host, [&] { frame = host.View(); return frame.data; },
+                            [&] {
+                                auto start = bench::Start();
+                                for( long long i = 0; i < accesses; ++i ) {
+                                    auto const pos = static_cast<size_t>(i) * stride;
+                                    FrameSetU32( frame, pos, (FrameGetU32( frame, pos ) + 1) & 0xFFFFFFFFu );
+                                }
+                                auto end = bench::Stop();
+
+                                bench::PrintValue( accesses );
+
+                                return bench::CalcTimeInSecs( start, end );
+                            }, no_unbind );
+}
+
+
+#if BENCH_ENABLE_TEA
+constexpr char tea_code_buf[] = R"_SCRIPT_(
+forall( i in _seq( 0, accesses - 1, 1 ) ) {
+    const pos := i * stride
+    _buf_set_u32( buf, pos, (((_buf_get_u32( buf, pos ) as i64) + 1) bit_and 4294967295) as u64 )
+}
+accesses
+)_SCRIPT_";
+
+// frame_get_u32 and frame_set_u32 are registered by the host and access the host memory.
+constexpr char tea_code_view[] = R"_SCRIPT_(
+forall( i in _seq( 0, accesses - 1, 1 ) ) {
+    const pos := i * stride
+    frame_set_u32( pos, (((frame_get_u32( pos ) as i64) + 1) bit_and 4294967295) as u64 )
+}
+accesses
+)_SCRIPT_";
+
+// we use our own engine for get access to the Context.
+class MyEngine : public teascript::Engine
+{
+public:
+#if TEASCRIPT_VERSION >= TEASCRIPT_BUILD_VERSION_NUMBER(0,14,0)
+    inline teascript::Parser &GetParser() noexcept { return mBuildTools->mParser; }
+#else
+    inline teascript::Parser &GetParser() noexcept { return mParser; }
+#endif
+    inline teascript::Context &GetContext() noexcept { return mContext; }
+};
+
+double run_tea( MyEngine &engine, char const *code )
+{
+    try {
+        auto teares = teascript::ValueObject();
+        auto ast    = engine.GetParser().Parse( code );
+        auto start  = bench::Start();
+        teares      = ast->Eval( engine.GetContext() );
+        auto end    = bench::Stop();
+
+        bench::PrintValue( teares.GetAsInteger() );
+
+        return bench::CalcTimeInSecs( start, end );
+
+    } catch( teascript::exception::runtime_error const &ex ) {
+        teascript::util::pretty_print( ex );
+    } catch( std::exception const &ex ) {
+        puts( ex.what() );
+    }
+    return -1.0;
+}
+
+// TeaScript cannot bind external memory to a Buffer:
+// Copy - a new Buffer with a copy of the frame (the writes are not visible in the host memory).
+// Move - the std::vector is moved into the Buffer and back after (only for the vector source).
+// View - the frame is accessed via registered host functions.
+enum class eTeaBinding { Copy, Move, View };
+
+template< eTeaBinding Binding >
+double exec_tea( HostFrame &host, long long const accesses, size_t const stride )
+{
+    MyEngine  engine;
+    engine.AddConst( "accesses", accesses );
+    engine.AddConst( "stride", static_cast<long long>(stride) );
+    teascript::ValueObject  val_buf;
+    Frame                   frame;
+
+    auto const bind = [&]() -> void const * {
+        if constexpr( Binding == eTeaBinding::View ) {
+            frame = host.View();
+            engine.RegisterUserCallback( "frame_get_u32", [&frame]( teascript::Context &rContext ) {
+                auto const pos = rContext.ConsumeParam().GetAsInteger();
+                return teascript::ValueObject( static_cast<teascript::U64>(FrameGetU32( frame, static_cast<size_t>(pos) )) );
+            } );
+            engine.RegisterUserCallback( "frame_set_u32", [&frame]( teascript::Context &rContext ) {
+                auto const pos = rContext.ConsumeParam().GetAsInteger();
+                auto const val = rContext.ConsumeParam().GetAsInteger();
+                return teascript::ValueObject( FrameSetU32( frame, static_cast<size_t>(pos), static_cast<unsigned long long>(val) ) );
+            } );
+            return frame.data;
+        } else {
+            if constexpr( Binding == eTeaBinding::Move ) {
+                val_buf = teascript::ValueObject( std::move( host.vec ), teascript::ValueConfig( true ) );
+            } else {
+                auto const view = host.View();
+                val_buf = teascript::ValueObject( teascript::Buffer( view.data, view.data + view.size ), teascript::ValueConfig( true ) );
+            }
+            engine.AddSharedValueObject( "buf", val_buf );
+            return val_buf.GetValue<teascript::Buffer>().data(); // shared, the same object as in the engine.
+        }
+    };
+    auto const unbind = [&] {
+        if constexpr( Binding == eTeaBinding::Move ) {
+            host.vec = std::move( val_buf.GetValue<teascript::Buffer>() );
+        }
+    };
+
+    return measure_binding( host, bind, [&] { return run_tea( engine, Binding == eTeaBinding::View ? tea_code_view : tea_code_buf ); }, unbind );
+}
+#endif
+
+
+#if BENCH_ENABLE_CHAI
+// the same for std::vector.
+unsigned long long BufGetU32_Cpp( std::vector<unsigned char> const &rBuffer, size_t const pos )
+{
+    return FrameGetU32( Frame{ const_cast<unsigned char *>(rBuffer.data()), rBuffer.size() }, pos );
+}
+
+bool BufSetU32_Cpp( std::vector<unsigned char> &rBuffer, size_t const pos, unsigned long long const val )
+{
+    Frame  f{ rBuffer.data(), rBuffer.size() };
+    return FrameSetU32( f, pos, val );
+}
+
+// _buf_get_u32 and _buf_set_u32 are registered for std::vector and for Frame.
+constexpr char chai_code[] = R"_SCRIPT_(
+for( var i = 0; i < accesses; ++i ) {
+    var pos = i * stride;
+    _buf_set_u32( buf, pos, (_buf_get_u32( buf, pos ) + 1) & 4294967295 );
+}
+accesses;
+)_SCRIPT_";
+
+// Copy - chaiscript::var( vector ), copies the frame (only for the vector source).
+// Ref  - chaiscript::var( std::ref( vector ) ) (only for the vector source).
+// View - chaiscript::var( std::ref( frame ) ), a view to the host memory.
+enum class eChaiBinding { Copy, Ref, View };
+
+template< eChaiBinding Binding >
+double exec_chai( HostFrame &host, long long const accesses, size_t const stride )
+{
+    chaiscript::ChaiScript chai;
+    chai.add( chaiscript::bootstrap::standard_library::vector_type<std::vector<unsigned char>>( "Buffer" ) );
+    chai.add( chaiscript::user_type<Frame>(), "Frame" );
+    chai.add( chaiscript::fun( BufGetU32_Cpp ), "_buf_get_u32" );
+    chai.add( chaiscript::fun( BufSetU32_Cpp ), "_buf_set_u32" );
+    chai.add( chaiscript::fun( FrameGetU32 ), "_buf_get_u32" );
+    chai.add( chaiscript::fun( FrameSetU32 ), "_buf_set_u32" );
+    chai.add( chaiscript::const_var( accesses ), "accesses" );
+    chai.add( chaiscript::const_var( static_cast<long long>(stride) ), "stride" );
+    auto ast = chai.parse( chai_code );
+    Frame  frame;
+
+    auto const bind = [&]() -> void const * {
+        if constexpr( Binding == eChaiBinding::View ) {
+            frame = host.View();
+            auto const bv = chaiscript::var( std::ref( frame ) );
+            chai.add( bv, "buf" );
+            return chaiscript::boxed_cast<Frame &>(bv).data;
+        } else {
+            // the added Boxed_Value shares its object with the engine, so no eval is needed for get the address.
+            auto const bv = Binding == eChaiBinding::Copy ? chaiscript::var( host.vec ) : chaiscript::var( std::ref( host.vec ) );
+            chai.add( bv, "buf" );
+            return chaiscript::boxed_cast<std::vector<unsigned char> &>(bv).data();
+        }
+    };
+    auto const run = [&] {
+        try {
+            auto start = bench::Start();
+            auto chres = chai.eval( *ast );
+            auto end   = bench::Stop();
+
+            bench::PrintValue( chaiscript::boxed_cast<long long>(chres) );
+
+            return bench::CalcTimeInSecs( start, end );
+
+        } catch( chaiscript::Boxed_Value const &bv ) {
+            puts( chaiscript::boxed_cast<chaiscript::exception::eval_error const &>(bv).what() );
+        } catch( std::exception const &ex ) {
+            puts( ex.what() );
+        }
+        return -1.0;
+    };
+
+    return measure_binding( host, bind, run, no_unbind );
+}
+#endif
+
+
+// prints the binding metrics of all records since first.
+void print_summary( size_t const first )
+{
+    if( first >= bench::Records().size() ) {
+        return;
+    }
+    auto const flags = std::cout.flags();
+    auto const prec  = std::cout.precision();
+    std::cout << "\nbinding summary (median time, mean of the metrics):\n";
+    std::cout << std::left << std::setw( 8 ) << "source" << std::setw( 40 ) << "test" << std::right << std::setw( 12 ) << "bind [us]"
+              << std::setw( 14 ) << "bind heap MB" << std::setw( 10 ) << "same addr" << std::setw( 9 ) << "visible" << std::setw( 12 ) << "ns/access" << '\n';
+    std::cout << std::fixed << std::setprecision( 1 );
+    for( auto i = first; i < bench::Records().size(); ++i ) {
+        auto const &r = bench::Records()[i];
+        std::string source;
+        for( auto const &[name, value] : r.params ) {
+            if( name == "source" ) {
+                source = value;
+            }
+        }
+        double bind = 0.0, heap = 0.0, same = 0.0, visible = 0.0;
+        for( auto const &[name, value] : r.result.metrics ) {
+            if( name == "bind-us" ) {
+                bind = value;
+            } else if( name == "bind-heap-bytes" ) {
+                heap = value;
+            } else if( name == "same-address" ) {
+                same = value;
+            } else if( name == "host-visible" ) {
+                visible = value;
+            }
+        }
+        std::cout << std::left << std::setw( 8 ) << source << std::setw( 40 ) << r.title << std::right << std::setw( 12 ) << bind
+                  << std::setw( 14 ) << heap / (1024.0 * 1024.0) << std::setw( 10 ) << (same > 0.5 ? "yes" : "no")
+                  << std::setw( 9 ) << (visible > 0.5 ? "yes" : "no") << std::setw( 12 ) << r.result.stats.median / r.ops * 1e9 << '\n';
+    }
+    std::cout << std::flush;
+    std::cout.flags( flags );
+    std::cout.precision( prec );
+}
+
+} // namespace
+
+
+void PrintUsageBinding()
+{
+    std::cout << "Binding options:\n"
+                 "  --source=vector,mmap         where the frame lives in host memory (default: all)\n"
+                 "  --size-mb=N                  size of the frame in MB (default: " << BENCH_FRAME_MB << ")\n"
+                 "  --accesses=N                 count of read + write accesses spread over the frame (default: " << BENCH_ACCESSES << ")\n"
+                 "  --file=PATH                  the mapped file, created and removed (default: " << BENCH_FRAME_FILE << " in the temp directory)\n"
+                 "engines: cpp, tea-copy, tea-move (vector only), tea-view (host functions), chai-copy (vector only),\n"
+                 "         chai-ref (vector only), chai-view (std::ref to a view)\n";
+}
+
+int BenchBinding( bench::CmdLine const &cmd )
+{
+    if( cmd.Has( "help" ) ) {
+        PrintUsageBinding();
+        return EXIT_SUCCESS;
+    }
+
+    bench::ApplyConfig( cmd );
+    bench::SetEngineVersion( "cpp", bench::CompilerVersion() );
+#if BENCH_ENABLE_TEA
+    bench::SetEngineVersion( "tea", bench::VersionString( TEASCRIPT_VERSION_MAJOR, TEASCRIPT_VERSION_MINOR, TEASCRIPT_VERSION_PATCH ) );
+#endif
+#if BENCH_ENABLE_CHAI
+    bench::SetEngineVersion( "chai", chaiscript::Build_Info::version() );
+#endif
+
+    if( !bench::HeapScope::Available() ) {
+        std::cout << "NOTE: allocation hooks are not built in (BENCH_ALLOC_HOOKS), the heap bytes are not available." << std::endl;
+    }
+
+    auto const sources  = cmd.GetList( "source", { "vector", "mmap" } );
+    auto const size_mb  = cmd.GetInt( "size-mb", BENCH_FRAME_MB );
+    auto const accesses = cmd.GetInt( "accesses", BENCH_ACCESSES );
+    auto const path     = cmd.Get( "file", (std::filesystem::temp_directory_path() / BENCH_FRAME_FILE).string() );
+    if( size_mb < 1 || accesses < 1 ) {
+        std::cout << "Wrong parameters: size-mb and accesses must be >= 1." << std::endl;
+        return EXIT_FAILURE;
+    }
+    auto const size   = static_cast<size_t>(size_mb) * 1024 * 1024;
+    // the accesses are spread over the whole frame (4 byte aligned).
+    auto const stride = std::max<size_t>( size / 4 / static_cast<size_t>(accesses), 1 ) * 4;
+    if( static_cast<size_t>(accesses - 1) * stride + 4 > size ) {
+        std::cout << "Wrong parameters: too many accesses for the size of the frame." << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::cout << "Benchmarking the binding of a frame in host memory to TeaScript and ChaiScript.\n";
+
+    auto const first = bench::Records().size();
+    int failed = 0;
+    for( auto const &source : sources ) {
+        HostFrame  host;
+        try {
+            if( source == "vector" ) {
+                host.vec.resize( size );
+            } else if( source == "mmap" ) {
+                host.file = std::make_unique<MappedFile>( path, size );
+            } else {
+                std::cout << "Unknown source: " << source << std::endl;
+                return EXIT_FAILURE;
+            }
+        } catch( std::exception const &ex ) {
+            std::cout << ex.what() << std::endl;
+            return EXIT_FAILURE;
+        }
+        // a pattern, this touches all pages before.
+        auto const view = host.View();
+        for( size_t pos = 0; pos + 4 <= view.size; pos += 4 ) {
+            auto const val = static_cast<std::uint32_t>(pos * 2654435761u);
+            ::memcpy( view.data + pos, &val, 4 );
+        }
+        [[maybe_unused]] bool const vec = source == "vector";
+
+        bench::Suite  suite( cmd, "binding", { { "source", source }, { "size-mb", std::to_string( size_mb ) }, { "accesses", std::to_string( accesses ) } } );
+        suite.SetOps( static_cast<double>(accesses), "access" );
+
+        suite.Add( "cpp", "pure C++", [&] { return exec_cpp( host, accesses, stride ); } );
+#if BENCH_ENABLE_TEA
+        suite.Add( "tea-copy", "TeaScript Buffer (copy)", [&] { return exec_tea<eTeaBinding::Copy>( host, accesses, stride ); } );
+        if( vec ) {
+            suite.Add( "tea-move", "TeaScript Buffer (move)", [&] { return exec_tea<eTeaBinding::Move>( host, accesses, stride ); } );
+        }
+        suite.Add( "tea-view", "TeaScript host functions", [&] { return exec_tea<eTeaBinding::View>( host, accesses, stride ); } );
+#endif
+#if BENCH_ENABLE_CHAI
+        if( vec ) {
+            suite.Add( "chai-copy", "ChaiScript var( vector )", [&] { return exec_chai<eChaiBinding::Copy>( host, accesses, stride ); } );
+            suite.Add( "chai-ref", "ChaiScript var( std::ref( vector ) )", [&] { return exec_chai<eChaiBinding::Ref>( host, accesses, stride ); } );
+        }
+        suite.Add( "chai-view", "ChaiScript var( std::ref( view ) )", [&] { return exec_chai<eChaiBinding::View>( host, accesses, stride ); } );
+#endif
+
+        failed += suite.Run();
+    }
+
+    print_summary( first );
+
+    return failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+#if !defined BENCH_DRIVER
+int main( int argc, char *argv[] )
+{
+    bench::GetConfig() = { .warmup_runs = BENCH_WARMUP_RUNS, .min_runs = BENCH_MIN_RUNS, .max_runs = BENCH_MAX_RUNS,
+                           .target_rel_error = BENCH_TARGET_REL_ERROR };
+
+    return bench::Main( argc, argv, &BenchBinding );
+}
+#endif
@@ -7,13 +7,18 @@
 // Benchmarking overhead of Buffer manipulating TeaScript code VS ChaiScript VS TeaScript CoreLibrary VS C++
 // 
 // doing this by filling a rgb(a) buffer in FUll HD resolution (1920 x 1080) or in UHD (3840 x 2160)
+//
+// the bulk tests fill the same image with one call (script side) or with std::fill / memcpy / SIMD stores (C++).
+// they show the ceiling, all results are also reported in GB/s relative to the measured memory write bandwidth.
+//
+// the kernels (--kernel) read and write: grayscale, alpha blending of two images, a 3x3 box blur and a lookup table per channel.
 
 
 // === BENCH CONFIG ===
 
 #define BENCH_IMAGE_FHD         1                   // option to use Full HD resolution (1920 x 1080)
 #define BENCH_IMAGE_UHD         2                   // option to use UHD resolution (3840 x 2160)
-#define BENCH_IMAGE_RESOLUTION  BENCH_IMAGE_FHD     // decide which resolution shall be used for the benchmark.
+#define BENCH_IMAGE_RESOLUTION  BENCH_IMAGE_FHD     // default for --resolution, decide which resolution shall be used for the benchmark.
 
 #if BENCH_IMAGE_RESOLUTION ==  BENCH_IMAGE_FHD      // Full HD
 #define BENCH_IMAGE_WIDTH   1920 
@@ -25,7 +30,10 @@
 #error Wrong resolution configuration!
 #endif
 
-#define BENCH_ITERATIONS   3                    // loop count for each test.
+#define BENCH_WARMUP_RUNS      1                // runs of each test before measuring (not part of the statistic).
+#define BENCH_MIN_RUNS         5                // minimum count of measured runs for each test.
+#define BENCH_MAX_RUNS         30               // maximum count of measured runs for each test.
+#define BENCH_TARGET_REL_ERROR 0.02             // repeat until the 95% confidence interval of the mean is within +-2% (or BENCH_MAX_RUNS is reached).
 
 #define BENCH_ENABLE_TEACODE         1
 #define BENCH_ENABLE_TEA_COMPILE     1          // only possible with version >= 0.14
@@ -33,6 +41,18 @@
 #define BENCH_ENABLE_CORE_LIB        1
 #define BENCH_ENABLE_CORE_LIB_FUNC   1
 #define BENCH_ENABLE_CPP             1
+#define BENCH_ENABLE_BULK_SCRIPT     1          // _buf_fill and a registered bulk fill function for TeaScript and ChaiScript
+#define BENCH_ENABLE_BULK_CPP        1          // std::fill, memcpy and SIMD (AVX2 or SSE2, if available) fill in C++
+
+#define BENCH_BANDWIDTH_MB           256        // size of the buffer for measure the memory write bandwidth (should be much larger than the caches).
+
+#define BENCH_BLEND_ALPHA            96         // alpha (0..256) of the src image for --kernel=blend.
+
+#define BENCH_CHUNK_PIXELS           4          // pixels per chunk for --partition=chunks,interleave (4 pixels == 16 bytes, 4 threads share one cache line).
+
+// NOTE: all enabled tests are compiled in. Which are run and with which resolution(s) can be selected
+//       via command line, e.g. --resolution=fhd,uhd --engine=tea-vm,chai (see --help)
+//       with --bands=1,2,4,8 N threads fill disjoint parts of one shared image instead, each with its own engine (see --partition).
 
 
 // handle some annoying compile errors on MSVC
@@ -63,6 +83,10 @@
 #if TEASCRIPT_VERSION < TEASCRIPT_BUILD_VERSION_NUMBER(0,13,0)
 # error Use TeaScript 0.13.0 or newer
 #endif
+#if TEASCRIPT_VERSION >= TEASCRIPT_BUILD_VERSION_NUMBER(0,14,0)
+#include <teascript/StackVMCompiler.hpp>
+#include <teascript/StackMachine.hpp>
+#endif
 
 #if BENCH_ENABLE_CHAI
 #if defined(_WIN32)
@@ -80,25 +104,37 @@
 #endif
 
 
+#include <algorithm>
 #include <cstdlib> // EXIT_SUCCESS
 #include <cstdio>
+#include <cstring>
+#include <cstdint>
 #include <iostream>
 #include <chrono>
+#include <functional>
+#include <map>
+#include <type_traits>
+#include <vector>
+
+#if defined( __AVX2__ )
+# include <immintrin.h>
+# define BENCH_SIMD_NAME  "AVX2"
+#elif defined( __SSE2__ ) || defined( _M_X64 ) || (defined( _M_IX86_FP ) && _M_IX86_FP >= 2)
+# include <emmintrin.h>
+# define BENCH_SIMD_NAME  "SSE2"
+#else
+# define BENCH_SIMD_NAME  "no SIMD"
+#endif
 
+#include "../Common/BenchCore.hpp"
+#include "../Common/BenchCmdLine.hpp"
+#if !defined BENCH_DRIVER
+# define BENCH_ALLOC_IMPLEMENTATION // this is the main translation unit
+#endif
+#include "../Common/BenchMain.hpp"
 
-// for time measurement...
-
-auto Now()
-{
-    return std::chrono::steady_clock::now();
-}
-
-double CalcTimeInSecs( auto s, auto e )
-{
-    std::chrono::duration<double> const  timesecs = e - s;
-    return timesecs.count();
-}
 
+namespace {
 
 constexpr char tea_code_prepare[] = R"_SCRIPT_(
 is_defined make_rgb or (func make_rgb( r, g, b ) { r bit_lsh 16 bit_or g bit_lsh 8 bit_or b })
@@ -118,6 +154,18 @@ forall( pixel in _seq( 0, width*height - 1, 1) ) {
 _buf_size( buf ) // return sth...
 )_SCRIPT_";
 
+// _buf_fill can only fill with an u8, so this is a gray image, but with the same count of bytes.
+constexpr char tea_code_fill[] = R"_SCRIPT_(
+_buf_fill( buf, 0, (width*height - 1) * 4, 128u8 )
+_buf_size( buf ) // return sth...
+)_SCRIPT_";
+
+// buf_fill_u32 is registered by the host.
+constexpr char tea_code_fill_u32[] = R"_SCRIPT_(
+buf_fill_u32( buf, 0, width*height - 1, green )
+_buf_size( buf ) // return sth...
+)_SCRIPT_";
+
 
 // we use our own engine for get access to the low level parts.
 class MyEngine : public teascript::Engine
@@ -135,22 +183,42 @@ public:
     inline teascript::Context const &GetContext() const noexcept { return mContext; }
 };
 
-double exec_tea()
+bool BufFillU32_Cpp( std::vector<unsigned char> &rBuffer, size_t const pos, size_t const count, unsigned long long const val );
+
+// buf_fill_u32( buf, pos, count, val )
+teascript::ValueObject tea_buf_fill_u32( teascript::Context &rContext )
+{
+    if( rContext.CurrentParamCount() != 4 ) {
+        throw teascript::exception::runtime_error( "buf_fill_u32: wrong parameter count!" );
+    }
+    auto val_buf = rContext.ConsumeParam();
+    auto const pos   = rContext.ConsumeParam().GetAsInteger();
+    auto const count = rContext.ConsumeParam().GetAsInteger();
+    auto const val   = rContext.ConsumeParam().GetAsInteger();
+    if( pos < 0 || count < 0 || val < 0 ) {
+        return teascript::ValueObject( false );
+    }
+    return teascript::ValueObject( BufFillU32_Cpp( val_buf.GetValue<teascript::Buffer>(), static_cast<size_t>(pos), static_cast<size_t>(count),
+                                                   static_cast<unsigned long long>(val) ) );
+}
+
+double exec_tea( int const width, int const height, char const *code = tea_code_test )
 {
     MyEngine  engine;
 
-    engine.AddConst( "width", BENCH_IMAGE_WIDTH );
-    engine.AddConst( "height", BENCH_IMAGE_HEIGHT );
+    engine.AddConst( "width", width );
+    engine.AddConst( "height", height );
+    engine.RegisterUserCallback( "buf_fill_u32", tea_buf_fill_u32 );
     engine.ExecuteCode( tea_code_prepare );
-    auto ast = engine.GetParser().Parse( tea_code_test );
+    auto ast = engine.GetParser().Parse( code );
     try {
-        auto start  = Now();
+        auto start  = bench::Start();
         auto teares = ast->Eval( engine.GetContext() );
-        auto end    = Now();
+        auto end    = bench::Stop();
 
-        std::cout << "value: " << teares.GetAsInteger() << std::endl;
+        bench::PrintValue( teares.GetAsInteger() );
 
-        return CalcTimeInSecs( start, end );
+        return bench::CalcTimeInSecs( start, end );
 
     } catch( teascript::exception::runtime_error const &ex ) {
         teascript::util::pretty_print( ex );
@@ -162,22 +230,36 @@ double exec_tea()
 }
 
 #if TEASCRIPT_VERSION >= TEASCRIPT_BUILD_VERSION_NUMBER(0,14,0) && BENCH_ENABLE_TEA_COMPILE
-double exec_tea_compile()
+// compiles the test with the optimization level opt and executes it in a Machine<MachineFlag>.
+// the compile time (without parsing) is added as metric compile-us (not in the worker threads of --threads).
+template< bool MachineFlag = false >
+double exec_tea_compile( int const width, int const height, teascript::eOptimize const opt = teascript::eOptimize::O2 )
 {
-    teascript::Engine  engine;
+    MyEngine  engine;
 
-    engine.AddConst( "width", BENCH_IMAGE_WIDTH );
-    engine.AddConst( "height", BENCH_IMAGE_HEIGHT );
+    engine.AddConst( "width", width );
+    engine.AddConst( "height", height );
     engine.ExecuteCode( tea_code_prepare );
-    auto prog = engine.CompileCode( tea_code_test, teascript::eOptimize::O2 );
+    auto machine = std::make_shared<teascript::StackVM::Machine<MachineFlag>>();
+    teascript::StackVM::Compiler  compiler;
     try {
-        auto start  = Now();
-        auto teares = engine.ExecuteProgram( prog );
-        auto end    = Now();
+        auto ast = engine.GetParser().Parse( tea_code_test );
+        auto const compile_start = bench::Clock::now();
+        auto prog = compiler.Compile( ast, opt );
+        auto const compile_secs = bench::CalcTimeInSecs( compile_start, bench::Clock::now() );
+        if( bench::WorkerIndex() < 0 ) { // the metrics are not thread safe.
+            bench::AddMetric( "compile-us", compile_secs * 1e6 );
+        }
+
+        auto start  = bench::Start();
+        machine->Exec( prog, engine.GetContext() );
+        machine->ThrowPossibleErrorException();
+        auto teares = machine->MoveResult();
+        auto end    = bench::Stop();
 
-        std::cout << "value: " << teares.GetAsInteger() << std::endl;
+        bench::PrintValue( teares.GetAsInteger() );
 
-        return CalcTimeInSecs( start, end );
+        return bench::CalcTimeInSecs( start, end );
 
     } catch( teascript::exception::runtime_error const &ex ) {
         teascript::util::pretty_print( ex );
@@ -187,6 +269,35 @@ double exec_tea_compile()
 
     return -1.0;
 }
+
+// the optimization levels of --tea-sweep.
+struct TeaOptLevel { char const *id; char const *title; teascript::eOptimize opt; };
+constexpr TeaOptLevel tea_opt_levels[] = {
+    { "debug", "Debug", teascript::eOptimize::Debug },
+    { "o0",    "O0",    teascript::eOptimize::O0 },
+    { "o1",    "O1",    teascript::eOptimize::O1 },
+    { "o2",    "O2",    teascript::eOptimize::O2 },
+};
+
+// runs the fill with the AST Eval and in the TeaStackVM with all optimization levels, each in Machine<false>
+// and Machine<true>. prints the compile time, the time per run and the break-even against the AST Eval.
+int run_tea_sweep( bench::CmdLine const &cmd, int const width, int const height )
+{
+    bench::Suite  suite( cmd, "buffer-tea-sweep", { { "width", std::to_string( width ) }, { "height", std::to_string( height ) } } );
+    suite.SetOps( static_cast<double>(width * height - 1), "pixel" );
+    suite.Add( "tea-ast", "TeaScript AST Eval", [=] { return exec_tea( width, height ); } );
+    for( auto const &lvl : tea_opt_levels ) {
+        suite.Add( std::string( "tea-vm-" ) + lvl.id, std::string( "TeaScript TeaStackVM " ) + lvl.title,
+                   [=, opt = lvl.opt] { return exec_tea_compile<false>( width, height, opt ); } );
+        suite.Add( std::string( "tea-vm-" ) + lvl.id + "-mtrue", std::string( "TeaScript TeaStackVM " ) + lvl.title + " Machine<true>",
+                   [=, opt = lvl.opt] { return exec_tea_compile<true>( width, height, opt ); } );
+    }
+
+    auto const first  = bench::Records().size();
+    int const  failed = suite.Run();
+    bench::PrintBreakEven( "TeaScript optimization levels", first, "compile-us", "tea-ast" );
+    return failed;
+}
 #endif
 
 #if BENCH_ENABLE_CHAI
@@ -198,33 +309,38 @@ for( var pixel = 0; pixel < size; ++pixel ) {
 buf.size(); // return sth ...
 )_SCRIPT_";
 
+// _buf_fill_u32 is registered by the host.
+constexpr char chai_code_fill_u32[] = R"_SCRIPT_(
+_buf_fill_u32( buf, 0, width * height - 1, green );
+buf.size(); // return sth ...
+)_SCRIPT_";
+
 bool BufSetU32_Cpp( std::vector<unsigned char> &rBuffer, size_t const pos, unsigned long long const val );
 
-double exec_chai()
+double exec_chai( int const width, int const height, char const *code = chai_code )
 {
     auto make_rgb = []( unsigned char r, unsigned char g, unsigned char b ) { return static_cast<unsigned int>(r) * 256 * 256 + static_cast<unsigned int>(g) * 256 + b; };
     auto const green  = static_cast<unsigned long long>( make_rgb( 0, 255, 0 ) );
-    auto const width  = BENCH_IMAGE_WIDTH;
-    auto const height = BENCH_IMAGE_HEIGHT;
     auto const size   = width * height * 4;
 
     chaiscript::ChaiScript chai;
     std::vector<unsigned char>  buf( size );
     chai.add( chaiscript::bootstrap::standard_library::vector_type<std::vector<unsigned char>>( "Buffer" ) );
     chai.add( chaiscript::fun( BufSetU32_Cpp ), "_buf_set_u32" );
+    chai.add( chaiscript::fun( BufFillU32_Cpp ), "_buf_fill_u32" );
     chai.add( chaiscript::var( buf ), "buf" );
     chai.add( chaiscript::const_var( width ), "width" );
     chai.add( chaiscript::const_var( height ), "height" );
     chai.add( chaiscript::const_var( green ), "green" );
-    auto ast = chai.parse( chai_code );
+    auto ast = chai.parse( code );
     try {
-        auto start = Now();
+        auto start = bench::Start();
         auto chres = chai.eval( *ast );
-        auto end = Now();
+        auto end = bench::Stop();
 
-        std::cout << "value: " << chaiscript::boxed_cast<size_t>(chres) << std::endl;
+        bench::PrintValue( chaiscript::boxed_cast<size_t>(chres) );
 
-        return CalcTimeInSecs( start, end );
+        return bench::CalcTimeInSecs( start, end );
 
     } catch( chaiscript::Boxed_Value const &bv ) {
         puts( chaiscript::boxed_cast<chaiscript::exception::eval_error const &>(bv).what() );
@@ -236,29 +352,27 @@ double exec_chai()
 }
 #endif
 
-double exec_core()
+double exec_core( int const width, int const height )
 {
     auto make_rgb = []( unsigned char r, unsigned char g, unsigned char b ) { return static_cast<unsigned int>(r) * 256 * 256 + static_cast<unsigned int>(g) * 256 + b; };
     auto const green  = make_rgb( 0, 255, 0 );
-    auto const width  = BENCH_IMAGE_WIDTH;
-    auto const height = BENCH_IMAGE_HEIGHT;
     auto const size   = width * height * 4;
     
     auto buf = teascript::CoreLibrary::MakeBuffer( teascript::ValueObject( static_cast<teascript::U64>(size) ) );
     teascript::CoreLibrary::BufFill( buf, teascript::ValueObject( 0LL ), teascript::ValueObject( -1LL ), 0 );
     try {
-        auto start  = Now();
+        auto start  = bench::Start();
 
-        for( size_t pixel = 0; pixel < width * height - 1; ++pixel ) {
+        for( size_t pixel = 0; pixel < static_cast<size_t>(width * height - 1); ++pixel ) {
             teascript::CoreLibrary::BufSetU32( buf, teascript::ValueObject( static_cast<teascript::U64>(pixel * 4) ), static_cast<teascript::U64>(green) );
         }
         
         auto teares = teascript::ValueObject( teascript::CoreLibrary::BufSize( buf ) );
-        auto end    = Now();
+        auto end    = bench::Stop();
 
-        std::cout << "value: " << teares.GetAsInteger() << std::endl;
+        bench::PrintValue( teares.GetAsInteger() );
 
-        return CalcTimeInSecs( start, end );
+        return bench::CalcTimeInSecs( start, end );
 
     } catch( teascript::exception::runtime_error const &ex ) {
         teascript::util::pretty_print( ex );
@@ -270,18 +384,14 @@ double exec_core()
 }
 
 
-
-#define EXEC_CORE_FUNCS_ALWAYS_NEW_VECTOR    0
-
-
-double exec_core_funcs()
+// AlwaysNewVector == true: creates a new parameter vector for each call (instead of only assigning the new position).
+template< bool AlwaysNewVector >
+double exec_core_funcs( int const width, int const height )
 {
     teascript::Context c;
     teascript::CoreLibrary().Bootstrap( c, teascript::config::util() );
     auto make_rgb = []( unsigned char r, unsigned char g, unsigned char b ) { return static_cast<unsigned int>(r) * 256 * 256 + static_cast<unsigned int>(g) * 256 + b; };
     auto const green  = make_rgb( 0, 255, 0 );
-    auto const width  = BENCH_IMAGE_WIDTH;
-    auto const height = BENCH_IMAGE_HEIGHT;
     auto const size   = width * height * 4;
 
     auto val_buf = teascript::ValueObject( teascript::CoreLibrary::MakeBuffer( teascript::ValueObject( static_cast<teascript::U64>(size) ) ), teascript::ValueConfig( true ) );
@@ -295,35 +405,36 @@ double exec_core_funcs()
     auto f_buf_set_u32 = c.FindValueObject( "_buf_set_u32" );
 
     try {
-        auto start = Now();
+        auto start = bench::Start();
 
-#if !EXEC_CORE_FUNCS_ALWAYS_NEW_VECTOR
         std::vector< teascript::ValueObject> params;
-        params.reserve( 3 );
-        params.push_back( val_buf );
-        params.push_back( teascript::ValueObject( teascript::U64{}, teascript::ValueConfig( true ) ) );
-        params.push_back( val_green );
-#endif
-
-        for( size_t pixel = 0; pixel < width * height - 1; ++pixel ) {
-#if EXEC_CORE_FUNCS_ALWAYS_NEW_VECTOR
-            std::vector< teascript::ValueObject> params;
+        if constexpr( !AlwaysNewVector ) {
             params.reserve( 3 );
             params.push_back( val_buf );
-            params.push_back( teascript::ValueObject( static_cast<teascript::U64>(pixel * 4), teascript::ValueConfig( true ) ) );
+            params.push_back( teascript::ValueObject( teascript::U64{}, teascript::ValueConfig( true ) ) );
             params.push_back( val_green );
-#else
-            params[1].AssignValue( static_cast<teascript::U64>(pixel * 4) );
-#endif
-            f_buf_set_u32.GetValue<teascript::FunctionPtr>()->Call( c, params, {} );
+        }
+
+        for( size_t pixel = 0; pixel < static_cast<size_t>(width * height - 1); ++pixel ) {
+            if constexpr( AlwaysNewVector ) {
+                std::vector< teascript::ValueObject> new_params;
+                new_params.reserve( 3 );
+                new_params.push_back( val_buf );
+                new_params.push_back( teascript::ValueObject( static_cast<teascript::U64>(pixel * 4), teascript::ValueConfig( true ) ) );
+                new_params.push_back( val_green );
+                f_buf_set_u32.GetValue<teascript::FunctionPtr>()->Call( c, new_params, {} );
+            } else {
+                params[1].AssignValue( static_cast<teascript::U64>(pixel * 4) );
+                f_buf_set_u32.GetValue<teascript::FunctionPtr>()->Call( c, params, {} );
+            }
         }
 
         auto teares = teascript::ValueObject( teascript::CoreLibrary::BufSize( buf ) );
-        auto end = Now();
+        auto end = bench::Stop();
 
-        std::cout << "value: " << teares.GetAsInteger() << std::endl;
+        bench::PrintValue( teares.GetAsInteger() );
 
-        return CalcTimeInSecs( start, end );
+        return bench::CalcTimeInSecs( start, end );
 
     } catch( teascript::exception::runtime_error const &ex ) {
         teascript::util::pretty_print( ex );
@@ -363,35 +474,71 @@ bool BufSetU32_Cpp( std::vector<unsigned char> &rBuffer, size_t const pos, unsig
     return true;
 }
 
+// fills count unsigned 32 bit values: the first one is written, then the already filled part is copied with doubled size.
+void FillU32( unsigned char *p, size_t const count, std::uint32_t const val )
+{
+    if( count == 0 ) {
+        return;
+    }
+    size_t const bytes = count * sizeof( val );
+    ::memcpy( p, &val, sizeof( val ) );
+    for( size_t filled = sizeof( val ); filled < bytes; filled *= 2 ) {
+        ::memcpy( p + filled, p, std::min( filled, bytes - filled ) );
+    }
+}
 
-#define EXEC_CPP_NO_CHECKS_AND_INLINE    0
+// writing count unsigned 32 bit values in host byte order into the buffer. the same checks as BufSetU32_Cpp but only once.
+bool BufFillU32_Cpp( std::vector<unsigned char> &rBuffer, size_t const pos, size_t const count, unsigned long long const val )
+{
+    if( val > std::numeric_limits<std::uint32_t>::max() ) {
+        return false;
+    }
+    if( pos > rBuffer.size() ) {
+        return false;
+    }
+    auto const wanted = sizeof( std::uint32_t );
+    if( (std::numeric_limits<size_t>::max() - pos) / wanted < count ) { // overflow protection
+        return false;
+    }
+    if( pos + wanted * count > rBuffer.capacity() ) {
+        return false;
+    }
+    // grow?
+    if( pos + wanted * count > rBuffer.size() ) {
+        rBuffer.resize( pos + wanted * count );
+    }
+
+    FillU32( rBuffer.data() + pos, count, static_cast<std::uint32_t>(val) );
+
+    return true;
+}
 
-double exec_cpp()
+// NoChecksAndInline == true: writes directly into the buffer instead of calling the (checking) BufSetU32_Cpp.
+template< bool NoChecksAndInline >
+double exec_cpp( int const width, int const height )
 {
     auto make_rgb = []( unsigned char r, unsigned char g, unsigned char b ) { return static_cast<unsigned int>(r) * 256 * 256 + static_cast<unsigned int>(g) * 256 + b; };
     auto const green  = make_rgb( 0, 255, 0 );
-    auto const width  = BENCH_IMAGE_WIDTH;
-    auto const height = BENCH_IMAGE_HEIGHT;
     auto const size   = width * height * 4;
 
     std::vector<unsigned char>  buffer( size );
 
     try {
-        auto start = Now();
-        for( size_t pixel = 0; pixel < width * height - 1; ++pixel ) {
-#if EXEC_CPP_NO_CHECKS_AND_INLINE
-            ::memcpy( buffer.data() + pixel * 4, &green, sizeof( green ) );
-#else
-            BufSetU32_Cpp( buffer, pixel * 4, static_cast<unsigned long long>(green) );
-#endif
+        auto start = bench::Start();
+        for( size_t pixel = 0; pixel < static_cast<size_t>(width * height - 1); ++pixel ) {
+            if constexpr( NoChecksAndInline ) {
+                ::memcpy( buffer.data() + pixel * 4, &green, sizeof( green ) );
+            } else {
+                BufSetU32_Cpp( buffer, pixel * 4, static_cast<unsigned long long>(green) );
+            }
         }
 
         auto res = buffer.size();
-        auto end = Now();
+        auto end = bench::Stop();
 
-        std::cout << "value: " << res << std::endl;
+        bench::PrintValue( res );
 
-        return CalcTimeInSecs( start, end );
+        return bench::CalcTimeInSecs( start, end );
 
     } catch( std::exception const &ex ) {
         puts( ex.what() );
@@ -400,68 +547,1028 @@ double exec_cpp()
     return -1.0;
 }
 
+enum class eBulk { Fill, Memcpy, Simd };
 
-int main()
+// the bulk fills in C++ as the ceiling.
+template< eBulk Kind >
+double exec_cpp_bulk( int const width, int const height )
 {
-    std::cout << std::fixed;
-    std::cout << std::setprecision( 8 );
+    auto make_rgb = []( unsigned char r, unsigned char g, unsigned char b ) { return static_cast<unsigned int>(r) * 256 * 256 + static_cast<unsigned int>(g) * 256 + b; };
+    auto const green  = static_cast<std::uint32_t>(make_rgb( 0, 255, 0 ));
+    auto const pixels = static_cast<size_t>(width * height - 1);
+
+    // std::fill needs the pixel type, the others fill the bytes.
+    std::vector<std::uint32_t>  pixel_buffer( Kind == eBulk::Fill ? pixels + 1 : 0 );
+    std::vector<unsigned char>  buffer( Kind == eBulk::Fill ? 0 : (pixels + 1) * 4 );
+
+    auto start = bench::Start();
+    if constexpr( Kind == eBulk::Fill ) {
+        std::fill_n( pixel_buffer.begin(), pixels, green );
+    } else if constexpr( Kind == eBulk::Memcpy ) {
+        FillU32( buffer.data(), pixels, green );
+    } else {
+        size_t pixel = 0;
+        unsigned char *p = buffer.data();
+#if defined( __AVX2__ )
+        auto const vec = _mm256_set1_epi32( static_cast<int>(green) );
+        for( ; pixel + 8 <= pixels; pixel += 8 ) {
+            _mm256_storeu_si256( reinterpret_cast<__m256i *>(p + pixel * 4), vec );
+        }
+#elif defined( __SSE2__ ) || defined( _M_X64 ) || (defined( _M_IX86_FP ) && _M_IX86_FP >= 2)
+        auto const vec = _mm_set1_epi32( static_cast<int>(green) );
+        for( ; pixel + 4 <= pixels; pixel += 4 ) {
+            _mm_storeu_si128( reinterpret_cast<__m128i *>(p + pixel * 4), vec );
+        }
+#endif
+        for( ; pixel < pixels; ++pixel ) { // the rest
+            ::memcpy( p + pixel * 4, &green, sizeof( green ) );
+        }
+    }
+    auto res = Kind == eBulk::Fill ? pixel_buffer.size() * 4 : buffer.size();
+    auto end = bench::Stop();
 
-    std::cout << "Benchmarking TeaScript Buffer Overhead.\n";
-    std::cout << "using image resolution: " << BENCH_IMAGE_WIDTH << " x " << BENCH_IMAGE_HEIGHT << std::endl;
+    bench::PrintValue( res );
+
+    return bench::CalcTimeInSecs( start, end );
+}
+
+// the memory write bandwidth in bytes per second (best of some memsets of a buffer much larger than the caches).
+double measure_write_bandwidth()
+{
+    size_t const size = static_cast<size_t>(BENCH_BANDWIDTH_MB) * 1024 * 1024;
+    std::vector<unsigned char>  buffer( size, 1 ); // touch all pages before.
+    double best = 0.0;
+    for( int i = 0; i < 5; ++i ) {
+        auto const start = std::chrono::steady_clock::now();
+        ::memset( buffer.data(), i, size );
+        auto const end   = std::chrono::steady_clock::now();
+        volatile unsigned char sink = buffer[size / 2]; // the memset must be done.
+        (void)sink;
+        auto const secs = std::chrono::duration<double>( end - start ).count();
+        if( secs > 0.0 ) {
+            best = std::max( best, static_cast<double>(size) / secs );
+        }
+    }
+    return best;
+}
+
+
+// === Bands: N threads fill disjoint parts of one shared image, each with its own engine ===
+
+enum class ePartition { Rows, Chunks, Interleave };
+
+// the part of one worker: the chunks first, first + step, ... <= last, each chunk has chunk pixels.
+struct Band
+{
+    long long  first = 0;
+    long long  last  = -1;
+    long long  step  = 1;
+    long long  chunk = 1;
+};
+
+// rows:       contiguous bands of rows.
+// chunks:     contiguous bands, but iterated in chunks of BENCH_CHUNK_PIXELS (the same loops as interleave, but no false sharing).
+// interleave: the chunks are distributed round robin, so the threads write into the same cache lines (false sharing).
+Band make_band( ePartition const part, int const width, int const height, int const threads, int const worker )
+{
+    Band  b;
+    if( part == ePartition::Rows ) {
+        b.chunk = width;
+        b.first = static_cast<long long>(worker) * height / threads;
+        b.last  = static_cast<long long>(worker + 1) * height / threads - 1;
+    } else {
+        long long const chunks = static_cast<long long>(width) * height / BENCH_CHUNK_PIXELS;
+        b.chunk = BENCH_CHUNK_PIXELS;
+        if( part == ePartition::Chunks ) {
+            b.first = worker * chunks / threads;
+            b.last  = (worker + 1) * chunks / threads - 1;
+        } else {
+            b.first = worker;
+            b.last  = chunks - 1;
+            b.step  = threads;
+        }
+    }
+    return b;
+}
+
+constexpr char tea_code_band_prepare[] = R"_SCRIPT_(
+is_defined make_rgb or (func make_rgb( r, g, b ) { r bit_lsh 16 bit_or g bit_lsh 8 bit_or b })
+
+const green  := make_rgb( 0, 255, 0 ) as u64
+)_SCRIPT_";
+
+constexpr char tea_code_band[] = R"_SCRIPT_(
+forall( c in _seq( first, last, step ) ) {
+    forall( pixel in _seq( c * chunk, c * chunk + chunk - 1, 1 ) ) {
+        _buf_set_u32( buf, pixel * 4, green )
+    }
+}
+_buf_size( buf ) // return sth...
+)_SCRIPT_";
+
+// TeaScript cannot bind external memory, so the image is one Buffer ValueObject which is shared by all engines.
+double exec_tea_band( teascript::ValueObject const &shared, Band const &b, bool const compiled )
+{
+    MyEngine  engine;
+
+    engine.AddConst( "first", b.first );
+    engine.AddConst( "last", b.last );
+    engine.AddConst( "step", b.step );
+    engine.AddConst( "chunk", b.chunk );
+    engine.AddSharedValueObject( "buf", shared );
+    try {
+        engine.ExecuteCode( tea_code_band_prepare );
+        teascript::ValueObject  teares;
+        double secs = 0.0;
+        if( compiled ) {
+#if TEASCRIPT_VERSION >= TEASCRIPT_BUILD_VERSION_NUMBER(0,14,0)
+            auto prog  = engine.CompileCode( tea_code_band, teascript::eOptimize::O2 );
+            auto start = bench::Start();
+            teares     = engine.ExecuteProgram( prog );
+            auto end   = bench::Stop();
+            secs       = bench::CalcTimeInSecs( start, end );
+#endif
+        } else {
+            auto ast   = engine.GetParser().Parse( tea_code_band );
+            auto start = bench::Start();
+            teares     = ast->Eval( engine.GetContext() );
+            auto end   = bench::Stop();
+            secs       = bench::CalcTimeInSecs( start, end );
+        }
+
+        bench::PrintValue( teares.GetAsInteger() );
+
+        return secs;
+
+    } catch( teascript::exception::runtime_error const &ex ) {
+        teascript::util::pretty_print( ex );
+    } catch( std::exception const &ex ) {
+        puts( ex.what() );
+    }
+
+    return -1.0;
+}
+
+#if BENCH_ENABLE_CHAI
+constexpr char chai_code_band[] = R"_SCRIPT_(
+for( var c = first; c <= last; c += step ) {
+    var stop = c * chunk + chunk;
+    for( var pixel = c * chunk; pixel < stop; ++pixel ) {
+        _buf_set_u32( buf, pixel * 4, green );
+    }
+}
+buf.size(); // return sth ...
+)_SCRIPT_";
+
+// ChaiScript binds the external image by reference.
+double exec_chai_band( std::vector<unsigned char> &shared, Band const &b )
+{
+    auto make_rgb = []( unsigned char r, unsigned char g, unsigned char b ) { return static_cast<unsigned int>(r) * 256 * 256 + static_cast<unsigned int>(g) * 256 + b; };
+    auto const green  = static_cast<unsigned long long>( make_rgb( 0, 255, 0 ) );
+
+    chaiscript::ChaiScript chai;
+    chai.add( chaiscript::bootstrap::standard_library::vector_type<std::vector<unsigned char>>( "Buffer" ) );
+    chai.add( chaiscript::fun( BufSetU32_Cpp ), "_buf_set_u32" );
+    chai.add( chaiscript::var( std::ref( shared ) ), "buf" );
+    chai.add( chaiscript::const_var( b.first ), "first" );
+    chai.add( chaiscript::const_var( b.last ), "last" );
+    chai.add( chaiscript::const_var( b.step ), "step" );
+    chai.add( chaiscript::const_var( b.chunk ), "chunk" );
+    chai.add( chaiscript::const_var( green ), "green" );
+    auto ast = chai.parse( chai_code_band );
+    try {
+        auto start = bench::Start();
+        auto chres = chai.eval( *ast );
+        auto end = bench::Stop();
+
+        bench::PrintValue( chaiscript::boxed_cast<size_t>(chres) );
+
+        return bench::CalcTimeInSecs( start, end );
+
+    } catch( chaiscript::Boxed_Value const &bv ) {
+        puts( chaiscript::boxed_cast<chaiscript::exception::eval_error const &>(bv).what() );
+    } catch( std::exception const &ex ) {
+        puts( ex.what() );
+    }
+
+    return -1.0;
+}
+#endif
+
+double exec_core_band( teascript::Buffer &shared, Band const &b )
+{
+    auto make_rgb = []( unsigned char r, unsigned char g, unsigned char b ) { return static_cast<unsigned int>(r) * 256 * 256 + static_cast<unsigned int>(g) * 256 + b; };
+    auto const green  = make_rgb( 0, 255, 0 );
+    try {
+        auto start  = bench::Start();
+
+        for( long long c = b.first; c <= b.last; c += b.step ) {
+            for( long long pixel = c * b.chunk; pixel < c * b.chunk + b.chunk; ++pixel ) {
+                teascript::CoreLibrary::BufSetU32( shared, teascript::ValueObject( static_cast<teascript::U64>(pixel * 4) ), static_cast<teascript::U64>(green) );
+            }
+        }
+
+        auto teares = teascript::ValueObject( teascript::CoreLibrary::BufSize( shared ) );
+        auto end    = bench::Stop();
+
+        bench::PrintValue( teares.GetAsInteger() );
+
+        return bench::CalcTimeInSecs( start, end );
+
+    } catch( teascript::exception::runtime_error const &ex ) {
+        teascript::util::pretty_print( ex );
+    } catch( std::exception const &ex ) {
+        puts( ex.what() );
+    }
+
+    return -1.0;
+}
+
+double exec_cpp_band( std::vector<unsigned char> &shared, Band const &b )
+{
+    auto make_rgb = []( unsigned char r, unsigned char g, unsigned char b ) { return static_cast<unsigned int>(r) * 256 * 256 + static_cast<unsigned int>(g) * 256 + b; };
+    auto const green  = make_rgb( 0, 255, 0 );
+
+    auto start = bench::Start();
+    for( long long c = b.first; c <= b.last; c += b.step ) {
+        for( long long pixel = c * b.chunk; pixel < c * b.chunk + b.chunk; ++pixel ) {
+            BufSetU32_Cpp( shared, static_cast<size_t>(pixel * 4), static_cast<unsigned long long>(green) );
+        }
+    }
+    auto res = shared.size();
+    auto end = bench::Stop();
+
+    bench::PrintValue( res );
+
+    return bench::CalcTimeInSecs( start, end );
+}
+
+// checks whether all pixels of the shared image are filled.
+bool check_image( std::vector<unsigned char> const &image )
+{
+    std::uint32_t const green = 0x00FF00u;
+    for( size_t pos = 0; pos + 4 <= image.size(); pos += 4 ) {
+        std::uint32_t  val;
+        ::memcpy( &val, image.data() + pos, sizeof( val ) );
+        if( val != green ) {
+            std::cout << "image not filled at pixel " << pos / 4 << '!' << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+// runs test on threads workers with a band each. the image is created and cleared before (not measured) and checked after.
+// Image is std::vector<unsigned char> or a TeaScript Buffer ValueObject.
+template< typename Image, typename Test >
+double run_band_test( int const threads, ePartition const part, int const width, int const height, bool const pin, Test const &test )
+{
+    auto const size = static_cast<size_t>(width) * static_cast<size_t>(height) * 4;
+    Image  image;
+    if constexpr( std::is_same_v<Image, teascript::ValueObject> ) {
+        image = teascript::ValueObject( teascript::CoreLibrary::MakeBuffer( teascript::ValueObject( static_cast<teascript::U64>(size) ) ), teascript::ValueConfig( true ) );
+        teascript::CoreLibrary::BufFill( image.template GetValue<teascript::Buffer>(), teascript::ValueObject( 0LL ), teascript::ValueObject( -1LL ), 0 );
+    } else {
+        image.assign( size, 0 );
+    }
+    auto const secs = bench::RunThreaded( threads, [&] { return test( image, make_band( part, width, height, threads, bench::WorkerIndex() ) ); }, pin );
+    if( secs < 0.0 ) {
+        return -1.0;
+    }
+    if constexpr( std::is_same_v<Image, teascript::ValueObject> ) {
+        return check_image( image.template GetValue<teascript::Buffer>() ) ? secs : -1.0;
+    } else {
+        return check_image( image ) ? secs : -1.0;
+    }
+}
+
+// runs all selected engines for all thread counts with one partition, returns the count of failed tests.
+int run_bands( bench::CmdLine const &cmd, int const width, int const height, std::vector<long long> const &thread_counts, std::string const &partition )
+{
+    auto const part = partition == "interleave" ? ePartition::Interleave : partition == "chunks" ? ePartition::Chunks : ePartition::Rows;
+    bool const pin  = cmd.Get( "pin", "1" ) != "0";
+
+    // test title -> thread count and median time for the speedup.
+    std::map<std::string, std::vector<std::pair<long long, double>>>  scaling;
+    int failed = 0;
+    for( auto const count : thread_counts ) {
+        auto const threads = static_cast<int>(count);
+        bench::Suite  suite( cmd, "buffer-bands", { { "width", std::to_string( width ) }, { "height", std::to_string( height ) },
+                                                    { "partition", partition }, { "threads", std::to_string( threads ) } } );
+        suite.SetOps( static_cast<double>(width) * height, "pixel" );
 
 #if BENCH_ENABLE_TEACODE
-    std::cout << "\nStart Test TeaScript" << std::endl;
-    for( int i = BENCH_ITERATIONS; i != 0; --i ) {
-        auto secs = exec_tea();
-        std::cout << "Calculation took: " << secs << " seconds." << std::endl;
+        suite.Add( "tea", "TeaScript (shared Buffer)", [=] {
+            return run_band_test<teascript::ValueObject>( threads, part, width, height, pin, []( teascript::ValueObject &img, Band const &b ) { return exec_tea_band( img, b, false ); } ); } );
+#endif
+#if BENCH_ENABLE_TEA_COMPILE && TEASCRIPT_VERSION >= TEASCRIPT_BUILD_VERSION_NUMBER( 0, 14, 0 )
+        suite.Add( "tea-vm", "TeaScript in TeaStackVM (shared Buffer)", [=] {
+            return run_band_test<teascript::ValueObject>( threads, part, width, height, pin, []( teascript::ValueObject &img, Band const &b ) { return exec_tea_band( img, b, true ); } ); } );
+#endif
+#if BENCH_ENABLE_CHAI
+        suite.Add( "chai", "ChaiScript (std::ref)", [=] {
+            return run_band_test<std::vector<unsigned char>>( threads, part, width, height, pin, []( std::vector<unsigned char> &img, Band const &b ) { return exec_chai_band( img, b ); } ); } );
+#endif
+#if BENCH_ENABLE_CORE_LIB
+        suite.Add( "core", "CoreLibrary", [=] {
+            return run_band_test<teascript::ValueObject>( threads, part, width, height, pin, []( teascript::ValueObject &img, Band const &b ) {
+                return exec_core_band( img.GetValue<teascript::Buffer>(), b ); } ); } );
+#endif
+#if BENCH_ENABLE_CPP
+        suite.Add( "cpp", "pure C++", [=] {
+            return run_band_test<std::vector<unsigned char>>( threads, part, width, height, pin, []( std::vector<unsigned char> &img, Band const &b ) { return exec_cpp_band( img, b ); } ); } );
+#endif
+
+        auto const first = bench::Records().size();
+        failed += suite.Run();
+        for( auto i = first; i < bench::Records().size(); ++i ) {
+            auto const &r = bench::Records()[i];
+            scaling[r.title].emplace_back( count, r.result.stats.median );
+        }
     }
+
+    // strong scaling: the same image with more threads.
+    auto const prec = std::cout.precision( 2 );
+    std::cout << "\nspeedup (median, " << width << " x " << height << ", partition=" << partition << "):\n";
+    for( auto const &[title, results] : scaling ) {
+        auto const &base = results.front();
+        std::cout << "  " << title << ":";
+        for( auto const &[threads, median] : results ) {
+            auto const speedup = base.second / median;
+            std::cout << "  " << threads << "T " << std::fixed << speedup << "x (" << speedup * static_cast<double>(base.first) / static_cast<double>(threads) * 100.0 << " %)";
+        }
+        std::cout << std::defaultfloat << '\n';
+    }
+    std::cout << std::flush;
+    std::cout.precision( prec );
+
+    return failed;
+}
+
+
+// === Kernels: reading and writing the image ===
+
+enum class eKernel { Gray, Blend, Blur, Lut };
+enum class eImage { Src, Dst };
+
+// reading unsigned 32 bit data in host byte order from the buffer. mimic the CoreLibrary behavior but without TeaScript types (0 on error).
+unsigned long long BufGetU32_Cpp( std::vector<unsigned char> const &rBuffer, size_t const pos )
+{
+    std::uint32_t  val = 0;
+    if( pos > rBuffer.size() || rBuffer.size() - pos < sizeof( val ) ) {
+        return 0;
+    }
+    ::memcpy( &val, rBuffer.data() + pos, sizeof( val ) );
+    return val;
+}
+
+unsigned long long BufGetU8_Cpp( std::vector<unsigned char> const &rBuffer, size_t const pos )
+{
+    return pos < rBuffer.size() ? rBuffer[pos] : 0;
+}
+
+// the images of the kernels: dst is read and written (the input of gray and lut, the second input of blend), src is only read.
+struct KernelImages
+{
+    std::vector<unsigned char>  src;
+    std::vector<unsigned char>  dst;
+    std::vector<unsigned char>  lut;   // 256 entries
+};
+
+KernelImages make_kernel_images( int const width, int const height )
+{
+    auto const pixels = static_cast<size_t>(width) * static_cast<size_t>(height);
+    KernelImages  img;
+    img.src.resize( pixels * 4 );
+    img.dst.resize( pixels * 4 );
+    for( size_t pixel = 0; pixel < pixels; ++pixel ) {
+        auto const s = static_cast<std::uint32_t>(0xFF000000u | ((pixel * 2654435761u) & 0xFFFFFFu));
+        auto const d = static_cast<std::uint32_t>(0x80000000u | ((pixel * 40503u + 12345u) & 0xFFFFFFu));
+        ::memcpy( img.src.data() + pixel * 4, &s, 4 );
+        ::memcpy( img.dst.data() + pixel * 4, &d, 4 );
+    }
+    for( unsigned int i = 0; i < 256; ++i ) {
+        img.lut.push_back( static_cast<unsigned char>(i * i / 255) ); // a gamma like curve
+    }
+    return img;
+}
+
+// FNV-1a over the image for compare the results of the engines.
+std::uint64_t checksum( std::vector<unsigned char> const &image )
+{
+    std::uint64_t  hash = 14695981039346656037ULL;
+    for( auto const c : image ) {
+        hash = (hash ^ c) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+double kernel_pixels( eKernel const k, int const width, int const height )
+{
+    if( k == eKernel::Blur ) { // without the border
+        return static_cast<double>(width - 2) * (height - 2);
+    }
+    return static_cast<double>(width) * height;
+}
+
+// the kernels for C++ and the CoreLibrary (the scripts below do the same), Access does the reading and writing of the buffers.
+// x / 9 is done as (x * 7282) >> 16 (exact for x <= 9 * 255), the channels are calculated in parallel where possible.
+template< typename Access >
+void run_kernel( eKernel const k, Access &a, int const width, int const height )
+{
+    auto const w = static_cast<size_t>(width);
+    auto const h = static_cast<size_t>(height);
+    switch( k ) {
+    case eKernel::Gray:
+        for( size_t pixel = 0; pixel < w * h; ++pixel ) {
+            auto const v = a.Get( eImage::Dst, pixel * 4 );
+            auto const y = ((((v >> 16) & 255) * 77) + (((v >> 8) & 255) * 150) + ((v & 255) * 29)) >> 8;
+            a.Set( pixel * 4, (v & 4278190080ULL) | (y * 65793ULL) );
+        }
+        break;
+    case eKernel::Blend:
+        for( size_t pixel = 0; pixel < w * h; ++pixel ) {
+            auto const s  = a.Get( eImage::Src, pixel * 4 );
+            auto const d  = a.Get( eImage::Dst, pixel * 4 );
+            auto const rb = ((((s & 16711935ULL) * BENCH_BLEND_ALPHA) + ((d & 16711935ULL) * (256 - BENCH_BLEND_ALPHA))) >> 8) & 16711935ULL;
+            auto const g  = ((((s & 65280ULL) * BENCH_BLEND_ALPHA) + ((d & 65280ULL) * (256 - BENCH_BLEND_ALPHA))) >> 8) & 65280ULL;
+            a.Set( pixel * 4, (d & 4278190080ULL) | rb | g );
+        }
+        break;
+    case eKernel::Blur:
+        for( size_t y = 1; y < h - 1; ++y ) {
+            for( size_t x = 1; x < w - 1; ++x ) {
+                unsigned long long rb = 0;
+                unsigned long long g  = 0;
+                for( size_t dy = 0; dy < 3; ++dy ) {
+                    auto const row = ((y + dy - 1) * w + x) * 4;
+                    auto const v0  = a.Get( eImage::Src, row - 4 );
+                    auto const v1  = a.Get( eImage::Src, row );
+                    auto const v2  = a.Get( eImage::Src, row + 4 );
+                    rb += (v0 & 16711935ULL) + (v1 & 16711935ULL) + (v2 & 16711935ULL);
+                    g  += (v0 & 65280ULL) + (v1 & 65280ULL) + (v2 & 65280ULL);
+                }
+                auto const r  = (((rb >> 16) * 7282) >> 16) << 16;
+                auto const b  = ((rb & 65535) * 7282) >> 16;
+                auto const gg = (((g >> 8) * 7282) >> 16) << 8;
+                a.Set( (y * w + x) * 4, 4278190080ULL | r | gg | b );
+            }
+        }
+        break;
+    case eKernel::Lut:
+        for( size_t pixel = 0; pixel < w * h; ++pixel ) {
+            auto const v = a.Get( eImage::Dst, pixel * 4 );
+            auto const r = a.Lut( (v >> 16) & 255 );
+            auto const g = a.Lut( (v >> 8) & 255 );
+            auto const b = a.Lut( v & 255 );
+            a.Set( pixel * 4, (v & 4278190080ULL) | (r << 16) | (g << 8) | b );
+        }
+        break;
+    }
+}
+
+// C++ with the checks of the CoreLibrary (like BufSetU32_Cpp).
+struct CppAccess
+{
+    KernelImages  &img;
+
+    unsigned long long Get( eImage const i, size_t const pos ) { return BufGetU32_Cpp( i == eImage::Src ? img.src : img.dst, pos ); }
+    unsigned long long Lut( size_t const idx ) { return BufGetU8_Cpp( img.lut, idx ); }
+    void Set( size_t const pos, unsigned long long const val ) { BufSetU32_Cpp( img.dst, pos, val ); }
+};
+
+// the CoreLibrary via its function objects (like exec_core_funcs), the parameter vectors are reused.
+struct CoreFuncAccess
+{
+    teascript::Context                   &c;
+    teascript::FunctionPtr                get_u32;
+    teascript::FunctionPtr                get_u8;
+    teascript::FunctionPtr                set_u32;
+    std::vector<teascript::ValueObject>   src_params;  // buffer, pos
+    std::vector<teascript::ValueObject>   dst_params;  // buffer, pos
+    std::vector<teascript::ValueObject>   lut_params;  // buffer, pos
+    std::vector<teascript::ValueObject>   set_params;  // buffer, pos, val
+
+    unsigned long long Get( eImage const i, size_t const pos )
+    {
+        auto &params = i == eImage::Src ? src_params : dst_params;
+        params[1].AssignValue( static_cast<teascript::U64>(pos) );
+        return static_cast<unsigned long long>(get_u32->Call( c, params, {} ).GetAsInteger());
+    }
+    unsigned long long Lut( size_t const idx )
+    {
+        lut_params[1].AssignValue( static_cast<teascript::U64>(idx) );
+        return static_cast<unsigned long long>(get_u8->Call( c, lut_params, {} ).GetAsInteger());
+    }
+    void Set( size_t const pos, unsigned long long const val )
+    {
+        set_params[1].AssignValue( static_cast<teascript::U64>(pos) );
+        set_params[2].AssignValue( static_cast<teascript::U64>(val) );
+        set_u32->Call( c, set_params, {} );
+    }
+};
+
+double exec_cpp_kernel( eKernel const k, int const width, int const height, std::uint64_t const expected )
+{
+    auto img = make_kernel_images( width, height );
+    CppAccess  a{ img };
+
+    auto start = bench::Start();
+    run_kernel( k, a, width, height );
+    auto res = img.dst.size();
+    auto end = bench::Stop();
+
+    bench::PrintValue( res );
+
+    if( checksum( img.dst ) != expected ) {
+        puts( "C++: wrong result!" );
+        return -1.0;
+    }
+    return bench::CalcTimeInSecs( start, end );
+}
+
+double exec_core_kernel( eKernel const k, int const width, int const height, std::uint64_t const expected )
+{
+    teascript::Context c;
+    teascript::CoreLibrary().Bootstrap( c, teascript::config::util() );
+    auto img = make_kernel_images( width, height );
+    auto val_src = teascript::ValueObject( std::move( img.src ), teascript::ValueConfig( true ) );
+    auto val_dst = teascript::ValueObject( std::move( img.dst ), teascript::ValueConfig( true ) );
+    auto val_lut = teascript::ValueObject( std::move( img.lut ), teascript::ValueConfig( true ) );
+    // the buffer and count values which will be assigned for each call.
+    auto const make_params = []( teascript::ValueObject const &val_buf, int const count ) {
+        std::vector<teascript::ValueObject>  params{ val_buf };
+        for( int i = 0; i < count; ++i ) {
+            params.push_back( teascript::ValueObject( teascript::U64{}, teascript::ValueConfig( true ) ) );
+        }
+        return params;
+    };
+
+    try {
+        CoreFuncAccess  a{ c, c.FindValueObject( "_buf_get_u32" ).GetValue<teascript::FunctionPtr>(), c.FindValueObject( "_buf_get_u8" ).GetValue<teascript::FunctionPtr>(),
+                           c.FindValueObject( "_buf_set_u32" ).GetValue<teascript::FunctionPtr>(),
+                           make_params( val_src, 1 ), make_params( val_dst, 1 ), make_params( val_lut, 1 ), make_params( val_dst, 2 ) };
+
+        auto start = bench::Start();
+        run_kernel( k, a, width, height );
+        auto teares = teascript::ValueObject( teascript::CoreLibrary::BufSize( val_dst.GetValue<teascript::Buffer>() ) );
+        auto end = bench::Stop();
+
+        bench::PrintValue( teares.GetAsInteger() );
+
+        if( checksum( val_dst.GetValue<teascript::Buffer>() ) != expected ) {
+            puts( "CoreLibrary: wrong result!" );
+            return -1.0;
+        }
+        return bench::CalcTimeInSecs( start, end );
+
+    } catch( teascript::exception::runtime_error const &ex ) {
+        teascript::util::pretty_print( ex );
+    } catch( std::exception const &ex ) {
+        puts( ex.what() );
+    }
+
+    return -1.0;
+}
+
+constexpr char tea_kernel_gray[] = R"_SCRIPT_(
+forall( pixel in _seq( 0, width*height - 1, 1 ) ) {
+    const v := _buf_get_u32( buf, pixel * 4 ) as i64
+    const y := ((((v bit_rsh 16) bit_and 255) * 77) + (((v bit_rsh 8) bit_and 255) * 150) + ((v bit_and 255) * 29)) bit_rsh 8
+    _buf_set_u32( buf, pixel * 4, ((v bit_and 4278190080) bit_or (y * 65793)) as u64 )
+}
+_buf_size( buf ) // return sth...
+)_SCRIPT_";
+
+constexpr char tea_kernel_blend[] = R"_SCRIPT_(
+forall( pixel in _seq( 0, width*height - 1, 1 ) ) {
+    const s  := _buf_get_u32( src, pixel * 4 ) as i64
+    const d  := _buf_get_u32( buf, pixel * 4 ) as i64
+    const rb := ((((s bit_and 16711935) * alpha) + ((d bit_and 16711935) * (256 - alpha))) bit_rsh 8) bit_and 16711935
+    const g  := ((((s bit_and 65280) * alpha) + ((d bit_and 65280) * (256 - alpha))) bit_rsh 8) bit_and 65280
+    _buf_set_u32( buf, pixel * 4, ((d bit_and 4278190080) bit_or rb bit_or g) as u64 )
+}
+_buf_size( buf ) // return sth...
+)_SCRIPT_";
+
+constexpr char tea_kernel_blur[] = R"_SCRIPT_(
+forall( y in _seq( 1, height - 2, 1 ) ) {
+    forall( x in _seq( 1, width - 2, 1 ) ) {
+        def rb := 0
+        def g  := 0
+        forall( dy in _seq( 0, 2, 1 ) ) {
+            const row := ((y + dy - 1) * width + x) * 4
+            const v0  := _buf_get_u32( src, row - 4 ) as i64
+            const v1  := _buf_get_u32( src, row ) as i64
+            const v2  := _buf_get_u32( src, row + 4 ) as i64
+            rb := rb + (v0 bit_and 16711935) + (v1 bit_and 16711935) + (v2 bit_and 16711935)
+            g  := g + (v0 bit_and 65280) + (v1 bit_and 65280) + (v2 bit_and 65280)
+        }
+        const r  := (((rb bit_rsh 16) * 7282) bit_rsh 16) bit_lsh 16
+        const b  := ((rb bit_and 65535) * 7282) bit_rsh 16
+        const gg := (((g bit_rsh 8) * 7282) bit_rsh 16) bit_lsh 8
+        _buf_set_u32( buf, (y * width + x) * 4, (4278190080 bit_or r bit_or gg bit_or b) as u64 )
+    }
+}
+_buf_size( buf ) // return sth...
+)_SCRIPT_";
+
+constexpr char tea_kernel_lut[] = R"_SCRIPT_(
+forall( pixel in _seq( 0, width*height - 1, 1 ) ) {
+    const v := _buf_get_u32( buf, pixel * 4 ) as i64
+    const r := _buf_get_u8( lut, (v bit_rsh 16) bit_and 255 ) as i64
+    const g := _buf_get_u8( lut, (v bit_rsh 8) bit_and 255 ) as i64
+    const b := _buf_get_u8( lut, v bit_and 255 ) as i64
+    _buf_set_u32( buf, pixel * 4, ((v bit_and 4278190080) bit_or (r bit_lsh 16) bit_or (g bit_lsh 8) bit_or b) as u64 )
+}
+_buf_size( buf ) // return sth...
+)_SCRIPT_";
+
+double exec_tea_kernel( eKernel const k, int const width, int const height, std::uint64_t const expected, bool const compiled )
+{
+    char const *const codes[] = { tea_kernel_gray, tea_kernel_blend, tea_kernel_blur, tea_kernel_lut };
+    MyEngine  engine;
+
+    auto img = make_kernel_images( width, height );
+    auto val_dst = teascript::ValueObject( std::move( img.dst ), teascript::ValueConfig( true ) );
+    engine.AddConst( "width", width );
+    engine.AddConst( "height", height );
+    engine.AddConst( "alpha", BENCH_BLEND_ALPHA );
+    engine.AddSharedValueObject( "src", teascript::ValueObject( std::move( img.src ), teascript::ValueConfig( true ) ) );
+    engine.AddSharedValueObject( "buf", val_dst );
+    engine.AddSharedValueObject( "lut", teascript::ValueObject( std::move( img.lut ), teascript::ValueConfig( true ) ) );
+    try {
+        auto const *code = codes[static_cast<int>(k)];
+        teascript::ValueObject  teares;
+        double secs = 0.0;
+        if( compiled ) {
+#if TEASCRIPT_VERSION >= TEASCRIPT_BUILD_VERSION_NUMBER(0,14,0)
+            auto prog  = engine.CompileCode( code, teascript::eOptimize::O2 );
+            auto start = bench::Start();
+            teares     = engine.ExecuteProgram( prog );
+            auto end   = bench::Stop();
+            secs       = bench::CalcTimeInSecs( start, end );
+#endif
+        } else {
+            auto ast   = engine.GetParser().Parse( code );
+            auto start = bench::Start();
+            teares     = ast->Eval( engine.GetContext() );
+            auto end   = bench::Stop();
+            secs       = bench::CalcTimeInSecs( start, end );
+        }
+
+        bench::PrintValue( teares.GetAsInteger() );
+
+        if( checksum( val_dst.GetValue<teascript::Buffer>() ) != expected ) {
+            puts( "TeaScript: wrong result!" );
+            return -1.0;
+        }
+        return secs;
+
+    } catch( teascript::exception::runtime_error const &ex ) {
+        teascript::util::pretty_print( ex );
+    } catch( std::exception const &ex ) {
+        puts( ex.what() );
+    }
+
+    return -1.0;
+}
+
+#if BENCH_ENABLE_CHAI
+constexpr char chai_kernel_gray[] = R"_SCRIPT_(
+var size = width * height;
+for( var pixel = 0; pixel < size; ++pixel ) {
+    var v = _buf_get_u32( buf, pixel * 4 );
+    var y = ((((v >> 16) & 255) * 77) + (((v >> 8) & 255) * 150) + ((v & 255) * 29)) >> 8;
+    _buf_set_u32( buf, pixel * 4, (v & 4278190080) | (y * 65793) );
+}
+buf.size(); // return sth ...
+)_SCRIPT_";
+
+constexpr char chai_kernel_blend[] = R"_SCRIPT_(
+var size = width * height;
+for( var pixel = 0; pixel < size; ++pixel ) {
+    var s  = _buf_get_u32( src, pixel * 4 );
+    var d  = _buf_get_u32( buf, pixel * 4 );
+    var rb = ((((s & 16711935) * alpha) + ((d & 16711935) * (256 - alpha))) >> 8) & 16711935;
+    var g  = ((((s & 65280) * alpha) + ((d & 65280) * (256 - alpha))) >> 8) & 65280;
+    _buf_set_u32( buf, pixel * 4, (d & 4278190080) | rb | g );
+}
+buf.size(); // return sth ...
+)_SCRIPT_";
+
+constexpr char chai_kernel_blur[] = R"_SCRIPT_(
+for( var y = 1; y < height - 1; ++y ) {
+    for( var x = 1; x < width - 1; ++x ) {
+        var rb = 0;
+        var g  = 0;
+        for( var dy = 0; dy < 3; ++dy ) {
+            var row = ((y + dy - 1) * width + x) * 4;
+            var v0  = _buf_get_u32( src, row - 4 );
+            var v1  = _buf_get_u32( src, row );
+            var v2  = _buf_get_u32( src, row + 4 );
+            rb = rb + (v0 & 16711935) + (v1 & 16711935) + (v2 & 16711935);
+            g  = g + (v0 & 65280) + (v1 & 65280) + (v2 & 65280);
+        }
+        var r  = (((rb >> 16) * 7282) >> 16) << 16;
+        var b  = ((rb & 65535) * 7282) >> 16;
+        var gg = (((g >> 8) * 7282) >> 16) << 8;
+        _buf_set_u32( buf, (y * width + x) * 4, 4278190080 | r | gg | b );
+    }
+}
+buf.size(); // return sth ...
+)_SCRIPT_";
+
+constexpr char chai_kernel_lut[] = R"_SCRIPT_(
+var size = width * height;
+for( var pixel = 0; pixel < size; ++pixel ) {
+    var v = _buf_get_u32( buf, pixel * 4 );
+    var r = _buf_get_u8( lut, (v >> 16) & 255 );
+    var g = _buf_get_u8( lut, (v >> 8) & 255 );
+    var b = _buf_get_u8( lut, v & 255 );
+    _buf_set_u32( buf, pixel * 4, (v & 4278190080) | (r << 16) | (g << 8) | b );
+}
+buf.size(); // return sth ...
+)_SCRIPT_";
+
+double exec_chai_kernel( eKernel const k, int const width, int const height, std::uint64_t const expected )
+{
+    char const *const codes[] = { chai_kernel_gray, chai_kernel_blend, chai_kernel_blur, chai_kernel_lut };
+    auto img = make_kernel_images( width, height );
+
+    chaiscript::ChaiScript chai;
+    chai.add( chaiscript::bootstrap::standard_library::vector_type<std::vector<unsigned char>>( "Buffer" ) );
+    chai.add( chaiscript::fun( BufSetU32_Cpp ), "_buf_set_u32" );
+    chai.add( chaiscript::fun( BufGetU32_Cpp ), "_buf_get_u32" );
+    chai.add( chaiscript::fun( BufGetU8_Cpp ), "_buf_get_u8" );
+    chai.add( chaiscript::var( std::ref( img.src ) ), "src" );
+    chai.add( chaiscript::var( std::ref( img.dst ) ), "buf" );
+    chai.add( chaiscript::var( std::ref( img.lut ) ), "lut" );
+    chai.add( chaiscript::const_var( width ), "width" );
+    chai.add( chaiscript::const_var( height ), "height" );
+    chai.add( chaiscript::const_var( BENCH_BLEND_ALPHA ), "alpha" );
+    auto ast = chai.parse( codes[static_cast<int>(k)] );
+    try {
+        auto start = bench::Start();
+        auto chres = chai.eval( *ast );
+        auto end = bench::Stop();
+
+        bench::PrintValue( chaiscript::boxed_cast<size_t>(chres) );
+
+        if( checksum( img.dst ) != expected ) {
+            puts( "ChaiScript: wrong result!" );
+            return -1.0;
+        }
+        return bench::CalcTimeInSecs( start, end );
+
+    } catch( chaiscript::Boxed_Value const &bv ) {
+        puts( chaiscript::boxed_cast<chaiscript::exception::eval_error const &>(bv).what() );
+    } catch( std::exception const &ex ) {
+        puts( ex.what() );
+    }
+
+    return -1.0;
+}
+#endif
+
+// runs all selected engines with one kernel, returns the count of failed tests.
+int run_kernels( bench::CmdLine const &cmd, int const width, int const height, std::string const &kernel )
+{
+    auto const k = kernel == "gray" ? eKernel::Gray : kernel == "blend" ? eKernel::Blend : kernel == "blur" ? eKernel::Blur : eKernel::Lut;
+
+    // the result of C++ is the reference for all engines.
+    std::uint64_t expected = 0;
+    {
+        auto img = make_kernel_images( width, height );
+        CppAccess  a{ img };
+        run_kernel( k, a, width, height );
+        expected = checksum( img.dst );
+    }
+
+    bench::Suite  suite( cmd, "buffer-kernel", { { "width", std::to_string( width ) }, { "height", std::to_string( height ) }, { "kernel", kernel } } );
+    suite.SetOps( kernel_pixels( k, width, height ), "pixel" );
+    suite.AllowThreads();
+
+#if BENCH_ENABLE_TEACODE
+    suite.Add( "tea", "TeaScript", [=] { return exec_tea_kernel( k, width, height, expected, false ); } );
+#endif
+#if BENCH_ENABLE_TEA_COMPILE && TEASCRIPT_VERSION >= TEASCRIPT_BUILD_VERSION_NUMBER( 0, 14, 0 )
+    suite.Add( "tea-vm", "TeaScript in TeaStackVM", [=] { return exec_tea_kernel( k, width, height, expected, true ); } );
+#endif
+#if BENCH_ENABLE_CHAI
+    suite.Add( "chai", "ChaiScript", [=] { return exec_chai_kernel( k, width, height, expected ); } );
+#endif
+#if BENCH_ENABLE_CORE_LIB_FUNC
+    suite.Add( "core-func", "CoreLibrary w. FuncObj", [=] { return exec_core_kernel( k, width, height, expected ); } );
+#endif
+#if BENCH_ENABLE_CPP
+    suite.Add( "cpp", "pure C++", [=] { return exec_cpp_kernel( k, width, height, expected ); } );
+#endif
+
+    return suite.Run();
+}
+
+} // namespace
+
+
+void PrintUsageBufferOverhead()
+{
+    std::cout << "BufferOverhead options:\n"
+                 "  --resolution=fhd,uhd,WxH     image resolution(s) (default: " << BENCH_IMAGE_WIDTH << 'x' << BENCH_IMAGE_HEIGHT << ")\n"
+                 "  --bandwidth=X                memory write bandwidth in GB/s for the report (default: measured with memset of " << BENCH_BANDWIDTH_MB << " MB)\n"
+                 "  --kernel=fill,gray,blend,blur,lut\n"
+                 "                               the work per pixel: fill with a constant (default, all tests above), grayscale, alpha blending\n"
+                 "                               of two images, 3x3 box blur, lookup table per channel (engines: tea, tea-vm, chai, core-func, cpp)\n"
+                 "  --bands=N,...                instead: N threads fill disjoint parts of one shared image, each with its own engine\n"
+                 "                               (engines: tea, tea-vm, chai, core, cpp), reports the speedup\n"
+                 "  --partition=rows,chunks,interleave\n"
+                 "                               the parts with --bands: bands of rows (default), bands iterated in chunks of " << BENCH_CHUNK_PIXELS << " pixels,\n"
+                 "                               chunks round robin (false sharing)\n"
+                 "  --pin=0                      don't pin the threads to the cpus\n"
+                 "  --tea-sweep                  instead: the fill with TeaScript only, the AST Eval and the TeaStackVM with all\n"
+                 "                               optimization levels in Machine<false> and Machine<true>, prints the compile time\n"
+                 "                               and the break-even runs\n"
+                 "engines: tea, tea-vm, chai, core, core-func, core-func-new-vector, cpp, cpp-inline\n"
+                 "bulk:    tea-fill (_buf_fill, u8 only), tea-fill-u32, chai-fill-u32 (registered bulk function),\n"
+                 "         cpp-fill (std::fill), cpp-memcpy, cpp-simd (" BENCH_SIMD_NAME ")\n";
+}
+
+int BenchBufferOverhead( bench::CmdLine const &cmd )
+{
+    if( cmd.Has( "help" ) ) {
+        PrintUsageBufferOverhead();
+        return EXIT_SUCCESS;
+    }
+
+    bench::ApplyConfig( cmd );
+    bench::SetEngineVersion( "cpp", bench::CompilerVersion() );
+    bench::SetEngineVersion( "tea", bench::VersionString( TEASCRIPT_VERSION_MAJOR, TEASCRIPT_VERSION_MINOR, TEASCRIPT_VERSION_PATCH ) );
+    bench::SetEngineVersion( "core", bench::VersionString( TEASCRIPT_VERSION_MAJOR, TEASCRIPT_VERSION_MINOR, TEASCRIPT_VERSION_PATCH ) );
+#if BENCH_ENABLE_CHAI
+    bench::SetEngineVersion( "chai", chaiscript::Build_Info::version() );
+#endif
+
+    auto const resolutions = cmd.GetList( "resolution", { std::to_string( BENCH_IMAGE_WIDTH ) + 'x' + std::to_string( BENCH_IMAGE_HEIGHT ) } );
+    auto const kernels     = cmd.GetList( "kernel", { "fill" } );
+    for( auto const &kernel : kernels ) {
+        if( kernel != "fill" && kernel != "gray" && kernel != "blend" && kernel != "blur" && kernel != "lut" ) {
+            std::cout << "Unknown kernel: " << kernel << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+    auto const bands       = cmd.GetIntList( "bands" );
+    auto const partitions  = cmd.GetList( "partition", { "rows" } );
+    for( auto const &partition : partitions ) {
+        if( partition != "rows" && partition != "chunks" && partition != "interleave" ) {
+            std::cout << "Unknown partition: " << partition << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    std::cout << "Benchmarking TeaScript Buffer Overhead.\n";
+
+    auto bandwidth = cmd.GetDouble( "bandwidth", 0.0 ) * 1e9;
+    bool const report_bandwidth = bands.empty() && !cmd.Has( "tea-sweep" );
+    if( bandwidth <= 0.0 && report_bandwidth ) {
+        bandwidth = measure_write_bandwidth();
+    }
+    if( report_bandwidth ) {
+        std::cout << "memory write bandwidth: " << bandwidth / 1e9 << " GB/s" << std::endl;
+    }
+
+    int failed = 0;
+    for( auto const &resolution : resolutions ) {
+        int width  = 0;
+        int height = 0;
+        if( resolution == "fhd" ) {
+            width  = 1920;
+            height = 1080;
+        } else if( resolution == "uhd" ) {
+            width  = 3840;
+            height = 2160;
+        } else if( auto const wh = bench::CmdLine::Split( resolution, 'x' ); wh.size() == 2 ) {
+            width  = std::atoi( wh[0].c_str() );
+            height = std::atoi( wh[1].c_str() );
+        }
+        if( width <= 0 || height <= 0 ) {
+            std::cout << "Wrong resolution: " << resolution << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        std::cout << "using image resolution: " << width << " x " << height << std::endl;
+
+        if( cmd.Has( "tea-sweep" ) ) {
+#if TEASCRIPT_VERSION >= TEASCRIPT_BUILD_VERSION_NUMBER(0,14,0) && BENCH_ENABLE_TEA_COMPILE
+            failed += run_tea_sweep( cmd, width, height );
+#else
+            std::cout << "--tea-sweep needs TeaScript 0.14 or newer (and BENCH_ENABLE_TEA_COMPILE)." << std::endl;
+            return EXIT_FAILURE;
+#endif
+            continue;
+        }
+
+        if( !bands.empty() ) {
+            for( auto const count : bands ) {
+                if( count < 1 || count > height || (partitions != std::vector<std::string>{ "rows" } && count > width * height / BENCH_CHUNK_PIXELS) ) {
+                    std::cout << "Wrong count of bands: " << count << std::endl;
+                    return EXIT_FAILURE;
+                }
+            }
+            if( (width * height) % BENCH_CHUNK_PIXELS != 0 && partitions != std::vector<std::string>{ "rows" } ) {
+                std::cout << "width * height must be a multiple of " << BENCH_CHUNK_PIXELS << " for --partition=chunks,interleave." << std::endl;
+                return EXIT_FAILURE;
+            }
+            for( auto const &partition : partitions ) {
+                failed += run_bands( cmd, width, height, bands, partition );
+            }
+            continue;
+        }
+
+        for( auto const &kernel : kernels ) {
+            if( kernel == "fill" ) {
+                continue;
+            }
+            if( width < 3 || height < 3 ) {
+                std::cout << "The kernels need at least 3 x 3 pixels." << std::endl;
+                return EXIT_FAILURE;
+            }
+            failed += run_kernels( cmd, width, height, kernel );
+        }
+        if( std::find( kernels.begin(), kernels.end(), "fill" ) == kernels.end() ) {
+            continue;
+        }
+
+        bench::Suite  suite( cmd, "buffer", { { "width", std::to_string( width ) }, { "height", std::to_string( height ) } } );
+        suite.SetOps( static_cast<double>(width * height - 1), "pixel" );
+        suite.AllowThreads();
+
+#if BENCH_ENABLE_TEACODE
+        suite.Add( "tea", "TeaScript", [=] { return exec_tea( width, height ); } );
 #endif
 
 #if BENCH_ENABLE_TEA_COMPILE
 #if TEASCRIPT_VERSION >= TEASCRIPT_BUILD_VERSION_NUMBER( 0, 14, 0 )
-    std::cout << "\nStart Test TeaScript in TeaStackVM" << std::endl;
-    for( int i = BENCH_ITERATIONS; i != 0; --i ) {
-        auto secs = exec_tea_compile();
-        std::cout << "Calculation took: " << secs << " seconds." << std::endl;
-    }
+        suite.Add( "tea-vm", "TeaScript in TeaStackVM", [=] { return exec_tea_compile( width, height ); } );
 #else
-    std::cout << "TeaScript version is too old for test in TeaStackVM. Test skipped. " << std::endl;
+        std::cout << "TeaScript version is too old for test in TeaStackVM. Test skipped. " << std::endl;
 #endif
 #endif
 
 #if BENCH_ENABLE_CHAI
-    std::cout << "\nStart Test ChaiScript" << std::endl;
-    for( int i = BENCH_ITERATIONS; i != 0; --i ) {
-        auto secs = exec_chai();
-        std::cout << "Calculation took: " << secs << " seconds." << std::endl;
-    }
+        suite.Add( "chai", "ChaiScript", [=] { return exec_chai( width, height ); } );
 #endif
 
 #if BENCH_ENABLE_CORE_LIB
-    std::cout << "\nStart Test CoreLibrary" << std::endl;
-    for( int i = BENCH_ITERATIONS; i != 0; --i ) {
-        auto secs = exec_core();
-        std::cout << "Calculation took: " << secs << " seconds." << std::endl;
-    }
+        suite.Add( "core", "CoreLibrary", [=] { return exec_core( width, height ); } );
 #endif
 
 #if BENCH_ENABLE_CORE_LIB_FUNC
-    std::cout << "\nStart Test CoreLibrary w. FuncObj" << std::endl;
-    for( int i = BENCH_ITERATIONS; i != 0; --i ) {
-        auto secs = exec_core_funcs();
-        std::cout << "Calculation took: " << secs << " seconds." << std::endl;
-    }
+        suite.Add( "core-func", "CoreLibrary w. FuncObj", [=] { return exec_core_funcs<false>( width, height ); } );
+        suite.Add( "core-func-new-vector", "CoreLibrary w. FuncObj (always new vector)", [=] { return exec_core_funcs<true>( width, height ); } );
 #endif
 
 #if BENCH_ENABLE_CPP
-    std::cout << "\nStart Test pure C++" << std::endl;
-    for( int i = BENCH_ITERATIONS; i != 0; --i ) {
-        auto secs = exec_cpp();
-        std::cout << "Calculation took: " << secs << " seconds." << std::endl;
-    }
+        suite.Add( "cpp", "pure C++", [=] { return exec_cpp<false>( width, height ); } );
+        suite.Add( "cpp-inline", "pure C++ (no checks and inline)", [=] { return exec_cpp<true>( width, height ); } );
 #endif
 
-    puts( "\n\nTest end." );
+#if BENCH_ENABLE_BULK_SCRIPT
+        suite.Add( "tea-fill", "TeaScript _buf_fill (u8)", [=] { return exec_tea( width, height, tea_code_fill ); } );
+        suite.Add( "tea-fill-u32", "TeaScript bulk fill function", [=] { return exec_tea( width, height, tea_code_fill_u32 ); } );
+#if BENCH_ENABLE_CHAI
+        suite.Add( "chai-fill-u32", "ChaiScript bulk fill function", [=] { return exec_chai( width, height, chai_code_fill_u32 ); } );
+#endif
+#endif
+
+#if BENCH_ENABLE_BULK_CPP
+        suite.Add( "cpp-fill", "pure C++ (std::fill)", [=] { return exec_cpp_bulk<eBulk::Fill>( width, height ); } );
+        suite.Add( "cpp-memcpy", "pure C++ (memcpy)", [=] { return exec_cpp_bulk<eBulk::Memcpy>( width, height ); } );
+        suite.Add( "cpp-simd", "pure C++ (" BENCH_SIMD_NAME ")", [=] { return exec_cpp_bulk<eBulk::Simd>( width, height ); } );
+#endif
+
+        auto const first = bench::Records().size();
+        failed += suite.Run();
+
+        auto const prec = std::cout.precision( 3 );
+        std::cout << "\nbandwidth (median, " << (width * height - 1) * 4.0 / (1024.0 * 1024.0) << " MB written, may exceed 100 % if it fits into the cache):\n";
+        for( auto i = first; i < bench::Records().size(); ++i ) {
+            auto const &r  = bench::Records()[i];
+            auto const  bs = r.ops * 4.0 / r.result.stats.median;
+            std::cout << "  " << r.title << ": " << bs / 1e9 << " GB/s (" << bs / bandwidth * 100.0 << " %)\n";
+        }
+        std::cout << std::flush;
+        std::cout.precision( prec );
+    }
 
-    return EXIT_SUCCESS;
-}
\ No newline at end of file
+    return failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+#if !defined BENCH_DRIVER
+int main( int argc, char *argv[] )
+{
+    bench::GetConfig() = { .warmup_runs = BENCH_WARMUP_RUNS, .min_runs = BENCH_MIN_RUNS, .max_runs = BENCH_MAX_RUNS,
+                           .target_rel_error = BENCH_TARGET_REL_ERROR };
+
+    return bench::Main( argc, argv, &BenchBufferOverhead );
+}
+#endif
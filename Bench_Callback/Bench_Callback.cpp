@@ -0,0 +1,337 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (C) 2024 Florian Thake, <contact |at| tea-age.solutions>.
+ * SPDX-License-Identifier: MIT
+ */
+
+// Benchmarking the latency of calling a script function from C++ (e.g. an event handler) in TeaScript VS ChaiScript VS Jinx.
+//
+// This is the reverse direction of the other benchmarks: a small script function is defined once and then called
+// from a tight C++ loop. The measured region is the loop of the warm calls. Additionally the first call (on a fresh
+// engine) and the latency of single warm calls are measured outside of the measured region and reported as metrics
+// (first-call-ns and the percentiles call-p50-ns, call-p90-ns, call-p99-ns and call-max-ns).
+
+// === BENCH CONFIG ===
+
+#define BENCH_ENABLE_CPP   1                    // 1 == Enable C++, 0 == Disable
+#define BENCH_ENABLE_CHAI  1                    // 1 == Enable ChaiScript, 0 == Disable
+#define BENCH_ENABLE_JINX  1                    // 1 == Enable Jinx, 0 == Disable
+#define BENCH_ENABLE_TEA   1                    // 1 == Enable TeaScript, 0 == Disable
+
+#define BENCH_WARMUP_RUNS      1                // runs of each test before measuring (not part of the statistic).
+#define BENCH_MIN_RUNS         5                // minimum count of measured runs for each test.
+#define BENCH_MAX_RUNS         30               // maximum count of measured runs for each test.
+#define BENCH_TARGET_REL_ERROR 0.02             // repeat until the 95% confidence interval of the mean is within +-2% (or BENCH_MAX_RUNS is reached).
+
+#define BENCH_CALLS        100000               // default for --calls, count of calls of the script function in the measured loop.
+#define BENCH_SAMPLES      10000                // default for --samples, count of single timed calls for the latency percentiles.
+
+// NOTE: all tests of the enabled languages are compiled in. Which are run and with which parameters can be selected
+//       via command line, e.g. --calls=1000000 --engine=tea,chai --alloc (see --help)
+
+
+// handle some annoying compile errors on MSVC
+#if defined _MSC_VER  && !defined _SILENCE_CXX17_CODECVT_HEADER_DEPRECATION_WARNING
+# define _SILENCE_CXX17_CODECVT_HEADER_DEPRECATION_WARNING
+#endif
+#if defined _MSC_VER  && !defined _SILENCE_CXX20_U8PATH_DEPRECATION_WARNING
+# define _SILENCE_CXX20_U8PATH_DEPRECATION_WARNING
+#endif
+#if defined _MSC_VER  && !defined _CRT_SECURE_NO_WARNINGS
+# define _CRT_SECURE_NO_WARNINGS
+#endif
+
+//for VS use /Zc:__cplusplus
+#if __cplusplus < 202002L
+# if defined _MSVC_LANG // fallback without /Zc:__cplusplus
+#  if !_HAS_CXX20
+#   error must use at least C++20
+#  endif
+# else
+#  error must use at least C++20
+# endif
+#endif
+
+
+#include <chrono>
+#include <cstdlib> // EXIT_SUCCESS
+#include <cstdio>
+#include <functional>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+#include "../Common/BenchCore.hpp"
+#include "../Common/BenchCmdLine.hpp"
+#include "../Common/BenchTimer.hpp"
+#if !defined BENCH_DRIVER
+# define BENCH_ALLOC_IMPLEMENTATION // this is the main translation unit
+#endif
+#include "../Common/BenchMain.hpp"
+
+#if BENCH_ENABLE_JINX
+#include <Jinx.hpp>
+#endif
+#if BENCH_ENABLE_TEA
+#include <teascript/Engine.hpp>
+#endif
+#if BENCH_ENABLE_CHAI
+#if defined(_WIN32)
+#  define NOMINMAX
+#  define WIN32_LEAN_AND_MEAN
+# endif
+# if defined( _MSC_VER )
+#  pragma warning( push )
+#  pragma warning( disable: 4244 )
+# endif
+#include <chaiscript/chaiscript.hpp>
+# if defined( _MSC_VER )
+#  pragma warning( pop )
+# endif
+#endif
+
+
+namespace {
+
+// the handler in each script language, it is called with ( i, 1 ).
+constexpr char tea_code[] = R"_SCRIPT_(
+func handler( a, b ) {
+    a + b
+}
+)_SCRIPT_";
+
+constexpr char chai_code[] = R"_SCRIPT_(
+def handler( a, b ) {
+    return a + b;
+}
+)_SCRIPT_";
+
+constexpr char jinx_code[] = R"_SCRIPT_(
+import core
+
+function handler {a} plus {b}
+    return a + b
+end
+)_SCRIPT_";
+
+
+// calls call( i ) for the first call, the loop of warm calls (the measured region) and the single timed calls.
+// returns the time of the measured region. the first call and the percentiles are added as metrics.
+template< typename F >
+double measure_calls( long long const calls, long long const samples, F &&call )
+{
+    using namespace std::chrono;
+
+    // the first call on the fresh engine.
+    auto const first_start = bench::Clock::now();
+    long long  sum         = call( 0 );
+    auto const first_end   = bench::Clock::now();
+
+    auto start = bench::Start();
+    for( long long i = 1; i <= calls; ++i ) {
+        sum += call( i );
+    }
+    auto end = bench::Stop();
+
+    bench::PrintValue( sum );
+
+    // single warm calls, timed with bench::Ticks() and the overhead of taking the time subtracted.
+    std::vector<double>  lat( static_cast<size_t>(samples) );
+    for( auto &l : lat ) {
+        auto const s = bench::Ticks();
+        sum += call( 1 );
+        auto const e = bench::Ticks();
+        l = bench::TicksToSecs( s, e ) * 1e9;
+    }
+    if( sum == 0 ) { // never true, but the calls cannot be optimized away.
+        puts( "" );
+    }
+    bench::AddMetric( "first-call-ns", duration<double, std::nano>( first_end - first_start ).count() );
+    if( !lat.empty() ) {
+        auto const stats = bench::CalcStats( lat );
+        bench::AddMetric( "call-p50-ns", stats.median );
+        bench::AddMetric( "call-p90-ns", stats.p90 );
+        bench::AddMetric( "call-p99-ns", stats.p99 );
+        bench::AddMetric( "call-max-ns", stats.max );
+    }
+
+    return bench::CalcTimeInSecs( start, end );
+}
+
+
+#if BENCH_ENABLE_TEA
+// we use our own engine for get access to the Context.
+class MyEngine : public teascript::Engine
+{
+public:
+    inline teascript::Context &GetContext() noexcept { return mContext; }
+};
+
+double exec_tea( long long const calls, long long const samples )
+{
+    MyEngine  engine;
+    try {
+        engine.ExecuteCode( tea_code );
+        auto  handler = engine.GetContext().FindValueObject( "handler" );
+        auto &func    = handler.GetValue<teascript::FunctionPtr>();
+        // the parameter vector is reused, only the value of the first parameter is changed for each call.
+        std::vector<teascript::ValueObject>  params;
+        params.push_back( teascript::ValueObject( teascript::Integer{}, teascript::ValueConfig( true ) ) );
+        params.push_back( teascript::ValueObject( teascript::Integer{ 1 }, teascript::ValueConfig( true ) ) );
+
+        return measure_calls( calls, samples, [&]( long long const i ) {
+            params[0].AssignValue( static_cast<teascript::Integer>(i) );
+            return func->Call( engine.GetContext(), params, {} ).GetAsInteger();
+        } );
+
+    } catch( teascript::exception::runtime_error const &ex ) {
+        teascript::util::pretty_print( ex );
+    } catch( std::exception const &ex ) {
+        puts( ex.what() );
+    }
+
+    return -1.0;
+}
+#endif
+
+#if BENCH_ENABLE_CHAI
+double exec_chai( long long const calls, long long const samples )
+{
+    chaiscript::ChaiScript chai;
+    try {
+        chai.eval( chai_code );
+        auto handler = chai.eval<std::function<int( int, int )>>( "handler" );
+
+        return measure_calls( calls, samples, [&]( long long const i ) {
+            return static_cast<long long>(handler( static_cast<int>(i), 1 ));
+        } );
+
+    } catch( chaiscript::Boxed_Value const &bv ) {
+        puts( chaiscript::boxed_cast<chaiscript::exception::eval_error const &>(bv).what() );
+    } catch( std::exception const &ex ) {
+        puts( ex.what() );
+    }
+
+    return -1.0;
+}
+#endif
+
+#if BENCH_ENABLE_JINX
+double exec_jinx( long long const calls, long long const samples )
+{
+    auto jinx   = Jinx::CreateRuntime(); // Jinx::Initialize() is done once in BenchCallback()
+    auto script = jinx->CreateScript( jinx_code );
+    try {
+        if( !script ) {
+            throw std::runtime_error( "Jinx Error!" );
+        }
+        do {
+            if( !script->Execute() ) {
+                throw std::runtime_error( "Jinx Error!" );
+            }
+        } while( !script->IsFinished() );
+        auto const id = script->FindFunction( nullptr, "handler {} plus {}" );
+        if( id == Jinx::InvalidID ) {
+            throw std::runtime_error( "Jinx: handler not found!" );
+        }
+
+        return measure_calls( calls, samples, [&]( long long const i ) {
+            return script->CallFunction( id, { Jinx::Variant( static_cast<int64_t>(i) ), Jinx::Variant( static_cast<int64_t>(1) ) } ).GetInteger();
+        } );
+
+    } catch( std::exception const &ex ) {
+        puts( ex.what() );
+    }
+    return -1.0;
+}
+#endif
+
+#if BENCH_ENABLE_CPP
+// the reference: the handler as std::function (as an event system would store it).
+double exec_cpp( long long const calls, long long const samples )
+{
+    std::function<long long( long long, long long )> handler = []( long long const a, long long const b ) { return a + b; };
+    auto *volatile pHandler = &handler; // so it cannot be inlined.
+    try {
+        return measure_calls( calls, samples, [&]( long long const i ) {
+            return (*pHandler)( i, 1 );
+        } );
+
+    } catch( std::exception const &ex ) {
+        puts( ex.what() );
+    }
+
+    return -1.0;
+}
+#endif
+
+} // namespace
+
+
+void PrintUsageCallback()
+{
+    std::cout << "Callback options:\n"
+                 "  --calls=N                    count of calls of the script function in the measured loop (default: " << BENCH_CALLS << ")\n"
+                 "  --samples=N                  count of single timed calls for the latency percentiles (default: " << BENCH_SAMPLES << ")\n"
+                 "use --alloc for the allocations per call.\n"
+                 "engines: cpp (std::function), tea, chai, jinx\n";
+}
+
+int BenchCallback( bench::CmdLine const &cmd )
+{
+    if( cmd.Has( "help" ) ) {
+        PrintUsageCallback();
+        return EXIT_SUCCESS;
+    }
+
+    bench::ApplyConfig( cmd );
+    bench::SetEngineVersion( "cpp", bench::CompilerVersion() );
+#if BENCH_ENABLE_JINX
+    bench::SetEngineVersion( "jinx", bench::VersionString( Jinx::MajorVersion, Jinx::MinorVersion, Jinx::PatchNumber ) );
+    Jinx::GlobalParams  params;
+    params.errorOnMaxInstrunctions = false;
+    Jinx::Initialize( params );
+#endif
+#if BENCH_ENABLE_TEA
+    bench::SetEngineVersion( "tea", bench::VersionString( TEASCRIPT_VERSION_MAJOR, TEASCRIPT_VERSION_MINOR, TEASCRIPT_VERSION_PATCH ) );
+#endif
+#if BENCH_ENABLE_CHAI
+    bench::SetEngineVersion( "chai", chaiscript::Build_Info::version() );
+#endif
+
+    auto const calls   = cmd.GetInt( "calls", BENCH_CALLS );
+    auto const samples = cmd.GetInt( "samples", BENCH_SAMPLES );
+    if( calls < 1 || samples < 0 ) {
+        std::cout << "Wrong parameters: calls must be >= 1, samples >= 0." << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::cout << "Benchmarking calling script functions from C++ in TeaScript, ChaiScript and Jinx ...\n";
+    std::cout << "... and C++ as a reference ... \n";
+
+    bench::Suite  suite( cmd, "callback", { { "calls", std::to_string( calls ) } } );
+    suite.SetOps( static_cast<double>(calls), "call" );
+#if BENCH_ENABLE_CPP
+    suite.Add( "cpp", "C++ std::function", [=] { return exec_cpp( calls, samples ); } );
+#endif
+#if BENCH_ENABLE_TEA
+    suite.Add( "tea", "TeaScript FunctionPtr->Call", [=] { return exec_tea( calls, samples ); } );
+#endif
+#if BENCH_ENABLE_CHAI
+    suite.Add( "chai", "ChaiScript std::function", [=] { return exec_chai( calls, samples ); } );
+#endif
+#if BENCH_ENABLE_JINX
+    suite.Add( "jinx", "Jinx CallFunction", [=] { return exec_jinx( calls, samples ); } );
+#endif
+
+    return suite.Run() == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+#if !defined BENCH_DRIVER
+int main( int argc, char *argv[] )
+{
+    bench::GetConfig() = { .warmup_runs = BENCH_WARMUP_RUNS, .min_runs = BENCH_MIN_RUNS, .max_runs = BENCH_MAX_RUNS,
+                           .target_rel_error = BENCH_TARGET_REL_ERROR };
+
+    return bench::Main( argc, argv, &BenchCallback );
+}
+#endif
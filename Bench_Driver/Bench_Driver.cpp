@@ -0,0 +1,114 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (C) 2024 Florian Thake, <contact |at| tea-age.solutions>.
+ * SPDX-License-Identifier: MIT
+ */
+
+
+// Single driver for all benchmarks. All benchmarks are compiled in (with BENCH_DRIVER defined in the project settings),
+// which benchmarks, engines and parameters are used is selected at runtime via command line, e.g.
+//
+//   Bench_Driver --bench=fib --kind=iterative --n=30 --engine=tea-vm,chai
+//
+// use --help for all options.
+
+
+// handle some annoying compile errors on MSVC
+#if defined _MSC_VER  && !defined _SILENCE_CXX17_CODECVT_HEADER_DEPRECATION_WARNING
+# define _SILENCE_CXX17_CODECVT_HEADER_DEPRECATION_WARNING
+#endif
+#if defined _MSC_VER  && !defined _SILENCE_CXX20_U8PATH_DEPRECATION_WARNING
+# define _SILENCE_CXX20_U8PATH_DEPRECATION_WARNING
+#endif
+#if defined _MSC_VER  && !defined _CRT_SECURE_NO_WARNINGS
+# define _CRT_SECURE_NO_WARNINGS
+#endif
+
+//for VS use /Zc:__cplusplus
+#if __cplusplus < 202002L
+# if defined _MSVC_LANG // fallback without /Zc:__cplusplus
+#  if !_HAS_CXX20
+#   error must use at least C++20
+#  endif
+# else
+#  error must use at least C++20
+# endif
+#endif
+
+
+#include <cstdlib> // EXIT_SUCCESS
+#include <cstdio>
+#include <iostream>
+
+#include "../Common/BenchCore.hpp"
+#include "../Common/BenchCmdLine.hpp"
+#define BENCH_ALLOC_IMPLEMENTATION // this is the main translation unit
+#include "../Common/BenchMain.hpp"
+
+
+// the entry points of the benchmarks.
+int BenchFibonacci( bench::CmdLine const &cmd );
+int BenchBufferOverhead( bench::CmdLine const &cmd );
+int BenchVariableLookup( bench::CmdLine const &cmd );
+int BenchStartup( bench::CmdLine const &cmd );
+int BenchParse( bench::CmdLine const &cmd );
+int BenchHostCall( bench::CmdLine const &cmd );
+int BenchCallback( bench::CmdLine const &cmd );
+int BenchMemory( bench::CmdLine const &cmd );
+int BenchBinding( bench::CmdLine const &cmd );
+
+struct Benchmark
+{
+    char const  *name;
+    char const  *description;
+    int        (*entry)( bench::CmdLine const & );
+};
+
+constexpr Benchmark benchmarks[] = {
+    { "fib",       "Fibonacci recursive / iterative",                   &BenchFibonacci },
+    { "buffer",    "BufferOverhead (fill a RGBA image pixel by pixel)", &BenchBufferOverhead },
+    { "varlookup", "VariableLookup (TeaScript Context)",                &BenchVariableLookup },
+    { "startup",   "Startup (time and memory to a ready engine)",       &BenchStartup },
+    { "parse",     "Parse (parse / compile throughput and scaling)",    &BenchParse },
+    { "hostcall",  "HostCall (calling C++ functions from script)",      &BenchHostCall },
+    { "callback",  "Callback (calling script functions from C++)",      &BenchCallback },
+    { "memory",    "Memory (heap and RSS per engine, variable, AST)",   &BenchMemory },
+    { "binding",   "Binding (zero-copy host frames: vector / mmap)",    &BenchBinding },
+};
+
+
+// runs all selected benchmarks.
+int RunBenchmarks( bench::CmdLine const &cmd )
+{
+    if( cmd.Has( "help" ) || cmd.Has( "list" ) ) {
+        std::cout << "\nusage: Bench_Driver [--bench=name,...] [options]\n\nbenchmarks:\n";
+        for( auto const &b : benchmarks ) {
+            std::cout << "  " << std::left << std::setw( 12 ) << b.name << b.description << '\n';
+        }
+        std::cout << std::right << std::endl;
+        if( cmd.Has( "list" ) ) {
+            return EXIT_SUCCESS;
+        }
+    }
+
+    int res  = EXIT_SUCCESS;
+    int runs = 0;
+    for( auto const &b : benchmarks ) {
+        if( cmd.Matches( "bench", b.name ) ) {
+            ++runs;
+            if( b.entry( cmd ) != EXIT_SUCCESS ) {
+                res = EXIT_FAILURE;
+            }
+        }
+    }
+    if( runs == 0 ) {
+        std::cout << "Unknown benchmark: " << cmd.Get( "bench" ) << " (see --list)" << std::endl;
+        res = EXIT_FAILURE;
+    }
+    return res;
+}
+
+
+int main( int argc, char *argv[] )
+{
+    return bench::Main( argc, argv, &RunBenchmarks );
+}
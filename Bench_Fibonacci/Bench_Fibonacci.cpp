@@ -3,7 +3,7 @@
  * SPDX-License-Identifier: MIT
  */
 
-// Benchmarking calculating Fibonacci in script languages in and for C++ (ChaiScript, TeaScript, Jinx), using C++ as reference.
+// Benchmarking calculating Fibonacci in script languages in and for C++ (ChaiScript, TeaScript, Jinx), using C++ and Lua as reference.
 
 // === BENCH CONFIG ===
 
@@ -11,14 +11,21 @@
 #define BENCH_ENABLE_CHAI  1                    // 1 == Enable ChaiScript, 0 == Disable
 #define BENCH_ENABLE_JINX  1                    // 1 == Enable Jinx, 0 == Disable
 #define BENCH_ENABLE_TEA   1                    // 1 == Enable TeaScript, 0 == Disable
+#define BENCH_ENABLE_LUA   1                    // 1 == Enable Lua (embedded via the C API, needs the Lua library), 0 == Disable
 
 #define BENCH_RECURSIVE    1                    // option for recursive calculation of Fibonacci 25
 #define BENCH_ITERATIVE    2                    // option for iterative calculation of Fibonacci 25
-#define BENCH_KIND         BENCH_RECURSIVE      // decide between recursive or iterative calculation benchmark.
+#define BENCH_KIND         BENCH_RECURSIVE      // default for --kind, decide between recursive or iterative calculation benchmark.
 
-#define BENCH_ITERATIONS   3                    // loop count of each tested language.
+#define BENCH_WARMUP_RUNS      1                // runs of each tested language before measuring (not part of the statistic).
+#define BENCH_MIN_RUNS         5                // minimum count of measured runs of each tested language.
+#define BENCH_MAX_RUNS         30               // maximum count of measured runs of each tested language.
+#define BENCH_TARGET_REL_ERROR 0.02             // repeat until the 95% confidence interval of the mean is within +-2% (or BENCH_MAX_RUNS is reached).
 
-#define BENCH_FIB_NUM      25                   // the Fibonacci number to calculate.
+#define BENCH_FIB_NUM      25                   // default for --n, the Fibonacci number to calculate.
+
+// NOTE: all tests of the enabled languages are compiled in. Which are run and with which parameters can be selected
+//       via command line, e.g. --kind=recursive,iterative --n=20,25 --engine=tea-vm,chai (see --help)
 
 
 // handle some annoying compile errors on MSVC
@@ -47,8 +54,18 @@
 
 #include <cstdlib> // EXIT_SUCCESS
 #include <cstdio>
+#include <cstdint>
 #include <iostream>
 #include <chrono>
+#include <memory>
+
+#include "../Common/BenchCore.hpp"
+#include "../Common/BenchCmdLine.hpp"
+#include "../Common/BenchTimer.hpp"
+#if !defined BENCH_DRIVER
+# define BENCH_ALLOC_IMPLEMENTATION // this is the main translation unit
+#endif
+#include "../Common/BenchMain.hpp"
 
 #if BENCH_ENABLE_JINX
 #include <Jinx.hpp>
@@ -80,8 +97,15 @@
 #  pragma warning( pop )
 # endif
 #endif
+#if BENCH_ENABLE_LUA
+#include <lua.hpp>
+# if defined( _MSC_VER )
+#  pragma comment( lib, "lua54.lib" )
+# endif
+#endif
 
 
+namespace {
 
 // recursive fibonacci function in TeaScript
 constexpr char tea_code[] = R"_SCRIPT_(
@@ -182,6 +206,40 @@ def fib( x )
 fib( fib_num );
 )_SCRIPT_";
 
+// recursive fibonacci function in Lua (the same as fib.lua)
+constexpr char lua_code[] = R"_SCRIPT_(
+fib = function( x )
+    if x == 1 or x == 0 then
+        return x
+    else
+        return fib( x - 1 ) + fib( x - 2 )
+    end
+end
+
+return fib( fib_num )
+)_SCRIPT_";
+
+// iterative fibonacci function in Lua
+constexpr char lua_loop_code[] = R"_SCRIPT_(
+fib = function( x )
+    if x > 1 then
+        local out  = 1
+        local prev = 0
+        local tmp  = 1
+        for i = 2, x do
+            tmp  = out
+            out  = out + prev
+            prev = tmp
+        end
+        return out
+    else
+        return x
+    end
+end
+
+return fib( fib_num )
+)_SCRIPT_";
+
 // recursive fibonacci function in Jinx
 constexpr char jinx_code[] = R"_SCRIPT_(
 import core
@@ -220,38 +278,24 @@ set res to fib fib_num
 )_SCRIPT_";
 
 
-// for time measurement...
-
-auto Now()
-{
-    return std::chrono::steady_clock::now();
-}
-
-double CalcTimeInSecs( auto s, auto e )
-{   
-    std::chrono::duration<double> const  timesecs = e - s;
-    return timesecs.count();
-}
-
-
 // now the execution functions. we meausre only the execution times of the scripts. parsing and bootstrapping are excluded.
 
 #if BENCH_ENABLE_TEA
-double exec_tea()
+double exec_tea( long long const fib_num )
 {
     teascript::Context c;
     teascript::CoreLibrary().Bootstrap( c, teascript::config::core() );
-    c.AddValueObject( "fib_num", teascript::ValueObject( static_cast<teascript::Integer>(BENCH_FIB_NUM), teascript::ValueConfig( true ) ) );
+    c.AddValueObject( "fib_num", teascript::ValueObject( static_cast<teascript::Integer>(fib_num), teascript::ValueConfig( true ) ) );
     teascript::Parser  p;
     auto ast = p.Parse( tea_code );
     try {
-        auto start  = Now();
+        auto start  = bench::Start();
         auto teares = ast->Eval( c );
-        auto end    = Now();
+        auto end    = bench::Stop();
 
-        std::cout << "value: " << teares.GetAsInteger() << std::endl;
+        bench::PrintValue( teares.GetAsInteger() );
 
-        return CalcTimeInSecs( start, end );
+        return bench::CalcTimeInSecs( start, end );
 
     } catch( teascript::exception::runtime_error const &ex ) {
         teascript::util::pretty_print( ex );
@@ -263,26 +307,35 @@ double exec_tea()
 }
 
 #if TEASCRIPT_VERSION >= TEASCRIPT_BUILD_VERSION_NUMBER(0,14,0)
-double exec_tea_compiled()
+// compiles the code with the optimization level opt and executes it in a Machine<MachineFlag>.
+// the compile time (without parsing) is added as metric compile-us (not in the worker threads of --threads).
+template< bool MachineFlag >
+double exec_tea_vm( char const *code, teascript::eOptimize const opt, long long const fib_num )
 {
     teascript::Context c;
     teascript::CoreLibrary().Bootstrap( c, teascript::config::core() );
-    c.AddValueObject( "fib_num", teascript::ValueObject( static_cast<teascript::Integer>(BENCH_FIB_NUM), teascript::ValueConfig( true ) ) );
-    auto machine = std::make_shared<teascript::StackVM::Machine<false>>();
+    c.AddValueObject( "fib_num", teascript::ValueObject( static_cast<teascript::Integer>(fib_num), teascript::ValueConfig( true ) ) );
+    auto machine = std::make_shared<teascript::StackVM::Machine<MachineFlag>>();
     teascript::Parser  p;
     teascript::StackVM::Compiler  compiler;
     try {
-        auto prog = compiler.Compile( p.Parse( tea_code ), teascript::eOptimize::O2 );
+        auto ast = p.Parse( code );
+        auto const compile_start = bench::Clock::now();
+        auto prog = compiler.Compile( ast, opt );
+        auto const compile_secs = bench::CalcTimeInSecs( compile_start, bench::Clock::now() );
+        if( bench::WorkerIndex() < 0 ) { // the metrics are not thread safe.
+            bench::AddMetric( "compile-us", compile_secs * 1e6 );
+        }
 
-        auto start = Now();
+        auto start = bench::Start();
         machine->Exec( prog, c );
         machine->ThrowPossibleErrorException();
         auto teares = machine->MoveResult();
-        auto end = Now();
+        auto end = bench::Stop();
 
-        std::cout << "value: " << teares.GetAsInteger() << std::endl;
+        bench::PrintValue( teares.GetAsInteger() );
 
-        return CalcTimeInSecs( start, end );
+        return bench::CalcTimeInSecs( start, end );
 
     } catch( teascript::exception::runtime_error const &ex ) {
         teascript::util::pretty_print( ex );
@@ -294,22 +347,43 @@ double exec_tea_compiled()
 }
 #endif
 
-template< typename T, size_t N>
-double exec_tea_loop( T const (&code)[N] )
+#if TEASCRIPT_VERSION >= TEASCRIPT_BUILD_VERSION_NUMBER(0,14,0)
+// compiles the code once for all runs and threads of a test, returns nullptr on error.
+teascript::StackVM::ProgramPtr compile_tea( char const *code )
+{
+    teascript::Parser  p;
+    teascript::StackVM::Compiler  compiler;
+    try {
+        return compiler.Compile( p.Parse( code ), teascript::eOptimize::O2 );
+    } catch( teascript::exception::runtime_error const &ex ) {
+        teascript::util::pretty_print( ex );
+    } catch( std::exception const &ex ) {
+        puts( ex.what() );
+    }
+    return nullptr;
+}
+
+// executes the shared (already compiled) program with an own Machine and Context.
+// with --threads all threads execute the same program concurrently, compare with "tea-vm" where each thread compiles its own.
+double exec_tea_shared( teascript::StackVM::ProgramPtr const &prog, long long const fib_num )
 {
+    if( !prog ) {
+        return -1.0;
+    }
     teascript::Context c;
     teascript::CoreLibrary().Bootstrap( c, teascript::config::core() );
-    c.AddValueObject( "fib_num", teascript::ValueObject( static_cast<teascript::Integer>(BENCH_FIB_NUM), teascript::ValueConfig( true ) ) );
-    teascript::Parser  p;
-    auto ast = p.Parse( code );
+    c.AddValueObject( "fib_num", teascript::ValueObject( static_cast<teascript::Integer>(fib_num), teascript::ValueConfig( true ) ) );
+    auto machine = std::make_shared<teascript::StackVM::Machine<false>>();
     try {
-        auto start = Now();
-        auto teares = ast->Eval( c );
-        auto end = Now();
+        auto start = bench::Start();
+        machine->Exec( prog, c );
+        machine->ThrowPossibleErrorException();
+        auto teares = machine->MoveResult();
+        auto end = bench::Stop();
 
-        std::cout << "value: " << teares.GetAsInteger() << std::endl;
+        bench::PrintValue( teares.GetAsInteger() );
 
-        return CalcTimeInSecs( start, end );
+        return bench::CalcTimeInSecs( start, end );
 
     } catch( teascript::exception::runtime_error const &ex ) {
         teascript::util::pretty_print( ex );
@@ -319,29 +393,24 @@ double exec_tea_loop( T const (&code)[N] )
 
     return -1.0;
 }
+#endif
 
-#if TEASCRIPT_VERSION >= TEASCRIPT_BUILD_VERSION_NUMBER(0,14,0)
 template< typename T, size_t N>
-double exec_tea_loop_compiled( T const (&code)[N] )
+double exec_tea_loop( T const (&code)[N], long long const fib_num )
 {
     teascript::Context c;
     teascript::CoreLibrary().Bootstrap( c, teascript::config::core() );
-    c.AddValueObject( "fib_num", teascript::ValueObject( static_cast<teascript::Integer>(BENCH_FIB_NUM), teascript::ValueConfig( true ) ) );
-    auto machine = std::make_shared<teascript::StackVM::Machine<false>>();
+    c.AddValueObject( "fib_num", teascript::ValueObject( static_cast<teascript::Integer>(fib_num), teascript::ValueConfig( true ) ) );
     teascript::Parser  p;
-    teascript::StackVM::Compiler  compiler;
+    auto ast = p.Parse( code );
     try {
-        auto prog = compiler.Compile( p.Parse( code ), teascript::eOptimize::O2 );
-
-        auto start = Now();
-        machine->Exec( prog, c );
-        machine->ThrowPossibleErrorException();
-        auto teares = machine->MoveResult();
-        auto end = Now();
+        auto start = bench::Start();
+        auto teares = ast->Eval( c );
+        auto end = bench::Stop();
 
-        std::cout << "value: " << teares.GetAsInteger() << std::endl;
+        bench::PrintValue( teares.GetAsInteger() );
 
-        return CalcTimeInSecs( start, end );
+        return bench::CalcTimeInSecs( start, end );
 
     } catch( teascript::exception::runtime_error const &ex ) {
         teascript::util::pretty_print( ex );
@@ -351,23 +420,55 @@ double exec_tea_loop_compiled( T const (&code)[N] )
 
     return -1.0;
 }
+
+#if TEASCRIPT_VERSION >= TEASCRIPT_BUILD_VERSION_NUMBER(0,14,0)
+// the optimization levels of --tea-sweep.
+struct TeaOptLevel { char const *id; char const *title; teascript::eOptimize opt; };
+constexpr TeaOptLevel tea_opt_levels[] = {
+    { "debug", "Debug", teascript::eOptimize::Debug },
+    { "o0",    "O0",    teascript::eOptimize::O0 },
+    { "o1",    "O1",    teascript::eOptimize::O1 },
+    { "o2",    "O2",    teascript::eOptimize::O2 },
+};
+
+// runs the code with the AST Eval (ast) and in the TeaStackVM with all optimization levels, each in Machine<false>
+// and Machine<true>. prints the compile time, the time per run and the break-even against the AST Eval.
+int run_tea_sweep( bench::CmdLine const &cmd, bench::Params params, std::string const &title, char const *code,
+                   std::function<double()> ast, long long const fib_num, double const ops, std::string const &ops_unit )
+{
+    bench::Suite  suite( cmd, "fib-tea-sweep", std::move( params ) );
+    suite.SetOps( ops, ops_unit );
+    suite.Add( "tea-ast", title + " AST Eval", std::move( ast ) );
+    for( auto const &lvl : tea_opt_levels ) {
+        suite.Add( std::string( "tea-vm-" ) + lvl.id, title + " TeaStackVM " + lvl.title,
+                   [=, opt = lvl.opt] { return exec_tea_vm<false>( code, opt, fib_num ); } );
+        suite.Add( std::string( "tea-vm-" ) + lvl.id + "-mtrue", title + " TeaStackVM " + lvl.title + " Machine<true>",
+                   [=, opt = lvl.opt] { return exec_tea_vm<true>( code, opt, fib_num ); } );
+    }
+
+    auto const first  = bench::Records().size();
+    int const  failed = suite.Run();
+    bench::PrintBreakEven( title + " optimization levels", first, "compile-us", "tea-ast" );
+    return failed;
+}
 #endif
+
 #endif
 
 #if BENCH_ENABLE_CHAI
-double exec_chai()
+double exec_chai( long long const fib_num )
 {
     chaiscript::ChaiScript chai;
-    chai.add( chaiscript::const_var( BENCH_FIB_NUM ), "fib_num" );
+    chai.add( chaiscript::const_var( static_cast<int>(fib_num) ), "fib_num" );
     auto ast = chai.parse( chai_code );
     try {
-        auto start = Now();
+        auto start = bench::Start();
         auto chres = chai.eval( *ast );
-        auto end   = Now();
+        auto end   = bench::Stop();
 
-        std::cout << "value: " << chaiscript::boxed_cast<int>(chres) << std::endl;
+        bench::PrintValue( chaiscript::boxed_cast<int>(chres) );
 
-        return CalcTimeInSecs( start, end );
+        return bench::CalcTimeInSecs( start, end );
         
     } catch( chaiscript::Boxed_Value const &bv ) {
         puts( chaiscript::boxed_cast<chaiscript::exception::eval_error const &>(bv).what() );
@@ -378,19 +479,19 @@ double exec_chai()
     return -1.0;
 }
 
-double exec_chai_loop()
+double exec_chai_loop( long long const fib_num )
 {
     chaiscript::ChaiScript chai;
-    chai.add( chaiscript::const_var( BENCH_FIB_NUM ), "fib_num" );
+    chai.add( chaiscript::const_var( static_cast<int>(fib_num) ), "fib_num" );
     auto ast = chai.parse( chai_loop_code );
     try {
-        auto start = Now();
+        auto start = bench::Start();
         auto chres = chai.eval( *ast );
-        auto end = Now();
+        auto end = bench::Stop();
 
-        std::cout << "value: " << chaiscript::boxed_cast<int>(chres) << std::endl;
+        bench::PrintValue( chaiscript::boxed_cast<int>(chres) );
 
-        return CalcTimeInSecs( start, end );
+        return bench::CalcTimeInSecs( start, end );
 
     } catch( chaiscript::Boxed_Value const &bv ) {
         puts( chaiscript::boxed_cast<chaiscript::exception::eval_error const &>(bv).what() );
@@ -404,29 +505,24 @@ double exec_chai_loop()
 
 
 #if BENCH_ENABLE_JINX
-double exec_jinx()
+double exec_jinx( long long const fib_num )
 {
-    Jinx::GlobalParams  params;
-    params.errorOnMaxInstrunctions = false;
-    //params.logSymbols = true;
-    //params.logBytecode = true;
-    Jinx::Initialize( params );
-    auto jinx = Jinx::CreateRuntime();
-    jinx->GetLibrary( "core" )->RegisterProperty( Jinx::Visibility::Public, Jinx::Access::ReadOnly, "fib_num", Jinx::Variant( BENCH_FIB_NUM ) );
+    auto jinx = Jinx::CreateRuntime(); // Jinx::Initialize() is done once in BenchFibonacci()
+    jinx->GetLibrary( "core" )->RegisterProperty( Jinx::Visibility::Public, Jinx::Access::ReadOnly, "fib_num", Jinx::Variant( static_cast<int64_t>(fib_num) ) );
     auto script = jinx->CreateScript( jinx_code );
     try {
-        auto start = Now();
+        auto start = bench::Start();
         do {
             bool const res = script->Execute();
             if( !res ) {
                 throw std::runtime_error( "Jinx Error!" );
             }
         } while( !script->IsFinished() );
-        auto end = Now();
+        auto end = bench::Stop();
 
-        std::cout << "value: " << script->GetVariable( "res" ).GetInteger() << std::endl;
+        bench::PrintValue( script->GetVariable( "res" ).GetInteger() );
 
-        return CalcTimeInSecs( start, end );
+        return bench::CalcTimeInSecs( start, end );
 
     } catch( std::exception const &ex ) {
         puts( ex.what() );
@@ -434,29 +530,24 @@ double exec_jinx()
     return -1.0;
 }
 
-double exec_jinx_loop()
+double exec_jinx_loop( long long const fib_num )
 {
-    Jinx::GlobalParams  params;
-    params.errorOnMaxInstrunctions = false;
-    //params.logSymbols = true;
-    //params.logBytecode = true;
-    Jinx::Initialize( params );
-    auto jinx = Jinx::CreateRuntime();
-    jinx->GetLibrary( "core" )->RegisterProperty( Jinx::Visibility::Public, Jinx::Access::ReadOnly, "fib_num", Jinx::Variant( BENCH_FIB_NUM ) );
+    auto jinx = Jinx::CreateRuntime(); // Jinx::Initialize() is done once in BenchFibonacci()
+    jinx->GetLibrary( "core" )->RegisterProperty( Jinx::Visibility::Public, Jinx::Access::ReadOnly, "fib_num", Jinx::Variant( static_cast<int64_t>(fib_num) ) );
     auto script = jinx->CreateScript( jinx_loop_code );
     try {
-        auto start = Now();
+        auto start = bench::Start();
         do {
             bool const res = script->Execute();
             if( !res ) {
                 throw std::runtime_error( "Jinx Error!" );
             }
         } while( !script->IsFinished() );
-        auto end = Now();
+        auto end = bench::Stop();
 
-        std::cout << "value: " << script->GetVariable( "res" ).GetInteger() << std::endl;
+        bench::PrintValue( script->GetVariable( "res" ).GetInteger() );
 
-        return CalcTimeInSecs( start, end );
+        return bench::CalcTimeInSecs( start, end );
 
     } catch( std::exception const &ex ) {
         puts( ex.what() );
@@ -465,6 +556,39 @@ double exec_jinx_loop()
 }
 #endif
 
+#if BENCH_ENABLE_LUA
+// the code is loaded (parsed and compiled to Lua bytecode) before, only lua_pcall() is measured.
+double exec_lua( char const *code, long long const fib_num )
+{
+    std::unique_ptr<lua_State, decltype(&lua_close)>  state( luaL_newstate(), &lua_close );
+    if( !state ) {
+        puts( "Lua: cannot create state!" );
+        return -1.0;
+    }
+    auto L = state.get();
+    luaL_openlibs( L );
+    lua_pushinteger( L, static_cast<lua_Integer>(fib_num) );
+    lua_setglobal( L, "fib_num" );
+    if( luaL_loadstring( L, code ) != LUA_OK ) {
+        puts( lua_tostring( L, -1 ) );
+        return -1.0;
+    }
+
+    auto start  = bench::Start();
+    auto status = lua_pcall( L, 0, 1, 0 );
+    auto end    = bench::Stop();
+
+    if( status != LUA_OK ) {
+        puts( lua_tostring( L, -1 ) );
+        return -1.0;
+    }
+
+    bench::PrintValue( static_cast<long long>(lua_tointeger( L, -1 )) );
+
+    return bench::CalcTimeInSecs( start, end );
+}
+#endif
+
 // recursive fibonacci function in C++
 long long fib( long long x )
 {
@@ -475,16 +599,22 @@ long long fib( long long x )
     }
 }
 
-double exec_cpp()
+// the C++ references are measured in batches (see bench::MeasureBatched()), the input and the result go through
+// DoNotOptimize(), so the calculation cannot be done at compile time or be hoisted out of the batch.
+double exec_cpp( long long const fib_num )
 {
     try {
-        auto start = Now();
-        auto res   = fib( BENCH_FIB_NUM );
-        auto end   = Now();
+        long long  res  = 0;
+        auto const secs = bench::MeasureBatched( [&] {
+            auto x = fib_num;
+            bench::DoNotOptimize( x );
+            res = fib( x );
+            bench::DoNotOptimize( res );
+        } );
 
-        std::cout << "value: " << res << std::endl;
+        bench::PrintValue( res );
 
-        return CalcTimeInSecs( start, end );
+        return secs;
 
     } catch( std::exception const &ex ) {
         puts( ex.what() );
@@ -508,16 +638,20 @@ long long fib_loop( long long x ) noexcept
     return out;
 }
 
-double exec_cpp_loop()
+double exec_cpp_loop( long long const fib_num )
 {
     try {
-        auto start = Now();
-        auto res = fib_loop( BENCH_FIB_NUM );
-        auto end = Now();
+        long long  res  = 0;
+        auto const secs = bench::MeasureBatched( [&] {
+            auto x = fib_num;
+            bench::DoNotOptimize( x );
+            res = fib_loop( x );
+            bench::DoNotOptimize( res );
+        } );
 
-        std::cout << "value: " << res << std::endl;
+        bench::PrintValue( res );
 
-        return CalcTimeInSecs( start, end );
+        return secs;
 
     } catch( std::exception const &ex ) {
         puts( ex.what() );
@@ -526,120 +660,176 @@ double exec_cpp_loop()
     return -1.0;
 }
 
-int main()
+// count of calls of the recursive fib( n ), which is 2 * fib( n + 1 ) - 1
+long long fib_calls( long long const fib_num )
 {
-    std::cout << std::fixed;
-    std::cout << std::setprecision( 8 );
+    long long a = 1, b = 1; // calls for fib( 0 ) and fib( 1 )
+    for( long long i = 2; i <= fib_num; ++i ) {
+        auto const c = a + b + 1;
+        a = b;
+        b = c;
+    }
+    return b;
+}
 
-    std::cout << "Benchmarking TeaScript, ChaiScript and Jinx in calculating Fibonacci of " << BENCH_FIB_NUM << " ...\n";
-    std::cout << "... and C++ as a reference ... \n";
+} // namespace
 
-    // --- recursive ---
 
-#if BENCH_ENABLE_CPP && (BENCH_KIND == BENCH_RECURSIVE)
-    std::cout << "\nStart Test C++" << std::endl;
-    for( int i = BENCH_ITERATIONS; i != 0; --i ) {
-        auto secs = exec_cpp();
-        std::cout << "Calculation took: " << secs << " seconds." << std::endl;
-    }
-#endif
+void PrintUsageFibonacci()
+{
+    std::cout << "Fibonacci options:\n"
+                 "  --kind=recursive,iterative   kind(s) of calculation (default: " << (BENCH_KIND == BENCH_RECURSIVE ? "recursive" : "iterative") << ")\n"
+                 "  --n=N,...                    Fibonacci number(s) to calculate (default: " << BENCH_FIB_NUM << ")\n"
+                 "engines: cpp, jinx, tea, tea-forall, tea-vm, tea-vm-forall, tea-vm-shared, chai, lua (the forall variants are iterative only)\n"
+                 "  tea-vm-shared executes one program compiled once per test, with --threads shared by all threads.\n"
+                 "  --tea-sweep                  instead: TeaScript only, the AST Eval and the TeaStackVM with all optimization levels\n"
+                 "                               in Machine<false> and Machine<true>, prints the compile time and the break-even runs\n";
+}
 
-#if BENCH_ENABLE_JINX && (BENCH_KIND == BENCH_RECURSIVE)
-    std::cout << "\nStart Test Jinx" << std::endl;
-    for( int i = BENCH_ITERATIONS; i != 0; --i ) {
-        auto secs = exec_jinx();
-        std::cout << "Calculation took: " << secs << " seconds." << std::endl;
+int BenchFibonacci( bench::CmdLine const &cmd )
+{
+    if( cmd.Has( "help" ) ) {
+        PrintUsageFibonacci();
+        return EXIT_SUCCESS;
     }
-#endif
 
-#if BENCH_ENABLE_TEA && (BENCH_KIND == BENCH_RECURSIVE)
-    std::cout << "\nStart Test TeaScript" << std::endl;
-    for( int i = BENCH_ITERATIONS; i != 0; --i ) {
-        auto secs = exec_tea();
-        std::cout << "Calculation took: " << secs << " seconds." << std::endl;
-    }
+    bench::ApplyConfig( cmd );
+    bench::SetEngineVersion( "cpp", bench::CompilerVersion() );
+#if BENCH_ENABLE_JINX
+    bench::SetEngineVersion( "jinx", bench::VersionString( Jinx::MajorVersion, Jinx::MinorVersion, Jinx::PatchNumber ) );
+    // the global params, this must not be done concurrently in the threads of --threads.
+    Jinx::GlobalParams  params;
+    params.errorOnMaxInstrunctions = false;
+    //params.logSymbols = true;
+    //params.logBytecode = true;
+    Jinx::Initialize( params );
+#endif
+#if BENCH_ENABLE_TEA
+    bench::SetEngineVersion( "tea", bench::VersionString( TEASCRIPT_VERSION_MAJOR, TEASCRIPT_VERSION_MINOR, TEASCRIPT_VERSION_PATCH ) );
+#endif
+#if BENCH_ENABLE_CHAI
+    bench::SetEngineVersion( "chai", chaiscript::Build_Info::version() );
+#endif
+#if BENCH_ENABLE_LUA
+    bench::SetEngineVersion( "lua", LUA_VERSION_MAJOR "." LUA_VERSION_MINOR "." LUA_VERSION_RELEASE );
 #endif
 
-#if BENCH_ENABLE_TEA && (BENCH_KIND == BENCH_RECURSIVE)
+    auto const kinds    = cmd.GetList( "kind", { BENCH_KIND == BENCH_RECURSIVE ? "recursive" : "iterative" } );
+    auto const fib_nums = cmd.GetIntList( "n", { BENCH_FIB_NUM } );
+
+    std::cout << "Benchmarking TeaScript, ChaiScript and Jinx in calculating Fibonacci ...\n";
+    std::cout << "... and C++ and Lua as a reference ... \n";
+
+    int failed = 0;
+    for( auto const &kind : kinds ) {
+        if( kind != "recursive" && kind != "iterative" ) {
+            std::cout << "Unknown kind: " << kind << std::endl;
+            return EXIT_FAILURE;
+        }
+        for( auto const fib_num : fib_nums ) {
+            if( cmd.Has( "tea-sweep" ) ) {
+#if BENCH_ENABLE_TEA
 #if TEASCRIPT_VERSION >= TEASCRIPT_BUILD_VERSION_NUMBER(0,14,0)
-    std::cout << "\nStart Test TeaScript in TeaStackVM" << std::endl;
-    for( int i = BENCH_ITERATIONS; i != 0; --i ) {
-        auto secs = exec_tea_compiled();
-        std::cout << "Calculation took: " << secs << " seconds." << std::endl;
-    }
+                bench::Params const  params{ { "kind", kind }, { "n", std::to_string( fib_num ) } };
+                if( kind == "recursive" ) {
+                    failed += run_tea_sweep( cmd, params, "TeaScript", tea_code, [=] { return exec_tea( fib_num ); },
+                                             fib_num, static_cast<double>(fib_calls( fib_num )), "fib call" );
+                } else {
+                    double const iterations = static_cast<double>(fib_num > 1 ? fib_num - 1 : 1);
+                    auto loop_params = params;
+                    loop_params.emplace_back( "loop", "repeat" );
+                    failed += run_tea_sweep( cmd, std::move( loop_params ), "TeaScript LOOP", tea_loop_code,
+                                             [=] { return exec_tea_loop( tea_loop_code, fib_num ); }, fib_num, iterations, "iteration" );
+                    auto forall_params = params;
+                    forall_params.emplace_back( "loop", "forall" );
+                    failed += run_tea_sweep( cmd, std::move( forall_params ), "TeaScript LOOP (NEW forall)", tea_loop_code_new,
+                                             [=] { return exec_tea_loop( tea_loop_code_new, fib_num ); }, fib_num, iterations, "iteration" );
+                }
+#else
+                std::cout << "--tea-sweep needs TeaScript 0.14 or newer." << std::endl;
+                return EXIT_FAILURE;
 #endif
+#else
+                std::cout << "--tea-sweep needs TeaScript 0.14 or newer." << std::endl;
+                return EXIT_FAILURE;
 #endif
+                continue;
+            }
 
-#if BENCH_ENABLE_CHAI && (BENCH_KIND == BENCH_RECURSIVE)
-    std::cout << "\nStart Test ChaiScript" << std::endl;
-    for( int i = BENCH_ITERATIONS; i != 0; --i ) {
-        auto secs = exec_chai();
-        std::cout << "Calculation took: " << secs << " seconds." << std::endl;
-    }
-#endif
+            bench::Suite  suite( cmd, "fib", { { "kind", kind }, { "n", std::to_string( fib_num ) } } );
+            suite.AllowThreads();
 
-    // --- iterative ---
+            // --- recursive ---
 
-#if BENCH_ENABLE_CPP && (BENCH_KIND == BENCH_ITERATIVE)
-    std::cout << "\nStart Test C++ LOOP" << std::endl;
-    for( int i = BENCH_ITERATIONS; i != 0; --i ) {
-        auto secs = exec_cpp_loop();
-        std::cout << "Calculation took: " << secs << " seconds." << std::endl;
-    }
+            if( kind == "recursive" ) {
+                suite.SetOps( static_cast<double>(fib_calls( fib_num )), "fib call" );
+#if BENCH_ENABLE_CPP
+                suite.Add( "cpp", "C++", [=] { return exec_cpp( fib_num ); } );
 #endif
-
-#if BENCH_ENABLE_JINX && (BENCH_KIND == BENCH_ITERATIVE)
-    std::cout << "\nStart Test Jinx LOOP" << std::endl;
-    for( int i = BENCH_ITERATIONS; i != 0; --i ) {
-        auto secs = exec_jinx_loop();
-        std::cout << "Calculation took: " << secs << " seconds." << std::endl;
-    }
+#if BENCH_ENABLE_JINX
+                suite.Add( "jinx", "Jinx", [=] { return exec_jinx( fib_num ); } );
 #endif
-
-#if BENCH_ENABLE_TEA && (BENCH_KIND == BENCH_ITERATIVE)
-    std::cout << "\nStart Test TeaScript LOOP" << std::endl;
-    for( int i = BENCH_ITERATIONS; i != 0; --i ) {
-        auto secs = exec_tea_loop( tea_loop_code );
-        std::cout << "Calculation took: " << secs << " seconds." << std::endl;
-    }
+#if BENCH_ENABLE_TEA
+                suite.Add( "tea", "TeaScript", [=] { return exec_tea( fib_num ); } );
+#if TEASCRIPT_VERSION >= TEASCRIPT_BUILD_VERSION_NUMBER(0,14,0)
+                suite.Add( "tea-vm", "TeaScript in TeaStackVM", [=] { return exec_tea_vm<false>( tea_code, teascript::eOptimize::O2, fib_num ); } );
+                if( cmd.Matches( "engine", "tea-vm-shared" ) ) {
+                    suite.Add( "tea-vm-shared", "TeaScript in TeaStackVM (shared program)", [=, prog = compile_tea( tea_code )] { return exec_tea_shared( prog, fib_num ); } );
+                }
 #endif
-
-#if BENCH_ENABLE_TEA && (BENCH_KIND == BENCH_ITERATIVE)
-#if TEASCRIPT_VERSION >= TEASCRIPT_BUILD_VERSION_NUMBER(0,12,0)
-    std::cout << "\nStart Test TeaScript LOOP (NEW forall)" << std::endl;
-    for( int i = BENCH_ITERATIONS; i != 0; --i ) {
-        auto secs = exec_tea_loop( tea_loop_code_new );
-        std::cout << "Calculation took: " << secs << " seconds." << std::endl;
-    }
 #endif
+#if BENCH_ENABLE_CHAI
+                suite.Add( "chai", "ChaiScript", [=] { return exec_chai( fib_num ); } );
+#endif
+#if BENCH_ENABLE_LUA
+                suite.Add( "lua", "Lua", [=] { return exec_lua( lua_code, fib_num ); } );
 #endif
+            }
 
-#if BENCH_ENABLE_TEA && (BENCH_KIND == BENCH_ITERATIVE)
-#if TEASCRIPT_VERSION >= TEASCRIPT_BUILD_VERSION_NUMBER(0,14,0)
-    std::cout << "\nStart Test TeaScript LOOP in TeaStackVM" << std::endl;
-    for( int i = BENCH_ITERATIONS; i != 0; --i ) {
-        auto secs = exec_tea_loop_compiled( tea_loop_code );
-        std::cout << "Calculation took: " << secs << " seconds." << std::endl;
-    }
+            // --- iterative ---
 
-    std::cout << "\nStart Test TeaScript LOOP (NEW forall) in TeaStackVM" << std::endl;
-    for( int i = BENCH_ITERATIONS; i != 0; --i ) {
-        auto secs = exec_tea_loop_compiled( tea_loop_code_new );
-        std::cout << "Calculation took: " << secs << " seconds." << std::endl;
-    }
+            if( kind == "iterative" ) {
+                suite.SetOps( static_cast<double>(fib_num > 1 ? fib_num - 1 : 1), "iteration" );
+#if BENCH_ENABLE_CPP
+                suite.Add( "cpp", "C++ LOOP", [=] { return exec_cpp_loop( fib_num ); } );
+#endif
+#if BENCH_ENABLE_JINX
+                suite.Add( "jinx", "Jinx LOOP", [=] { return exec_jinx_loop( fib_num ); } );
+#endif
+#if BENCH_ENABLE_TEA
+                suite.Add( "tea", "TeaScript LOOP", [=] { return exec_tea_loop( tea_loop_code, fib_num ); } );
+#if TEASCRIPT_VERSION >= TEASCRIPT_BUILD_VERSION_NUMBER(0,12,0)
+                suite.Add( "tea-forall", "TeaScript LOOP (NEW forall)", [=] { return exec_tea_loop( tea_loop_code_new, fib_num ); } );
+#endif
+#if TEASCRIPT_VERSION >= TEASCRIPT_BUILD_VERSION_NUMBER(0,14,0)
+                suite.Add( "tea-vm", "TeaScript LOOP in TeaStackVM", [=] { return exec_tea_vm<false>( tea_loop_code, teascript::eOptimize::O2, fib_num ); } );
+                suite.Add( "tea-vm-forall", "TeaScript LOOP (NEW forall) in TeaStackVM", [=] { return exec_tea_vm<false>( tea_loop_code_new, teascript::eOptimize::O2, fib_num ); } );
+                if( cmd.Matches( "engine", "tea-vm-shared" ) ) {
+                    suite.Add( "tea-vm-shared", "TeaScript LOOP in TeaStackVM (shared program)", [=, prog = compile_tea( tea_loop_code )] { return exec_tea_shared( prog, fib_num ); } );
+                }
 #endif
 #endif
+#if BENCH_ENABLE_CHAI
+                suite.Add( "chai", "ChaiScript LOOP", [=] { return exec_chai_loop( fib_num ); } );
+#endif
+#if BENCH_ENABLE_LUA
+                suite.Add( "lua", "Lua LOOP", [=] { return exec_lua( lua_loop_code, fib_num ); } );
+#endif
+            }
 
-#if BENCH_ENABLE_CHAI && (BENCH_KIND == BENCH_ITERATIVE)
-    std::cout << "\nStart Test ChaiScript LOOP" << std::endl;
-    for( int i = BENCH_ITERATIONS; i != 0; --i ) {
-        auto secs = exec_chai_loop();
-        std::cout << "Calculation took: " << secs << " seconds." << std::endl;
+            failed += suite.Run();
+        }
     }
-#endif
 
+    return failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
 
-    puts( "\n\nTest end." );
+#if !defined BENCH_DRIVER
+int main( int argc, char *argv[] )
+{
+    bench::GetConfig() = { .warmup_runs = BENCH_WARMUP_RUNS, .min_runs = BENCH_MIN_RUNS, .max_runs = BENCH_MAX_RUNS,
+                           .target_rel_error = BENCH_TARGET_REL_ERROR };
 
-    return EXIT_SUCCESS;
+    return bench::Main( argc, argv, &BenchFibonacci );
 }
+#endif
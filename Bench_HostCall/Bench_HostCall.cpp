@@ -0,0 +1,726 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (C) 2024 Florian Thake, <contact |at| tea-age.solutions>.
+ * SPDX-License-Identifier: MIT
+ */
+
+// Benchmarking the overhead of calling a registered C++ function from script in TeaScript VS ChaiScript VS Jinx.
+//
+// A script calls the host function 'hostcall' in a loop. The shape of the call is varied: count of arguments
+// (0, 1, 3, 6), type of the arguments (integer, double, string, buffer/vector by reference) and returning void or a value.
+// An empty loop is measured as well, so the time of the loop itself can be subtracted.
+// The results are reported as ns per call (and allocations per call with --alloc) in a matrix of shape x engine.
+
+// === BENCH CONFIG ===
+
+#define BENCH_ENABLE_CPP   1                    // 1 == Enable C++, 0 == Disable
+#define BENCH_ENABLE_CHAI  1                    // 1 == Enable ChaiScript, 0 == Disable
+#define BENCH_ENABLE_JINX  1                    // 1 == Enable Jinx, 0 == Disable
+#define BENCH_ENABLE_TEA   1                    // 1 == Enable TeaScript, 0 == Disable
+
+#define BENCH_WARMUP_RUNS      1                // runs of each test before measuring (not part of the statistic).
+#define BENCH_MIN_RUNS         5                // minimum count of measured runs for each test.
+#define BENCH_MAX_RUNS         30               // maximum count of measured runs for each test.
+#define BENCH_TARGET_REL_ERROR 0.02             // repeat until the 95% confidence interval of the mean is within +-2% (or BENCH_MAX_RUNS is reached).
+
+#define BENCH_CALLS        100000               // default for --calls, count of calls of the host function per run.
+#define BENCH_ARGS         "0,1,3,6"            // default for --args, count(s) of arguments (supported: 0, 1, 3, 6).
+#define BENCH_TYPES        "int,double,string,buffer" // default for --type, type(s) of the arguments.
+#define BENCH_RETS         "void,value"         // default for --ret, if the host function returns void or a value.
+
+// NOTE: all tests of the enabled languages are compiled in. Which are run and with which parameters can be selected
+//       via command line, e.g. --args=1,6 --type=string --ret=value --engine=tea-vm,chai --alloc (see --help)
+
+
+// handle some annoying compile errors on MSVC
+#if defined _MSC_VER  && !defined _SILENCE_CXX17_CODECVT_HEADER_DEPRECATION_WARNING
+# define _SILENCE_CXX17_CODECVT_HEADER_DEPRECATION_WARNING
+#endif
+#if defined _MSC_VER  && !defined _SILENCE_CXX20_U8PATH_DEPRECATION_WARNING
+# define _SILENCE_CXX20_U8PATH_DEPRECATION_WARNING
+#endif
+#if defined _MSC_VER  && !defined _CRT_SECURE_NO_WARNINGS
+# define _CRT_SECURE_NO_WARNINGS
+#endif
+
+//for VS use /Zc:__cplusplus
+#if __cplusplus < 202002L
+# if defined _MSVC_LANG // fallback without /Zc:__cplusplus
+#  if !_HAS_CXX20
+#   error must use at least C++20
+#  endif
+# else
+#  error must use at least C++20
+# endif
+#endif
+
+
+#include <algorithm>
+#include <cstdlib> // EXIT_SUCCESS
+#include <cstdio>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "../Common/BenchCore.hpp"
+#include "../Common/BenchCmdLine.hpp"
+#if !defined BENCH_DRIVER
+# define BENCH_ALLOC_IMPLEMENTATION // this is the main translation unit
+#endif
+#include "../Common/BenchMain.hpp"
+
+#if BENCH_ENABLE_JINX
+#include <Jinx.hpp>
+#endif
+#if BENCH_ENABLE_TEA
+#include <teascript/Engine.hpp>
+// check version if new enough (Buffer and forall exists)
+#if TEASCRIPT_VERSION < TEASCRIPT_BUILD_VERSION_NUMBER(0,13,0)
+# error Use TeaScript 0.13.0 or newer
+#endif
+#endif
+#if BENCH_ENABLE_CHAI
+#if defined(_WIN32)
+#  define NOMINMAX
+#  define WIN32_LEAN_AND_MEAN
+# endif
+# if defined( _MSC_VER )
+#  pragma warning( push )
+#  pragma warning( disable: 4244 )
+# endif
+#include <chaiscript/chaiscript.hpp>
+# if defined( _MSC_VER )
+#  pragma warning( pop )
+# endif
+#endif
+
+
+namespace {
+
+constexpr char string_arg[] = "a string argument of a typical length";
+constexpr size_t buffer_size = 64;
+
+// the host functions add something of each argument to it, so the arguments are used.
+long long  gSink = 0;
+
+enum class eType { None, Int, Double, String, Buffer };
+
+#if BENCH_ENABLE_TEA || BENCH_ENABLE_CHAI || BENCH_ENABLE_JINX
+// the name of the variable which is used as argument in the scripts.
+char const *arg_name( eType const type )
+{
+    switch( type ) {
+    case eType::Int:    return "vi";
+    case eType::Double: return "vd";
+    case eType::String: return "vs";
+    case eType::Buffer: return "buf";
+    case eType::None:   break;
+    }
+    return "";
+}
+#endif
+
+// the C++ types of the host functions for each argument type.
+template< eType T > struct ArgTraits;
+
+template<> struct ArgTraits<eType::None>
+{
+    using Param = long long;  // unused
+};
+
+template<> struct ArgTraits<eType::Int>
+{
+    using Param = long long;
+    static long long Touch( long long const v ) noexcept { return v; }
+    static long long Result( long long const v ) noexcept { return v; }
+};
+
+template<> struct ArgTraits<eType::Double>
+{
+    using Param = double;
+    static long long Touch( double const v ) noexcept { return static_cast<long long>(v); }
+    static double Result( double const v ) noexcept { return v; }
+};
+
+template<> struct ArgTraits<eType::String>
+{
+    using Param = std::string const &;
+    static long long Touch( std::string const &s ) noexcept { return static_cast<long long>(s.size()); }
+    static std::string Result( std::string const &s ) { return s; }
+};
+
+template<> struct ArgTraits<eType::Buffer>
+{
+    using Param = std::vector<unsigned char> &;
+    static long long Touch( std::vector<unsigned char> &b ) noexcept { return static_cast<long long>(b.size()); }
+    static size_t Result( std::vector<unsigned char> &b ) noexcept { return b.size(); }
+};
+
+template< size_t, typename P >
+using Param = P;
+
+// the host function with N arguments of type T, returning void or a value (for ChaiScript and the C++ reference).
+template< eType T, bool Ret, size_t ...I >
+auto make_host_function( std::index_sequence<I...> )
+{
+    using A = ArgTraits<T>;
+    return []( Param<I, typename A::Param> ...args ) {
+        ((gSink += A::Touch( args )), ...);
+        if constexpr( !Ret ) {
+            return;
+        } else if constexpr( sizeof...(I) == 0 ) {
+            return gSink;
+        } else {
+            return A::Result( std::get<0>( std::forward_as_tuple( args... ) ) );
+        }
+    };
+}
+
+
+// --- the scripts ---
+
+// calls of hostcall in a loop, or an empty loop if args < 0.
+#if BENCH_ENABLE_TEA
+std::string tea_script( int const args, eType const type )
+{
+    std::string call;
+    if( args >= 0 ) {
+        call = "    hostcall(";
+        for( int i = 0; i < args; ++i ) {
+            call += (i == 0 ? " " : ", ") + std::string( arg_name( type ) );
+        }
+        call += args > 0 ? " )\n" : ")\n";
+    }
+    return "forall( i in _seq( 1, calls, 1 ) ) {\n" + call + "}\ncalls\n";
+}
+#endif
+
+#if BENCH_ENABLE_CHAI
+std::string chai_script( int const args, eType const type )
+{
+    std::string call;
+    if( args >= 0 ) {
+        call = "    hostcall(";
+        for( int i = 0; i < args; ++i ) {
+            call += (i == 0 ? " " : ", ") + std::string( arg_name( type ) );
+        }
+        call += args > 0 ? " );\n" : ");\n";
+    }
+    return "for( var i = 0; i < calls; ++i ) {\n" + call + "}\ncalls;\n";
+}
+#endif
+
+#if BENCH_ENABLE_JINX
+// the Jinx signature of hostcall, the arguments are separated by name parts: "hostcall {} arg {} arg {}"
+std::string jinx_signature( int const args )
+{
+    std::string sig = "hostcall";
+    for( int i = 0; i < args; ++i ) {
+        sig += i == 0 ? " {}" : " arg {}";
+    }
+    return sig;
+}
+
+std::string jinx_script( int const args, eType const type )
+{
+    std::string call;
+    if( args >= 0 ) {
+        call = "    hostcall";
+        for( int i = 0; i < args; ++i ) {
+            call += (i == 0 ? " " : " arg ") + std::string( arg_name( type ) );
+        }
+        call += '\n';
+    }
+    return "import core\nimport host\n\n"
+           "set vi to 42\nset vd to 1.5\nset vs to \"" + std::string( string_arg ) + "\"\n\n"
+           "loop i from 1 to calls\n" + call + "end\nset res to calls\n";
+}
+#endif
+
+
+// --- the execution functions, we measure only the execution of the loop ---
+
+#if BENCH_ENABLE_TEA
+// the host function as TeaScript callback, works with any count of arguments.
+template< eType T, bool Ret >
+teascript::ValueObject tea_hostcall( teascript::Context &rContext )
+{
+    auto const count = rContext.CurrentParamCount();
+    teascript::ValueObject  first;
+    for( decltype(rContext.CurrentParamCount()) i = 0; i < count; ++i ) {
+        auto p = rContext.ConsumeParam();
+        if constexpr( T == eType::Int ) {
+            gSink += p.GetValue<teascript::Integer>();
+        } else if constexpr( T == eType::Double ) {
+            gSink += static_cast<long long>(p.GetValue<teascript::F64>());
+        } else if constexpr( T == eType::String ) {
+            gSink += static_cast<long long>(p.GetValue<teascript::String>().size());
+        } else if constexpr( T == eType::Buffer ) {
+            gSink += static_cast<long long>(p.GetValue<teascript::Buffer>().size());
+        }
+        if( i == 0 ) {
+            first = std::move( p );
+        }
+    }
+    if constexpr( Ret ) {
+        if constexpr( T == eType::Int ) {
+            return teascript::ValueObject( first.GetValue<teascript::Integer>() );
+        } else if constexpr( T == eType::Double ) {
+            return teascript::ValueObject( first.GetValue<teascript::F64>() );
+        } else if constexpr( T == eType::String ) {
+            return teascript::ValueObject( teascript::String( first.GetValue<teascript::String>() ) );
+        } else if constexpr( T == eType::Buffer ) {
+            return teascript::ValueObject( static_cast<teascript::U64>(first.GetValue<teascript::Buffer>().size()) );
+        } else {
+            return teascript::ValueObject( static_cast<long long>(gSink) );
+        }
+    }
+    return {};
+}
+
+// we use our own engine for get access to the low level parts.
+class MyEngine : public teascript::Engine
+{
+public:
+    MyEngine( ) : teascript::Engine( teascript::config::util() ) {}
+#if TEASCRIPT_VERSION >= TEASCRIPT_BUILD_VERSION_NUMBER(0,14,0)
+    inline teascript::Parser &GetParser() noexcept { return mBuildTools->mParser; }
+#else
+    inline teascript::Parser &GetParser() noexcept { return mParser; }
+#endif
+    inline teascript::Context &GetContext() noexcept { return mContext; }
+};
+
+constexpr char tea_code_prepare[] = R"_SCRIPT_(
+const vi  := 42
+const vd  := 1.5
+const vs  := "a string argument of a typical length"
+const buf := _buf( 64 )
+)_SCRIPT_";
+
+double exec_tea( std::string const &code, teascript::ValueObject (*callback)( teascript::Context & ), long long const calls, bool const compiled )
+{
+    MyEngine  engine;
+    engine.AddConst( "calls", calls );
+    engine.RegisterUserCallback( "hostcall", callback );
+    try {
+        engine.ExecuteCode( tea_code_prepare );
+        teascript::ValueObject  teares;
+        double secs = 0.0;
+        if( compiled ) {
+#if TEASCRIPT_VERSION >= TEASCRIPT_BUILD_VERSION_NUMBER(0,14,0)
+            auto prog  = engine.CompileCode( code, teascript::eOptimize::O2 );
+            auto start = bench::Start();
+            teares     = engine.ExecuteProgram( prog );
+            auto end   = bench::Stop();
+            secs = bench::CalcTimeInSecs( start, end );
+#endif
+        } else {
+            auto ast   = engine.GetParser().Parse( code );
+            auto start = bench::Start();
+            teares     = ast->Eval( engine.GetContext() );
+            auto end   = bench::Stop();
+            secs = bench::CalcTimeInSecs( start, end );
+        }
+
+        bench::PrintValue( teares.GetAsInteger() );
+
+        return secs;
+
+    } catch( teascript::exception::runtime_error const &ex ) {
+        teascript::util::pretty_print( ex );
+    } catch( std::exception const &ex ) {
+        puts( ex.what() );
+    }
+
+    return -1.0;
+}
+#endif
+
+#if BENCH_ENABLE_CHAI
+template< eType T, bool Ret, size_t N >
+double exec_chai( std::string const &code, long long const calls )
+{
+    chaiscript::ChaiScript chai;
+    std::vector<unsigned char>  buf( buffer_size );
+    chai.add( chaiscript::bootstrap::standard_library::vector_type<std::vector<unsigned char>>( "Buffer" ) );
+    chai.add( chaiscript::fun( make_host_function<T, Ret>( std::make_index_sequence<N>{} ) ), "hostcall" );
+    chai.add( chaiscript::const_var( 42LL ), "vi" );
+    chai.add( chaiscript::const_var( 1.5 ), "vd" );
+    chai.add( chaiscript::const_var( std::string( string_arg ) ), "vs" );
+    chai.add( chaiscript::var( buf ), "buf" );
+    chai.add( chaiscript::const_var( static_cast<int>(calls) ), "calls" );
+    auto ast = chai.parse( code );
+    try {
+        auto start = bench::Start();
+        auto chres = chai.eval( *ast );
+        auto end   = bench::Stop();
+
+        bench::PrintValue( chaiscript::boxed_cast<int>(chres) );
+
+        return bench::CalcTimeInSecs( start, end );
+
+    } catch( chaiscript::Boxed_Value const &bv ) {
+        puts( chaiscript::boxed_cast<chaiscript::exception::eval_error const &>(bv).what() );
+    } catch( std::exception const &ex ) {
+        puts( ex.what() );
+    }
+
+    return -1.0;
+}
+#endif
+
+#if BENCH_ENABLE_JINX
+// the host function as Jinx library function, works with any count of arguments.
+template< eType T, bool Ret >
+Jinx::Variant jinx_hostcall( Jinx::ScriptPtr, Jinx::Parameters const &params )
+{
+    for( auto const &p : params ) {
+        if constexpr( T == eType::Int ) {
+            gSink += p.GetInteger();
+        } else if constexpr( T == eType::Double ) {
+            gSink += static_cast<long long>(p.GetNumber());
+        } else if constexpr( T == eType::String ) {
+            gSink += static_cast<long long>(p.GetString().size());
+        } else if constexpr( T == eType::Buffer ) {
+            gSink += static_cast<long long>(p.GetBuffer()->Size());
+        }
+    }
+    if constexpr( Ret ) {
+        if constexpr( T == eType::Int ) {
+            return Jinx::Variant( params[0].GetInteger() );
+        } else if constexpr( T == eType::Double ) {
+            return Jinx::Variant( params[0].GetNumber() );
+        } else if constexpr( T == eType::String ) {
+            return Jinx::Variant( params[0].GetString() );
+        } else if constexpr( T == eType::Buffer ) {
+            return Jinx::Variant( static_cast<int64_t>(params[0].GetBuffer()->Size()) );
+        } else {
+            return Jinx::Variant( static_cast<int64_t>(gSink) );
+        }
+    }
+    return {};
+}
+
+double exec_jinx( std::string const &code, int const args, Jinx::FunctionCallback const &callback, long long const calls )
+{
+    auto jinx = Jinx::CreateRuntime(); // Jinx::Initialize() is done once in BenchHostCall()
+    auto lib  = jinx->GetLibrary( "host" );
+    lib->RegisterFunction( Jinx::Visibility::Public, jinx_signature( args ).c_str(), callback );
+    lib->RegisterProperty( Jinx::Visibility::Public, Jinx::Access::ReadOnly, "calls", Jinx::Variant( static_cast<int64_t>(calls) ) );
+    lib->RegisterProperty( Jinx::Visibility::Public, Jinx::Access::ReadOnly, "buf", Jinx::Variant( Jinx::CreateBuffer() ) );
+    auto script = jinx->CreateScript( code.c_str() );
+    try {
+        if( !script ) {
+            throw std::runtime_error( "Jinx Error!" );
+        }
+        auto start = bench::Start();
+        do {
+            bool const res = script->Execute();
+            if( !res ) {
+                throw std::runtime_error( "Jinx Error!" );
+            }
+        } while( !script->IsFinished() );
+        auto end = bench::Stop();
+
+        bench::PrintValue( script->GetVariable( "res" ).GetInteger() );
+
+        return bench::CalcTimeInSecs( start, end );
+
+    } catch( std::exception const &ex ) {
+        puts( ex.what() );
+    }
+    return -1.0;
+}
+#endif
+
+#if BENCH_ENABLE_CPP
+template< typename F, typename A, size_t ...I >
+void call_with( F const f, A &arg, std::index_sequence<I...> )
+{
+    (void)f( ((void)I, arg)... );
+}
+
+// the reference: calling the host function via a (volatile) function pointer, so it cannot be inlined.
+template< eType T, bool Ret, size_t N >
+double exec_cpp( long long const calls )
+{
+    auto const  f  = make_host_function<T, Ret>( std::make_index_sequence<N>{} );
+    auto volatile fp = +f;
+
+    long long                   vi = 42;
+    double                      vd = 1.5;
+    std::string                 vs = string_arg;
+    std::vector<unsigned char>  buf( buffer_size );
+    auto &arg = [&]() -> auto & {
+        if constexpr( T == eType::Double ) {
+            return vd;
+        } else if constexpr( T == eType::String ) {
+            return vs;
+        } else if constexpr( T == eType::Buffer ) {
+            return buf;
+        } else {
+            return vi;
+        }
+    }();
+
+    try {
+        auto start = bench::Start();
+        for( long long i = 0; i < calls; ++i ) {
+            call_with( fp, arg, std::make_index_sequence<N>{} );
+        }
+        auto end = bench::Stop();
+
+        bench::PrintValue( calls );
+
+        return bench::CalcTimeInSecs( start, end );
+
+    } catch( std::exception const &ex ) {
+        puts( ex.what() );
+    }
+
+    return -1.0;
+}
+#endif
+
+
+// adds the tests of all engines for one shape, args < 0 is the empty loop.
+template< eType T, bool Ret, size_t N >
+void add_tests( bench::Suite &suite, [[maybe_unused]] int const args, [[maybe_unused]] long long const calls )
+{
+#if BENCH_ENABLE_CPP
+    if( args >= 0 ) {
+        suite.Add( "cpp", "C++ (function pointer)", [=] { return exec_cpp<T, Ret, N>( calls ); } );
+    }
+#endif
+#if BENCH_ENABLE_TEA
+    suite.Add( "tea", "TeaScript", [=, code = tea_script( args, T )] { return exec_tea( code, &tea_hostcall<T, Ret>, calls, false ); } );
+#if TEASCRIPT_VERSION >= TEASCRIPT_BUILD_VERSION_NUMBER(0,14,0)
+    suite.Add( "tea-vm", "TeaScript in TeaStackVM", [=, code = tea_script( args, T )] { return exec_tea( code, &tea_hostcall<T, Ret>, calls, true ); } );
+#endif
+#endif
+#if BENCH_ENABLE_CHAI
+    suite.Add( "chai", "ChaiScript", [=, code = chai_script( args, T )] { return exec_chai<T, Ret, N>( code, calls ); } );
+#endif
+#if BENCH_ENABLE_JINX
+    suite.Add( "jinx", "Jinx", [=, code = jinx_script( args, T )] { return exec_jinx( code, std::max( args, 0 ), &jinx_hostcall<T, Ret>, calls ); } );
+#endif
+}
+
+template< eType T, bool Ret >
+bool add_tests( bench::Suite &suite, int const args, long long const calls )
+{
+    switch( args ) {
+    case 1: add_tests<T, Ret, 1>( suite, args, calls ); return true;
+    case 3: add_tests<T, Ret, 3>( suite, args, calls ); return true;
+    case 6: add_tests<T, Ret, 6>( suite, args, calls ); return true;
+    default:
+        return false;
+    }
+}
+
+template< eType T >
+bool add_tests( bench::Suite &suite, int const args, bool const ret, long long const calls )
+{
+    return ret ? add_tests<T, true>( suite, args, calls ) : add_tests<T, false>( suite, args, calls );
+}
+
+
+// prints the matrix of ns per call (minus the empty loop) and allocations per call of the records [first, end).
+void print_matrix( size_t const first )
+{
+    auto const &records = bench::Records();
+    std::vector<std::string>  engines;
+    std::vector<std::string>  shapes;
+    for( auto i = first; i < records.size(); ++i ) {
+        auto const &r = records[i];
+        if( std::find( engines.begin(), engines.end(), r.engine ) == engines.end() ) {
+            engines.push_back( r.engine );
+        }
+        std::string shape;
+        for( auto const &[name, value] : r.params ) {
+            shape += (shape.empty() ? "" : " ") + value;
+        }
+        if( std::find( shapes.begin(), shapes.end(), shape ) == shapes.end() ) {
+            shapes.push_back( shape );
+        }
+    }
+    if( records.size() == first ) {
+        return;
+    }
+
+    auto const find = [&]( std::string const &shape, std::string const &engine ) -> bench::Record const * {
+        for( auto i = first; i < records.size(); ++i ) {
+            auto const &r = records[i];
+            std::string s;
+            for( auto const &[name, value] : r.params ) {
+                s += (s.empty() ? "" : " ") + value;
+            }
+            if( s == shape && r.engine == engine ) {
+                return &r;
+            }
+        }
+        return nullptr;
+    };
+
+    auto const flags = std::cout.flags();
+    auto const prec  = std::cout.precision();
+    std::cout << "\nns per call (median, minus the empty loop) [allocations per call]:\n";
+    std::cout << std::left << std::setw( 24 ) << "args type ret";
+    for( auto const &e : engines ) {
+        std::cout << std::setw( 20 ) << e;
+    }
+    std::cout << '\n' << std::fixed;
+    for( auto const &shape : shapes ) {
+        std::cout << std::setw( 24 ) << shape;
+        for( auto const &e : engines ) {
+            auto const *r    = find( shape, e );
+            auto const *loop = find( "loop", e );
+            std::string cell = "-";
+            if( r != nullptr && r->ops > 0.0 ) {
+                double ns = r->result.stats.median / r->ops * 1e9;
+                if( loop != nullptr && loop != r && loop->ops > 0.0 ) {
+                    ns -= loop->result.stats.median / loop->ops * 1e9;
+                }
+                std::ostringstream  os;
+                os << std::fixed << std::setprecision( 1 ) << ns;
+                for( auto const &[name, value] : r->result.metrics ) {
+                    if( name == "allocs" ) {
+                        os << " [" << std::setprecision( 2 ) << value / r->ops << ']';
+                    }
+                }
+                cell = os.str();
+            }
+            std::cout << std::setw( 20 ) << cell;
+        }
+        std::cout << '\n';
+    }
+    std::cout << std::flush;
+    std::cout.flags( flags );
+    std::cout.precision( prec );
+}
+
+} // namespace
+
+
+void PrintUsageHostCall()
+{
+    std::cout << "HostCall options:\n"
+                 "  --calls=N                    count of calls of the host function per run (default: " << BENCH_CALLS << ")\n"
+                 "  --args=N,...                 count(s) of arguments, 0, 1, 3 or 6 (default: " BENCH_ARGS ")\n"
+                 "  --type=int,double,string,buffer  type(s) of the arguments (default: " BENCH_TYPES ")\n"
+                 "  --ret=void,value             the host function returns void or a value (default: " BENCH_RETS ")\n"
+                 "use --alloc for the allocations per call.\n"
+                 "engines: cpp (function pointer), tea, tea-vm, chai, jinx\n";
+}
+
+int BenchHostCall( bench::CmdLine const &cmd )
+{
+    if( cmd.Has( "help" ) ) {
+        PrintUsageHostCall();
+        return EXIT_SUCCESS;
+    }
+
+    bench::ApplyConfig( cmd );
+    bench::SetEngineVersion( "cpp", bench::CompilerVersion() );
+#if BENCH_ENABLE_JINX
+    bench::SetEngineVersion( "jinx", bench::VersionString( Jinx::MajorVersion, Jinx::MinorVersion, Jinx::PatchNumber ) );
+    Jinx::GlobalParams  params;
+    params.errorOnMaxInstrunctions = false;
+    Jinx::Initialize( params );
+#endif
+#if BENCH_ENABLE_TEA
+    bench::SetEngineVersion( "tea", bench::VersionString( TEASCRIPT_VERSION_MAJOR, TEASCRIPT_VERSION_MINOR, TEASCRIPT_VERSION_PATCH ) );
+#endif
+#if BENCH_ENABLE_CHAI
+    bench::SetEngineVersion( "chai", chaiscript::Build_Info::version() );
+#endif
+
+    auto const calls = cmd.GetInt( "calls", BENCH_CALLS );
+    auto const args  = cmd.GetIntList( "args", [] {
+        std::vector<long long> v;
+        for( auto const &s : bench::CmdLine::Split( BENCH_ARGS ) ) {
+            v.push_back( std::atoll( s.c_str() ) );
+        }
+        return v;
+    }() );
+    auto const types = cmd.GetList( "type", bench::CmdLine::Split( BENCH_TYPES ) );
+    auto const rets  = cmd.GetList( "ret", bench::CmdLine::Split( BENCH_RETS ) );
+    if( calls < 1 ) {
+        std::cout << "Wrong parameter: calls must be >= 1." << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::cout << "Benchmarking the host function call overhead of TeaScript, ChaiScript and Jinx ...\n";
+    std::cout << "... and C++ as a reference ... \n";
+
+    auto const first = bench::Records().size();
+    int failed = 0;
+    {
+        bench::Suite  suite( cmd, "hostcall", { { "args", "loop" } } );
+        suite.SetOps( static_cast<double>(calls), "iteration" );
+        add_tests<eType::None, false, 0>( suite, -1, calls );
+        failed += suite.Run();
+    }
+    for( auto const arg_count : args ) {
+        for( auto const &ret : rets ) {
+            if( ret != "void" && ret != "value" ) {
+                std::cout << "Unknown ret: " << ret << std::endl;
+                return EXIT_FAILURE;
+            }
+            bool const returns = ret == "value";
+            if( arg_count == 0 ) {
+                bench::Suite  suite( cmd, "hostcall", { { "args", "0" }, { "type", "none" }, { "ret", ret } } );
+                suite.SetOps( static_cast<double>(calls), "call" );
+                if( returns ) {
+                    add_tests<eType::None, true, 0>( suite, 0, calls );
+                } else {
+                    add_tests<eType::None, false, 0>( suite, 0, calls );
+                }
+                failed += suite.Run();
+                continue;
+            }
+            for( auto const &type : types ) {
+                bench::Suite  suite( cmd, "hostcall", { { "args", std::to_string( arg_count ) }, { "type", type }, { "ret", ret } } );
+                suite.SetOps( static_cast<double>(calls), "call" );
+                auto const n = static_cast<int>(arg_count);
+                bool ok = false;
+                if( type == "int" ) {
+                    ok = add_tests<eType::Int>( suite, n, returns, calls );
+                } else if( type == "double" ) {
+                    ok = add_tests<eType::Double>( suite, n, returns, calls );
+                } else if( type == "string" ) {
+                    ok = add_tests<eType::String>( suite, n, returns, calls );
+                } else if( type == "buffer" ) {
+                    ok = add_tests<eType::Buffer>( suite, n, returns, calls );
+                } else {
+                    std::cout << "Unknown type: " << type << std::endl;
+                    return EXIT_FAILURE;
+                }
+                if( !ok ) {
+                    std::cout << "Unsupported count of arguments: " << arg_count << " (use 0, 1, 3 or 6)" << std::endl;
+                    return EXIT_FAILURE;
+                }
+                failed += suite.Run();
+            }
+        }
+    }
+
+    print_matrix( first );
+
+    return failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+#if !defined BENCH_DRIVER
+int main( int argc, char *argv[] )
+{
+    bench::GetConfig() = { .warmup_runs = BENCH_WARMUP_RUNS, .min_runs = BENCH_MIN_RUNS, .max_runs = BENCH_MAX_RUNS,
+                           .target_rel_error = BENCH_TARGET_REL_ERROR };
+
+    return bench::Main( argc, argv, &BenchHostCall );
+}
+#endif
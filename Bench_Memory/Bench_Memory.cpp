@@ -0,0 +1,583 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (C) 2024 Florian Thake, <contact |at| tea-age.solutions>.
+ * SPDX-License-Identifier: MIT
+ */
+
+// Benchmarking the memory footprint of TeaScript VS ChaiScript VS Jinx.
+//
+// For capacity planning with many engine instances per process: N instances of an object are created and kept alive,
+// the retained heap bytes (via bench::HeapScope, independent of --alloc) and the growth of the resident set size are
+// reported per instance. The objects are
+//   engine - an empty bootstrapped engine,
+//   vars   - the variables of a TeaScript Context like in Bench_VariableLookup (scopes x vars) and the equivalent in
+//            ChaiScript and Jinx, reported as bytes per variable (without the empty engine),
+//   script - the recursive Fibonacci script as parsed AST or compiled TeaStackVM program, reported as bytes per AST node
+//            (per instruction for the program).
+// The measured time is the time for creating the N instances.
+// NOTE: The resident set size only grows if the allocator needs new pages, so it is most meaningful for the first run (--warmup=0).
+
+// === BENCH CONFIG ===
+
+#define BENCH_ENABLE_CHAI  1                    // 1 == Enable ChaiScript, 0 == Disable
+#define BENCH_ENABLE_JINX  1                    // 1 == Enable Jinx, 0 == Disable
+#define BENCH_ENABLE_TEA   1                    // 1 == Enable TeaScript, 0 == Disable
+
+#define BENCH_WARMUP_RUNS      1                // runs of each test before measuring (not part of the statistic).
+#define BENCH_MIN_RUNS         3                // minimum count of measured runs for each test.
+#define BENCH_MAX_RUNS         10               // maximum count of measured runs for each test.
+#define BENCH_TARGET_REL_ERROR 0.05             // repeat until the 95% confidence interval of the mean is within +-5% (or BENCH_MAX_RUNS is reached).
+
+#define BENCH_INSTANCES        100              // default for --instances, count of instances of the engines and scripts.
+#define BENCH_CONTEXTS         10               // default for --contexts, count of instances with variables.
+#define BENCH_SCOPES           10               // default for --scopes (like in Bench_VariableLookup)
+#define BENCH_VARS_PER_SCOPE   1000             // default for --vars (like in Bench_VariableLookup)
+
+// NOTE: all tests of the enabled languages are compiled in. Which are run and with which parameters can be selected
+//       via command line, e.g. --object=engine,vars --instances=500 --engine=tea,chai (see --help)
+
+
+// handle some annoying compile errors on MSVC
+#if defined _MSC_VER  && !defined _SILENCE_CXX17_CODECVT_HEADER_DEPRECATION_WARNING
+# define _SILENCE_CXX17_CODECVT_HEADER_DEPRECATION_WARNING
+#endif
+#if defined _MSC_VER  && !defined _SILENCE_CXX20_U8PATH_DEPRECATION_WARNING
+# define _SILENCE_CXX20_U8PATH_DEPRECATION_WARNING
+#endif
+#if defined _MSC_VER  && !defined _CRT_SECURE_NO_WARNINGS
+# define _CRT_SECURE_NO_WARNINGS
+#endif
+
+//for VS use /Zc:__cplusplus
+#if __cplusplus < 202002L
+# if defined _MSVC_LANG // fallback without /Zc:__cplusplus
+#  if !_HAS_CXX20
+#   error must use at least C++20
+#  endif
+# else
+#  error must use at least C++20
+# endif
+#endif
+
+
+#include <cstdlib> // EXIT_SUCCESS
+#include <cstdio>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "../Common/BenchCore.hpp"
+#include "../Common/BenchCmdLine.hpp"
+#if !defined BENCH_DRIVER
+# define BENCH_ALLOC_IMPLEMENTATION // this is the main translation unit
+#endif
+#include "../Common/BenchMain.hpp"
+
+#if BENCH_ENABLE_JINX
+#include <Jinx.hpp>
+#endif
+#if BENCH_ENABLE_TEA
+#include <teascript/Engine.hpp>
+// check for compile and run in TeaStackVM feature
+#if TEASCRIPT_VERSION >= TEASCRIPT_BUILD_VERSION_NUMBER(0,14,0)
+#include <teascript/StackVMCompiler.hpp>
+#endif
+#endif
+#if BENCH_ENABLE_CHAI
+#if defined(_WIN32)
+#  define NOMINMAX
+#  define WIN32_LEAN_AND_MEAN
+# endif
+# if defined( _MSC_VER )
+#  pragma warning( push )
+#  pragma warning( disable: 4244 )
+# endif
+#include <chaiscript/chaiscript.hpp>
+# if defined( _MSC_VER )
+#  pragma warning( pop )
+# endif
+#endif
+
+
+namespace {
+
+// the recursive fibonacci scripts of Bench_Fibonacci (only parsed here).
+constexpr char tea_code[] = R"_SCRIPT_(
+func fib( x ) {
+    if( x == 1 or x == 0 ) {
+       x
+    } else {
+       fib( x - 1 ) + fib( x - 2 )
+    }
+}
+
+fib( fib_num )
+)_SCRIPT_";
+
+constexpr char chai_code[] = R"_SCRIPT_(
+def fib( x )
+{
+    if( x == 0 || x == 1 ) {
+        return x;
+    } else {
+        return fib( x - 1 ) + fib( x - 2 );
+    }
+}
+
+fib( fib_num );
+)_SCRIPT_";
+
+constexpr char jinx_code[] = R"_SCRIPT_(
+import core
+
+function fib {x}
+    if x < 2
+        return x
+    end
+    return fib (x - 1) + fib (x - 2)
+end
+
+set res to fib fib_num
+)_SCRIPT_";
+
+
+struct VarLayout
+{
+    int  scopes         = BENCH_SCOPES;
+    int  vars_per_scope = BENCH_VARS_PER_SCOPE;
+};
+
+#if BENCH_ENABLE_TEA || BENCH_ENABLE_CHAI || BENCH_ENABLE_JINX
+std::string make_name( int s, int v )
+{
+    return "var_" + std::to_string( s ) + "_" + std::to_string( v );
+}
+#endif
+
+// counts the nodes of an AST, 0 if the nodes cannot be iterated (depends on the version of the script engine).
+template< typename Node >
+double count_nodes( Node const &node )
+{
+    if constexpr( requires( Node const &n ) { n.get_children(); } ) {         // ChaiScript
+        double count = 1.0;
+        for( auto const &child : node.get_children() ) {
+            count += count_nodes( child.get() );
+        }
+        return count;
+    } else if constexpr( requires( Node const &n ) { n.begin(); n.end(); } ) { // TeaScript
+        double count = 1.0;
+        for( auto it = node.begin(); it != node.end(); ++it ) {
+            count += count_nodes( **it );
+        }
+        return count;
+    } else {
+        return 0.0;
+    }
+}
+
+// counts the instructions of a compiled program, 0 if not possible (depends on the version of the script engine).
+template< typename ProgPtr >
+double count_instructions( ProgPtr const &prog )
+{
+    if constexpr( requires( ProgPtr const &p ) { p->GetInstructions().size(); } ) {
+        return static_cast<double>(prog->GetInstructions().size());
+    } else {
+        return 0.0;
+    }
+}
+
+
+// creates the instances: prepare() is not measured (e.g. the empty engine for the variables), fill() is measured.
+// the retained heap bytes, allocations and the growth of the resident set of all instances are added as metrics,
+// units() returns the count of units of one instance (e.g. variables) for the bytes per unit (0 if not applicable).
+template< typename Prepare, typename Fill, typename Units >
+double measure_instances( long long const instances, Prepare &&prepare, Fill &&fill, std::string const &unit, Units &&units )
+{
+    std::vector<decltype(prepare())>  objects;
+    objects.reserve( static_cast<size_t>(instances) );
+    for( long long i = 0; i < instances; ++i ) {
+        objects.push_back( prepare() );
+    }
+
+    auto const       rss_before = bench::ResidentBytes();
+    bench::HeapScope heap;
+    auto start = bench::Start();
+    for( auto &obj : objects ) {
+        fill( obj );
+    }
+    auto end = bench::Stop();
+    auto const live   = static_cast<double>(heap.LiveBytes());
+    auto const allocs = static_cast<double>(heap.Allocs());
+    auto const rss    = static_cast<double>(bench::ResidentBytes()) - static_cast<double>(rss_before);
+
+    bench::PrintValue( objects.size() );
+
+    bench::AddMetric( "heap-bytes", live );
+    bench::AddMetric( "heap-allocs", allocs );
+    bench::AddMetric( "rss-bytes", rss );
+    double const n = objects.empty() ? 0.0 : units( objects.front() );
+    if( n > 0.0 ) {
+        bench::AddMetric( "heap-bytes-per-" + unit, live / (n * static_cast<double>(instances)) );
+    }
+
+    return bench::CalcTimeInSecs( start, end );
+}
+
+constexpr auto no_units = []( auto const & ) { return 0.0; };
+
+
+#if BENCH_ENABLE_TEA
+double exec_tea_engine( long long const instances )
+{
+    try {
+        return measure_instances( instances, [] { return std::unique_ptr<teascript::Engine>(); },
+                                  []( auto &obj ) { obj = std::make_unique<teascript::Engine>(); }, "", no_units );
+    } catch( teascript::exception::runtime_error const &ex ) {
+        teascript::util::pretty_print( ex );
+    } catch( std::exception const &ex ) {
+        puts( ex.what() );
+    }
+    return -1.0;
+}
+
+// only the Context with the bootstrapped CoreLibrary (core level, without the Engine around).
+double exec_tea_context( long long const instances )
+{
+    try {
+        return measure_instances( instances, [] { return std::unique_ptr<teascript::Context>(); },
+                                  []( auto &obj ) {
+                                      obj = std::make_unique<teascript::Context>();
+                                      teascript::CoreLibrary().Bootstrap( *obj, teascript::config::core() );
+                                  }, "", no_units );
+    } catch( teascript::exception::runtime_error const &ex ) {
+        teascript::util::pretty_print( ex );
+    } catch( std::exception const &ex ) {
+        puts( ex.what() );
+    }
+    return -1.0;
+}
+
+// the variables like setup() of Bench_VariableLookup.
+double exec_tea_vars( long long const instances, VarLayout const &l )
+{
+    try {
+        return measure_instances( instances, [] { return std::make_unique<teascript::Context>( teascript::TypeSystem() ); },
+                                  [&l]( auto &c ) {
+                                      for( int scope = 0; scope < l.scopes; ++scope ) {
+                                          for( int var_idx = 0; var_idx < l.vars_per_scope; ++var_idx ) {
+                                              c->AddValueObject( make_name( scope, var_idx ), teascript::ValueObject( static_cast<long long>(scope) * var_idx, true ) );
+                                          }
+                                          c->EnterScope();
+                                      }
+                                      c->ExitScope(); // one too much.
+                                  }, "var", [&l]( auto const & ) { return static_cast<double>(l.scopes) * l.vars_per_scope; } );
+    } catch( teascript::exception::runtime_error const &ex ) {
+        teascript::util::pretty_print( ex );
+    } catch( std::exception const &ex ) {
+        puts( ex.what() );
+    }
+    return -1.0;
+}
+
+double exec_tea_ast( long long const instances )
+{
+    teascript::Parser  p;
+    try {
+        return measure_instances( instances, [] { return teascript::ASTNodePtr(); },
+                                  [&p]( auto &ast ) { ast = p.Parse( tea_code ); },
+                                  "node", []( auto const &ast ) { return count_nodes( *ast ); } );
+    } catch( teascript::exception::runtime_error const &ex ) {
+        teascript::util::pretty_print( ex );
+    } catch( std::exception const &ex ) {
+        puts( ex.what() );
+    }
+    return -1.0;
+}
+
+#if TEASCRIPT_VERSION >= TEASCRIPT_BUILD_VERSION_NUMBER(0,14,0)
+// only the program is retained, the AST is freed after compiling.
+double exec_tea_program( long long const instances )
+{
+    teascript::Parser  p;
+    teascript::StackVM::Compiler  compiler;
+    try {
+        return measure_instances( instances, [] { return teascript::StackVM::ProgramPtr(); },
+                                  [&]( auto &prog ) { prog = compiler.Compile( p.Parse( tea_code ), teascript::eOptimize::O2 ); },
+                                  "instruction", []( auto const &prog ) { return count_instructions( prog ); } );
+    } catch( teascript::exception::runtime_error const &ex ) {
+        teascript::util::pretty_print( ex );
+    } catch( std::exception const &ex ) {
+        puts( ex.what() );
+    }
+    return -1.0;
+}
+#endif
+#endif
+
+#if BENCH_ENABLE_CHAI
+double exec_chai_engine( long long const instances )
+{
+    try {
+        return measure_instances( instances, [] { return std::unique_ptr<chaiscript::ChaiScript>(); },
+                                  []( auto &obj ) { obj = std::make_unique<chaiscript::ChaiScript>(); }, "", no_units );
+    } catch( std::exception const &ex ) {
+        puts( ex.what() );
+    }
+    return -1.0;
+}
+
+// ChaiScript has no scopes from C++, all variables are added to the current scope.
+double exec_chai_vars( long long const instances, VarLayout const &l )
+{
+    try {
+        return measure_instances( instances, [] { return std::make_unique<chaiscript::ChaiScript>(); },
+                                  [&l]( auto &chai ) {
+                                      for( int scope = 0; scope < l.scopes; ++scope ) {
+                                          for( int var_idx = 0; var_idx < l.vars_per_scope; ++var_idx ) {
+                                              chai->add( chaiscript::var( static_cast<long long>(scope) * var_idx ), make_name( scope, var_idx ) );
+                                          }
+                                      }
+                                  }, "var", [&l]( auto const & ) { return static_cast<double>(l.scopes) * l.vars_per_scope; } );
+    } catch( std::exception const &ex ) {
+        puts( ex.what() );
+    }
+    return -1.0;
+}
+
+double exec_chai_ast( long long const instances )
+{
+    chaiscript::ChaiScript  chai;
+    try {
+        return measure_instances( instances, [] { return decltype(chai.parse( chai_code ))(); },
+                                  [&chai]( auto &ast ) { ast = chai.parse( chai_code ); },
+                                  "node", []( auto const &ast ) { return count_nodes( *ast ); } );
+    } catch( chaiscript::Boxed_Value const &bv ) {
+        puts( chaiscript::boxed_cast<chaiscript::exception::eval_error const &>(bv).what() );
+    } catch( std::exception const &ex ) {
+        puts( ex.what() );
+    }
+    return -1.0;
+}
+#endif
+
+#if BENCH_ENABLE_JINX
+double exec_jinx_engine( long long const instances )
+{
+    try {
+        return measure_instances( instances, [] { return Jinx::RuntimePtr(); },
+                                  []( auto &obj ) { obj = Jinx::CreateRuntime(); }, "", no_units );
+    } catch( std::exception const &ex ) {
+        puts( ex.what() );
+    }
+    return -1.0;
+}
+
+// the variables as properties of a library.
+double exec_jinx_vars( long long const instances, VarLayout const &l )
+{
+    try {
+        return measure_instances( instances, [] { return Jinx::CreateRuntime(); },
+                                  [&l]( auto &jinx ) {
+                                      auto lib = jinx->GetLibrary( "vars" );
+                                      for( int scope = 0; scope < l.scopes; ++scope ) {
+                                          for( int var_idx = 0; var_idx < l.vars_per_scope; ++var_idx ) {
+                                              lib->RegisterProperty( Jinx::Visibility::Public, Jinx::Access::ReadWrite, make_name( scope, var_idx ).c_str(),
+                                                                     Jinx::Variant( static_cast<int64_t>(scope) * var_idx ) );
+                                          }
+                                      }
+                                  }, "var", [&l]( auto const & ) { return static_cast<double>(l.scopes) * l.vars_per_scope; } );
+    } catch( std::exception const &ex ) {
+        puts( ex.what() );
+    }
+    return -1.0;
+}
+
+double exec_jinx_script( long long const instances )
+{
+    auto jinx = Jinx::CreateRuntime(); // Jinx::Initialize() is done once in BenchMemory()
+    jinx->GetLibrary( "core" )->RegisterProperty( Jinx::Visibility::Public, Jinx::Access::ReadOnly, "fib_num", Jinx::Variant( static_cast<int64_t>(25) ) );
+    try {
+        return measure_instances( instances, [] { return Jinx::ScriptPtr(); },
+                                  [&jinx]( auto &script ) {
+                                      script = jinx->CreateScript( jinx_code );
+                                      if( !script ) {
+                                          throw std::runtime_error( "Jinx Error!" );
+                                      }
+                                  }, "", no_units );
+    } catch( std::exception const &ex ) {
+        puts( ex.what() );
+    }
+    return -1.0;
+}
+#endif
+
+
+// prints the memory per instance (and per unit) of the records [first, end).
+void print_summary( size_t const first )
+{
+    auto const &records = bench::Records();
+    if( records.size() == first ) {
+        return;
+    }
+    auto const flags = std::cout.flags();
+    auto const prec  = std::cout.precision();
+    std::cout << "\nmemory per instance (mean of the runs):\n";
+    std::cout << std::left << std::setw( 8 ) << "object" << std::setw( 36 ) << "test" << std::right << std::setw( 14 ) << "heap bytes"
+              << std::setw( 10 ) << "allocs" << std::setw( 14 ) << "rss bytes" << "  heap bytes per unit\n";
+    std::cout << std::fixed << std::setprecision( 0 );
+    for( auto i = first; i < records.size(); ++i ) {
+        auto const &r = records[i];
+        if( r.ops <= 0.0 ) {
+            continue;
+        }
+        std::string object;
+        for( auto const &[name, value] : r.params ) {
+            if( name == "object" ) {
+                object = value;
+            }
+        }
+        double heap = 0.0, allocs = 0.0, rss = 0.0;
+        std::string per_unit = "-";
+        for( auto const &[name, value] : r.result.metrics ) {
+            if( name == "heap-bytes" ) {
+                heap = value;
+            } else if( name == "heap-allocs" ) {
+                allocs = value;
+            } else if( name == "rss-bytes" ) {
+                rss = value;
+            } else if( name.starts_with( "heap-bytes-per-" ) ) {
+                std::ostringstream  os;
+                os << std::fixed << std::setprecision( 1 ) << value << " / " << name.substr( 15 );
+                per_unit = os.str();
+            }
+        }
+        std::cout << std::left << std::setw( 8 ) << object << std::setw( 36 ) << r.title << std::right << std::setw( 14 ) << heap / r.ops
+                  << std::setw( 10 ) << allocs / r.ops << std::setw( 14 ) << rss / r.ops << "  " << per_unit << '\n';
+    }
+    std::cout << std::flush;
+    std::cout.flags( flags );
+    std::cout.precision( prec );
+}
+
+} // namespace
+
+
+void PrintUsageMemory()
+{
+    std::cout << "Memory options:\n"
+                 "  --object=engine,vars,script  object(s) to measure (default: all)\n"
+                 "  --instances=N                count of instances of the engines and scripts (default: " << BENCH_INSTANCES << ")\n"
+                 "  --contexts=N                 count of instances with variables (default: " << BENCH_CONTEXTS << ")\n"
+                 "  --scopes=N                   count of scopes with variables (default: " << BENCH_SCOPES << ")\n"
+                 "  --vars=N                     count of variables per scope (default: " << BENCH_VARS_PER_SCOPE << ")\n"
+                 "engines: tea, tea-context (engine only), tea-vm (script only), chai, jinx\n";
+}
+
+int BenchMemory( bench::CmdLine const &cmd )
+{
+    if( cmd.Has( "help" ) ) {
+        PrintUsageMemory();
+        return EXIT_SUCCESS;
+    }
+
+    bench::ApplyConfig( cmd );
+#if BENCH_ENABLE_JINX
+    bench::SetEngineVersion( "jinx", bench::VersionString( Jinx::MajorVersion, Jinx::MinorVersion, Jinx::PatchNumber ) );
+    Jinx::GlobalParams  params;
+    params.errorOnMaxInstrunctions = false;
+    Jinx::Initialize( params );
+#endif
+#if BENCH_ENABLE_TEA
+    bench::SetEngineVersion( "tea", bench::VersionString( TEASCRIPT_VERSION_MAJOR, TEASCRIPT_VERSION_MINOR, TEASCRIPT_VERSION_PATCH ) );
+#endif
+#if BENCH_ENABLE_CHAI
+    bench::SetEngineVersion( "chai", chaiscript::Build_Info::version() );
+#endif
+
+    if( !bench::HeapScope::Available() ) {
+        std::cout << "NOTE: allocation hooks are not built in (BENCH_ALLOC_HOOKS), the heap bytes are not available." << std::endl;
+    }
+
+    auto const objects   = cmd.GetList( "object", { "engine", "vars", "script" } );
+    auto const instances = cmd.GetInt( "instances", BENCH_INSTANCES );
+    auto const contexts  = cmd.GetInt( "contexts", BENCH_CONTEXTS );
+    VarLayout  l;
+    l.scopes         = static_cast<int>(cmd.GetInt( "scopes", BENCH_SCOPES ));
+    l.vars_per_scope = static_cast<int>(cmd.GetInt( "vars", BENCH_VARS_PER_SCOPE ));
+    if( instances < 1 || contexts < 1 || l.scopes < 1 || l.vars_per_scope < 1 ) {
+        std::cout << "Wrong parameters: instances, contexts, scopes and vars must be >= 1." << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::cout << "Benchmarking the memory footprint of TeaScript, ChaiScript and Jinx.\n";
+
+    auto const first = bench::Records().size();
+    int failed = 0;
+    for( auto const &object : objects ) {
+        if( object == "engine" ) {
+            bench::Suite  suite( cmd, "memory", { { "object", object }, { "instances", std::to_string( instances ) } } );
+            suite.SetOps( static_cast<double>(instances), "instance" );
+#if BENCH_ENABLE_TEA
+            suite.Add( "tea", "TeaScript Engine", [=] { return exec_tea_engine( instances ); } );
+            suite.Add( "tea-context", "TeaScript Context + CoreLibrary (core)", [=] { return exec_tea_context( instances ); } );
+#endif
+#if BENCH_ENABLE_CHAI
+            suite.Add( "chai", "ChaiScript", [=] { return exec_chai_engine( instances ); } );
+#endif
+#if BENCH_ENABLE_JINX
+            suite.Add( "jinx", "Jinx Runtime", [=] { return exec_jinx_engine( instances ); } );
+#endif
+            failed += suite.Run();
+        } else if( object == "vars" ) {
+            bench::Suite  suite( cmd, "memory", { { "object", object }, { "instances", std::to_string( contexts ) },
+                                                  { "scopes", std::to_string( l.scopes ) }, { "vars", std::to_string( l.vars_per_scope ) } } );
+            suite.SetOps( static_cast<double>(contexts), "instance" );
+#if BENCH_ENABLE_TEA
+            suite.Add( "tea", "TeaScript Context variables", [=] { return exec_tea_vars( contexts, l ); } );
+#endif
+#if BENCH_ENABLE_CHAI
+            suite.Add( "chai", "ChaiScript variables", [=] { return exec_chai_vars( contexts, l ); } );
+#endif
+#if BENCH_ENABLE_JINX
+            suite.Add( "jinx", "Jinx library properties", [=] { return exec_jinx_vars( contexts, l ); } );
+#endif
+            failed += suite.Run();
+        } else if( object == "script" ) {
+            bench::Suite  suite( cmd, "memory", { { "object", object }, { "instances", std::to_string( instances ) } } );
+            suite.SetOps( static_cast<double>(instances), "instance" );
+#if BENCH_ENABLE_TEA
+            suite.Add( "tea", "TeaScript AST", [=] { return exec_tea_ast( instances ); } );
+#if TEASCRIPT_VERSION >= TEASCRIPT_BUILD_VERSION_NUMBER(0,14,0)
+            suite.Add( "tea-vm", "TeaScript TeaStackVM program (O2)", [=] { return exec_tea_program( instances ); } );
+#endif
+#endif
+#if BENCH_ENABLE_CHAI
+            suite.Add( "chai", "ChaiScript AST", [=] { return exec_chai_ast( instances ); } );
+#endif
+#if BENCH_ENABLE_JINX
+            suite.Add( "jinx", "Jinx Script", [=] { return exec_jinx_script( instances ); } );
+#endif
+            failed += suite.Run();
+        } else {
+            std::cout << "Unknown object: " << object << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    print_summary( first );
+
+    return failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+#if !defined BENCH_DRIVER
+int main( int argc, char *argv[] )
+{
+    bench::GetConfig() = { .warmup_runs = BENCH_WARMUP_RUNS, .min_runs = BENCH_MIN_RUNS, .max_runs = BENCH_MAX_RUNS,
+                           .target_rel_error = BENCH_TARGET_REL_ERROR };
+
+    return bench::Main( argc, argv, &BenchMemory );
+}
+#endif
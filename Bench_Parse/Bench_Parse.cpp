@@ -0,0 +1,392 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (C) 2024 Florian Thake, <contact |at| tea-age.solutions>.
+ * SPDX-License-Identifier: MIT
+ */
+
+// Benchmarking the parse and compile throughput of TeaScript VS ChaiScript VS Jinx.
+//
+// All other benchmarks exclude parsing from the measurement. Here synthetic scripts of scalable size are generated
+// in each dialect (count of functions, nesting depth of the if/else blocks and length of the expressions)
+// and only the parsing (and compiling for the TeaStackVM with each optimization level) is measured.
+// The results are reported as time per line, lines/s and MB/s, and how the time scales with the script size.
+
+// === BENCH CONFIG ===
+
+#define BENCH_ENABLE_CHAI  1                    // 1 == Enable ChaiScript, 0 == Disable
+#define BENCH_ENABLE_JINX  1                    // 1 == Enable Jinx, 0 == Disable
+#define BENCH_ENABLE_TEA   1                    // 1 == Enable TeaScript, 0 == Disable
+
+#define BENCH_WARMUP_RUNS      1                // runs of each test before measuring (not part of the statistic).
+#define BENCH_MIN_RUNS         5                // minimum count of measured runs for each test.
+#define BENCH_MAX_RUNS         30               // maximum count of measured runs for each test.
+#define BENCH_TARGET_REL_ERROR 0.02             // repeat until the 95% confidence interval of the mean is within +-2% (or BENCH_MAX_RUNS is reached).
+
+#define BENCH_FUNCS        "10,100,1000"        // default for --funcs, count(s) of functions of the generated scripts.
+#define BENCH_DEPTH        3                    // default for --depth, nesting depth of the if/else blocks in each function.
+#define BENCH_EXPR         8                    // default for --expr, count of operands of the expression in each function.
+
+// NOTE: all tests of the enabled languages are compiled in. Which are run and with which parameters can be selected
+//       via command line, e.g. --funcs=100,1000 --depth=5 --engine=tea,chai (see --help)
+
+
+// handle some annoying compile errors on MSVC
+#if defined _MSC_VER  && !defined _SILENCE_CXX17_CODECVT_HEADER_DEPRECATION_WARNING
+# define _SILENCE_CXX17_CODECVT_HEADER_DEPRECATION_WARNING
+#endif
+#if defined _MSC_VER  && !defined _SILENCE_CXX20_U8PATH_DEPRECATION_WARNING
+# define _SILENCE_CXX20_U8PATH_DEPRECATION_WARNING
+#endif
+#if defined _MSC_VER  && !defined _CRT_SECURE_NO_WARNINGS
+# define _CRT_SECURE_NO_WARNINGS
+#endif
+
+//for VS use /Zc:__cplusplus
+#if __cplusplus < 202002L
+# if defined _MSVC_LANG // fallback without /Zc:__cplusplus
+#  if !_HAS_CXX20
+#   error must use at least C++20
+#  endif
+# else
+#  error must use at least C++20
+# endif
+#endif
+
+
+#include <algorithm>
+#include <cstdlib> // EXIT_SUCCESS
+#include <cstdio>
+#include <iostream>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "../Common/BenchCore.hpp"
+#include "../Common/BenchCmdLine.hpp"
+#include "../Common/BenchFit.hpp"
+#if !defined BENCH_DRIVER
+# define BENCH_ALLOC_IMPLEMENTATION // this is the main translation unit
+#endif
+#include "../Common/BenchMain.hpp"
+
+#if BENCH_ENABLE_JINX
+#include <Jinx.hpp>
+#endif
+#if BENCH_ENABLE_TEA
+#include <teascript/Parser.hpp>
+// check for compile and run in TeaStackVM feature
+#if TEASCRIPT_VERSION >= TEASCRIPT_BUILD_VERSION_NUMBER(0,14,0)
+#include <teascript/StackVMCompiler.hpp>
+#endif
+#endif
+#if BENCH_ENABLE_CHAI
+#if defined(_WIN32)
+#  define NOMINMAX
+#  define WIN32_LEAN_AND_MEAN
+# endif
+# if defined( _MSC_VER )
+#  pragma warning( push )
+#  pragma warning( disable: 4244 )
+# endif
+#include <chaiscript/chaiscript.hpp>
+# if defined( _MSC_VER )
+#  pragma warning( pop )
+# endif
+#endif
+
+
+namespace {
+
+struct ScriptLayout
+{
+    int  funcs = 0;   // count of functions
+    int  depth = 0;   // nesting depth of if/else blocks in each function
+    int  expr  = 0;   // count of operands of the expression in each function
+};
+
+// the syntax elements of one dialect.
+struct Dialect
+{
+    char const *func_begin;  // followed by the function number
+    char const *func_params;
+    char const *func_end;
+    char const *if_begin;    // followed by the condition
+    char const *if_cond_end;
+    char const *else_;
+    char const *if_end;
+    char const *assign;      // followed by the expression
+    char const *stmt_end;
+    char const *ret;         // followed by the value
+};
+
+constexpr Dialect tea_dialect  = { "func f", "( a, b ) {", "}", "if( ", " ) {", "} else {", "}", "def x := ", "", "" };
+constexpr Dialect chai_dialect = { "def f", "( a, b ) {", "}", "if( ", " ) {", "} else {", "}", "var x = ", ";", "return " };
+constexpr Dialect jinx_dialect = { "function f", " {a} plus {b}", "end", "if ", "", "else", "end", "set x to ", "", "return " };
+
+// generates a synthetic script with the given layout in the given dialect.
+std::string generate_script( Dialect const &d, ScriptLayout const &l )
+{
+    static char const *const ops[] = { " + ", " - ", " * " };
+    std::string res;
+    for( int f = 0; f < l.funcs; ++f ) {
+        res += d.func_begin + std::to_string( f ) + d.func_params + '\n';
+        std::string indent = "    ";
+        for( int i = 0; i < l.depth; ++i ) {
+            res += indent + d.if_begin + "a > b + " + std::to_string( i ) + d.if_cond_end + '\n';
+            indent += "    ";
+        }
+        std::string expr = "a";
+        for( int i = 1; i < l.expr; ++i ) {
+            expr += ops[i % 3];
+            expr += (i % 2 == 0) ? std::string( i % 4 == 0 ? "a" : "b" ) : std::to_string( i + f );
+        }
+        res += indent + d.assign + expr + d.stmt_end + '\n';
+        res += indent + d.ret + 'x' + d.stmt_end + '\n';
+        for( int i = l.depth; i > 0; --i ) {
+            indent.resize( indent.size() - 4 );
+            res += indent + d.else_ + '\n';
+            res += indent + "    " + d.ret + 'b' + d.stmt_end + '\n';
+            res += indent + d.if_end + '\n';
+        }
+        if( l.depth == 0 ) {
+            res += indent + d.ret + 'a' + d.stmt_end + '\n';
+        }
+        res += std::string( d.func_end ) + "\n\n";
+    }
+    return res;
+}
+
+double count_lines( std::string const &code )
+{
+    return static_cast<double>(std::count( code.begin(), code.end(), '\n' ));
+}
+
+
+#if BENCH_ENABLE_TEA
+double exec_tea_parse( std::string const &code )
+{
+    teascript::Parser  p;
+    try {
+        auto start = bench::Start();
+        auto ast   = p.Parse( code );
+        auto end   = bench::Stop();
+
+        return bench::CalcTimeInSecs( start, end );
+
+    } catch( teascript::exception::runtime_error const &ex ) {
+        teascript::util::pretty_print( ex );
+    } catch( std::exception const &ex ) {
+        puts( ex.what() );
+    }
+
+    return -1.0;
+}
+
+#if TEASCRIPT_VERSION >= TEASCRIPT_BUILD_VERSION_NUMBER(0,14,0)
+double exec_tea_compile( std::string const &code, teascript::eOptimize const opt )
+{
+    teascript::Parser  p;
+    teascript::StackVM::Compiler  compiler;
+    try {
+        auto ast   = p.Parse( code );
+
+        auto start = bench::Start();
+        auto prog  = compiler.Compile( ast, opt );
+        auto end   = bench::Stop();
+
+        return bench::CalcTimeInSecs( start, end );
+
+    } catch( teascript::exception::runtime_error const &ex ) {
+        teascript::util::pretty_print( ex );
+    } catch( std::exception const &ex ) {
+        puts( ex.what() );
+    }
+
+    return -1.0;
+}
+#endif
+#endif
+
+#if BENCH_ENABLE_CHAI
+double exec_chai_parse( std::string const &code )
+{
+    chaiscript::ChaiScript chai;
+    try {
+        auto start = bench::Start();
+        auto ast   = chai.parse( code );
+        auto end   = bench::Stop();
+
+        return bench::CalcTimeInSecs( start, end );
+
+    } catch( chaiscript::Boxed_Value const &bv ) {
+        puts( chaiscript::boxed_cast<chaiscript::exception::eval_error const &>(bv).what() );
+    } catch( std::exception const &ex ) {
+        puts( ex.what() );
+    }
+
+    return -1.0;
+}
+#endif
+
+#if BENCH_ENABLE_JINX
+double exec_jinx_parse( std::string const &code )
+{
+    auto jinx = Jinx::CreateRuntime(); // new runtime for not redefine the functions.
+    try {
+        auto start  = bench::Start();
+        auto script = jinx->CreateScript( code.c_str() );
+        auto end    = bench::Stop();
+
+        if( !script ) {
+            throw std::runtime_error( "Jinx Error!" );
+        }
+
+        return bench::CalcTimeInSecs( start, end );
+
+    } catch( std::exception const &ex ) {
+        puts( ex.what() );
+    }
+
+    return -1.0;
+}
+#endif
+
+} // namespace
+
+
+void PrintUsageParse()
+{
+    std::cout << "Parse options:\n"
+                 "  --funcs=N,...        count(s) of functions of the generated scripts (default: " BENCH_FUNCS ")\n"
+                 "  --depth=N,...        nesting depth of the if/else blocks in each function (default: " << BENCH_DEPTH << ")\n"
+                 "  --expr=N,...         count of operands of the expression in each function (default: " << BENCH_EXPR << ")\n"
+                 "  --show-script        prints the generated scripts of the smallest size.\n"
+                 "engines: tea (parse), tea-vm-debug, tea-vm-o0, tea-vm-o1, tea-vm-o2 (compile only), chai, jinx\n";
+}
+
+int BenchParse( bench::CmdLine const &cmd )
+{
+    if( cmd.Has( "help" ) ) {
+        PrintUsageParse();
+        return EXIT_SUCCESS;
+    }
+
+    bench::ApplyConfig( cmd );
+#if BENCH_ENABLE_JINX
+    bench::SetEngineVersion( "jinx", bench::VersionString( Jinx::MajorVersion, Jinx::MinorVersion, Jinx::PatchNumber ) );
+    Jinx::GlobalParams  params;
+    params.errorOnMaxInstrunctions = false;
+    Jinx::Initialize( params );
+#endif
+#if BENCH_ENABLE_TEA
+    bench::SetEngineVersion( "tea", bench::VersionString( TEASCRIPT_VERSION_MAJOR, TEASCRIPT_VERSION_MINOR, TEASCRIPT_VERSION_PATCH ) );
+#endif
+#if BENCH_ENABLE_CHAI
+    bench::SetEngineVersion( "chai", chaiscript::Build_Info::version() );
+#endif
+
+    auto funcs = cmd.GetIntList( "funcs", {} );
+    if( funcs.empty() ) {
+        for( auto const &s : bench::CmdLine::Split( BENCH_FUNCS ) ) {
+            funcs.push_back( std::atoll( s.c_str() ) );
+        }
+    }
+    std::sort( funcs.begin(), funcs.end() );
+    auto const depths = cmd.GetIntList( "depth", { BENCH_DEPTH } );
+    auto const exprs  = cmd.GetIntList( "expr", { BENCH_EXPR } );
+
+    std::cout << "Benchmarking the parse and compile throughput of TeaScript, ChaiScript and Jinx.\n";
+
+    int failed = 0;
+    for( auto const depth : depths ) {
+        for( auto const expr : exprs ) {
+            // test title -> script bytes and median time of each size for the scaling.
+            std::map<std::string, std::pair<std::vector<double>, std::vector<double>>>  scaling;
+
+            for( auto const func_count : funcs ) {
+                ScriptLayout  l;
+                l.funcs = static_cast<int>(func_count);
+                l.depth = static_cast<int>(depth);
+                l.expr  = static_cast<int>(expr);
+                if( l.funcs < 1 || l.depth < 0 || l.expr < 1 ) {
+                    std::cout << "Wrong parameters: funcs and expr must be >= 1, depth >= 0." << std::endl;
+                    return EXIT_FAILURE;
+                }
+
+                auto const tea_script  = generate_script( tea_dialect, l );
+                auto const chai_script = generate_script( chai_dialect, l );
+                auto const jinx_script = generate_script( jinx_dialect, l );
+                if( cmd.Has( "show-script" ) && func_count == funcs.front() ) {
+                    std::cout << "\nTeaScript:\n" << tea_script << "ChaiScript:\n" << chai_script << "Jinx:\n" << jinx_script;
+                }
+
+                bench::Suite  suite( cmd, "parse", { { "funcs", std::to_string( l.funcs ) }, { "depth", std::to_string( l.depth ) },
+                                                     { "expr", std::to_string( l.expr ) } } );
+                suite.SetOps( count_lines( tea_script ), "line" );
+                // script bytes of each test for MB/s.
+                std::map<std::string, double>  bytes;
+
+#if BENCH_ENABLE_TEA
+                bytes["TeaScript Parse"] = static_cast<double>(tea_script.size());
+                suite.Add( "tea", "TeaScript Parse", [&] { return exec_tea_parse( tea_script ); } );
+#if TEASCRIPT_VERSION >= TEASCRIPT_BUILD_VERSION_NUMBER(0,14,0)
+                struct OptLevel { char const *id; char const *title; teascript::eOptimize opt; };
+                static OptLevel const opt_levels[] = {
+                    { "tea-vm-debug", "TeaScript Compile Debug", teascript::eOptimize::Debug },
+                    { "tea-vm-o0",    "TeaScript Compile O0",    teascript::eOptimize::O0 },
+                    { "tea-vm-o1",    "TeaScript Compile O1",    teascript::eOptimize::O1 },
+                    { "tea-vm-o2",    "TeaScript Compile O2",    teascript::eOptimize::O2 },
+                };
+                for( auto const &lvl : opt_levels ) {
+                    bytes[lvl.title] = static_cast<double>(tea_script.size());
+                    suite.Add( lvl.id, lvl.title, [&tea_script, opt = lvl.opt] { return exec_tea_compile( tea_script, opt ); } );
+                }
+#endif
+#endif
+#if BENCH_ENABLE_CHAI
+                bytes["ChaiScript Parse"] = static_cast<double>(chai_script.size());
+                suite.Add( "chai", "ChaiScript Parse", [&] { return exec_chai_parse( chai_script ); }, count_lines( chai_script ) );
+#endif
+#if BENCH_ENABLE_JINX
+                bytes["Jinx CreateScript"] = static_cast<double>(jinx_script.size());
+                suite.Add( "jinx", "Jinx CreateScript", [&] { return exec_jinx_parse( jinx_script ); }, count_lines( jinx_script ) );
+#endif
+
+                auto const first = bench::Records().size();
+                failed += suite.Run();
+
+                auto const prec = std::cout.precision( 2 );
+                std::cout << "\nthroughput (median):\n";
+                for( auto i = first; i < bench::Records().size(); ++i ) {
+                    auto const &r    = bench::Records()[i];
+                    auto const  secs = r.result.stats.median;
+                    std::cout << "  " << r.title << ": " << r.ops / secs << " lines/s, " << bytes[r.title] / secs / (1024.0 * 1024.0) << " MB/s\n";
+                    scaling[r.title].first.push_back( bytes[r.title] );
+                    scaling[r.title].second.push_back( secs );
+                }
+                std::cout << std::flush;
+                std::cout.precision( prec );
+            }
+
+            if( funcs.size() > 1 ) {
+                std::cout << "\nscaling over the script size (depth=" << depth << " expr=" << expr << "):\n";
+                for( auto const &[title, values] : scaling ) {
+                    bench::PrintScaling( "  " + title, values.first, values.second );
+                }
+            }
+        }
+    }
+
+    return failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+
+#if !defined BENCH_DRIVER
+int main( int argc, char *argv[] )
+{
+    bench::GetConfig() = { .warmup_runs = BENCH_WARMUP_RUNS, .min_runs = BENCH_MIN_RUNS, .max_runs = BENCH_MAX_RUNS,
+                           .target_rel_error = BENCH_TARGET_REL_ERROR };
+
+    return bench::Main( argc, argv, &BenchParse );
+}
+#endif
@@ -0,0 +1,415 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (C) 2024 Florian Thake, <contact |at| tea-age.solutions>.
+ * SPDX-License-Identifier: MIT
+ */
+
+// Benchmarking the startup costs of TeaScript VS ChaiScript VS Jinx.
+//
+// All other benchmarks exclude the construction and bootstrapping of the engines from the measurement, here it is
+// the region of interest: the time to a ready to execute engine (--phase=ready) and the time to the first result
+// of a trivial script, which includes parsing and executing (--phase=first).
+// The memory of a ready engine is reported with --alloc (live-bytes, peak-live-bytes).
+// The engines are destroyed outside of the measured region.
+
+// === BENCH CONFIG ===
+
+#define BENCH_ENABLE_CHAI  1                    // 1 == Enable ChaiScript, 0 == Disable
+#define BENCH_ENABLE_JINX  1                    // 1 == Enable Jinx, 0 == Disable
+#define BENCH_ENABLE_TEA   1                    // 1 == Enable TeaScript, 0 == Disable
+
+#define BENCH_WARMUP_RUNS      1                // runs of each test before measuring (not part of the statistic).
+#define BENCH_MIN_RUNS         10               // minimum count of measured runs for each test.
+#define BENCH_MAX_RUNS         100              // maximum count of measured runs for each test.
+#define BENCH_TARGET_REL_ERROR 0.02             // repeat until the 95% confidence interval of the mean is within +-2% (or BENCH_MAX_RUNS is reached).
+
+// NOTE: all tests of the enabled languages are compiled in. Which are run can be selected via command line,
+//       e.g. --phase=ready --level=core,full --engine=tea,chai (see --help)
+
+
+// handle some annoying compile errors on MSVC
+#if defined _MSC_VER  && !defined _SILENCE_CXX17_CODECVT_HEADER_DEPRECATION_WARNING
+# define _SILENCE_CXX17_CODECVT_HEADER_DEPRECATION_WARNING
+#endif
+#if defined _MSC_VER  && !defined _SILENCE_CXX20_U8PATH_DEPRECATION_WARNING
+# define _SILENCE_CXX20_U8PATH_DEPRECATION_WARNING
+#endif
+#if defined _MSC_VER  && !defined _CRT_SECURE_NO_WARNINGS
+# define _CRT_SECURE_NO_WARNINGS
+#endif
+
+//for VS use /Zc:__cplusplus
+#if __cplusplus < 202002L
+# if defined _MSVC_LANG // fallback without /Zc:__cplusplus
+#  if !_HAS_CXX20
+#   error must use at least C++20
+#  endif
+# else
+#  error must use at least C++20
+# endif
+#endif
+
+
+#include <cstdlib> // EXIT_SUCCESS
+#include <cstdio>
+#include <cstdint>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+
+#include "../Common/BenchCore.hpp"
+#include "../Common/BenchCmdLine.hpp"
+#if !defined BENCH_DRIVER
+# define BENCH_ALLOC_IMPLEMENTATION // this is the main translation unit
+#endif
+#include "../Common/BenchMain.hpp"
+
+#if BENCH_ENABLE_JINX
+#include <Jinx.hpp>
+#endif
+#if BENCH_ENABLE_TEA
+#include <teascript/Engine.hpp>
+#include <teascript/Parser.hpp>
+#include <teascript/CoreLibrary.hpp>
+// check version if new enough (Engine with config exists)
+#if TEASCRIPT_VERSION < TEASCRIPT_BUILD_VERSION_NUMBER(0,13,0)
+# error Use TeaScript 0.13.0 or newer
+#endif
+#endif
+#if BENCH_ENABLE_CHAI
+#if defined(_WIN32)
+#  define NOMINMAX
+#  define WIN32_LEAN_AND_MEAN
+# endif
+# if defined( _MSC_VER )
+#  pragma warning( push )
+#  pragma warning( disable: 4244 )
+# endif
+#include <chaiscript/chaiscript.hpp>
+# if defined( _MSC_VER )
+#  pragma warning( pop )
+# endif
+#endif
+
+
+namespace {
+
+// the trivial scripts for the time to the first result.
+constexpr char tea_code[]  = "6 * 7";
+constexpr char chai_code[] = "6 * 7";
+constexpr char jinx_code[] = "set res to 6 * 7";
+
+
+#if BENCH_ENABLE_TEA
+auto tea_config( std::string const &level )
+{
+    if( level == "core" ) {
+        return teascript::config::core();
+    } else if( level == "util" ) {
+        return teascript::config::util();
+    }
+    return teascript::config::full();
+}
+
+double exec_tea_ready( std::string const &level )
+{
+    auto const config = tea_config( level );
+    std::optional<teascript::Engine>  engine;
+    try {
+        auto start = bench::Start();
+        engine.emplace( config );
+        auto end   = bench::Stop();
+
+        return bench::CalcTimeInSecs( start, end );
+
+    } catch( teascript::exception::runtime_error const &ex ) {
+        teascript::util::pretty_print( ex );
+    } catch( std::exception const &ex ) {
+        puts( ex.what() );
+    }
+
+    return -1.0;
+}
+
+double exec_tea_first( std::string const &level )
+{
+    auto const config = tea_config( level );
+    std::optional<teascript::Engine>  engine;
+    try {
+        auto start  = bench::Start();
+        engine.emplace( config );
+        auto teares = engine->ExecuteCode( tea_code );
+        auto end    = bench::Stop();
+
+        bench::PrintValue( teares.GetAsInteger() );
+
+        return bench::CalcTimeInSecs( start, end );
+
+    } catch( teascript::exception::runtime_error const &ex ) {
+        teascript::util::pretty_print( ex );
+    } catch( std::exception const &ex ) {
+        puts( ex.what() );
+    }
+
+    return -1.0;
+}
+
+#if TEASCRIPT_VERSION >= TEASCRIPT_BUILD_VERSION_NUMBER(0,14,0)
+double exec_tea_vm_first( std::string const &level )
+{
+    auto const config = tea_config( level );
+    std::optional<teascript::Engine>  engine;
+    try {
+        auto start  = bench::Start();
+        engine.emplace( config );
+        auto prog   = engine->CompileCode( tea_code, teascript::eOptimize::O0 );
+        auto teares = engine->ExecuteProgram( prog );
+        auto end    = bench::Stop();
+
+        bench::PrintValue( teares.GetAsInteger() );
+
+        return bench::CalcTimeInSecs( start, end );
+
+    } catch( teascript::exception::runtime_error const &ex ) {
+        teascript::util::pretty_print( ex );
+    } catch( std::exception const &ex ) {
+        puts( ex.what() );
+    }
+
+    return -1.0;
+}
+#endif
+
+// only the Context with the bootstrapped CoreLibrary (the minimum for execute code, without the Engine around).
+double exec_tea_context_ready( std::string const &level )
+{
+    auto const config = tea_config( level );
+    std::optional<teascript::Context>  c;
+    try {
+        auto start = bench::Start();
+        c.emplace();
+        teascript::CoreLibrary().Bootstrap( *c, config );
+        auto end   = bench::Stop();
+
+        return bench::CalcTimeInSecs( start, end );
+
+    } catch( teascript::exception::runtime_error const &ex ) {
+        teascript::util::pretty_print( ex );
+    } catch( std::exception const &ex ) {
+        puts( ex.what() );
+    }
+
+    return -1.0;
+}
+
+double exec_tea_context_first( std::string const &level )
+{
+    auto const config = tea_config( level );
+    std::optional<teascript::Context>  c;
+    std::optional<teascript::Parser>   p;
+    try {
+        auto start  = bench::Start();
+        c.emplace();
+        teascript::CoreLibrary().Bootstrap( *c, config );
+        p.emplace();
+        auto teares = p->Parse( tea_code )->Eval( *c );
+        auto end    = bench::Stop();
+
+        bench::PrintValue( teares.GetAsInteger() );
+
+        return bench::CalcTimeInSecs( start, end );
+
+    } catch( teascript::exception::runtime_error const &ex ) {
+        teascript::util::pretty_print( ex );
+    } catch( std::exception const &ex ) {
+        puts( ex.what() );
+    }
+
+    return -1.0;
+}
+#endif
+
+#if BENCH_ENABLE_CHAI
+double exec_chai_ready()
+{
+    std::optional<chaiscript::ChaiScript>  chai;
+    try {
+        auto start = bench::Start();
+        chai.emplace();
+        auto end   = bench::Stop();
+
+        return bench::CalcTimeInSecs( start, end );
+
+    } catch( std::exception const &ex ) {
+        puts( ex.what() );
+    }
+
+    return -1.0;
+}
+
+double exec_chai_first()
+{
+    std::optional<chaiscript::ChaiScript>  chai;
+    try {
+        auto start = bench::Start();
+        chai.emplace();
+        auto chres = chai->eval( chai_code );
+        auto end   = bench::Stop();
+
+        bench::PrintValue( chaiscript::boxed_cast<int>(chres) );
+
+        return bench::CalcTimeInSecs( start, end );
+
+    } catch( chaiscript::Boxed_Value const &bv ) {
+        puts( chaiscript::boxed_cast<chaiscript::exception::eval_error const &>(bv).what() );
+    } catch( std::exception const &ex ) {
+        puts( ex.what() );
+    }
+
+    return -1.0;
+}
+#endif
+
+#if BENCH_ENABLE_JINX
+double exec_jinx_ready()
+{
+    Jinx::GlobalParams  params;
+    params.errorOnMaxInstrunctions = false;
+    Jinx::RuntimePtr  jinx;
+    try {
+        auto start = bench::Start();
+        Jinx::Initialize( params );
+        jinx = Jinx::CreateRuntime();
+        auto end   = bench::Stop();
+
+        return bench::CalcTimeInSecs( start, end );
+
+    } catch( std::exception const &ex ) {
+        puts( ex.what() );
+    }
+
+    return -1.0;
+}
+
+double exec_jinx_first()
+{
+    Jinx::GlobalParams  params;
+    params.errorOnMaxInstrunctions = false;
+    Jinx::RuntimePtr  jinx;
+    Jinx::ScriptPtr   script;
+    try {
+        auto start = bench::Start();
+        Jinx::Initialize( params );
+        jinx   = Jinx::CreateRuntime();
+        script = jinx->CreateScript( jinx_code );
+        do {
+            bool const res = script->Execute();
+            if( !res ) {
+                throw std::runtime_error( "Jinx Error!" );
+            }
+        } while( !script->IsFinished() );
+        auto end   = bench::Stop();
+
+        bench::PrintValue( script->GetVariable( "res" ).GetInteger() );
+
+        return bench::CalcTimeInSecs( start, end );
+
+    } catch( std::exception const &ex ) {
+        puts( ex.what() );
+    }
+
+    return -1.0;
+}
+#endif
+
+} // namespace
+
+
+void PrintUsageStartup()
+{
+    std::cout << "Startup options:\n"
+                 "  --phase=ready,first          ready: time to a ready engine, first: time to the first result of a trivial script\n"
+                 "                               (default: ready,first)\n"
+                 "  --level=core,util,full       TeaScript config level(s) (default: core,util,full)\n"
+                 "                               chai and jinx have no levels, they are run with level full only.\n"
+                 "  use --alloc for the memory of the engines.\n"
+                 "engines: tea (Engine), tea-context (Context + CoreLibrary only), tea-vm (first only), chai, jinx\n";
+}
+
+int BenchStartup( bench::CmdLine const &cmd )
+{
+    if( cmd.Has( "help" ) ) {
+        PrintUsageStartup();
+        return EXIT_SUCCESS;
+    }
+
+    bench::ApplyConfig( cmd );
+#if BENCH_ENABLE_JINX
+    bench::SetEngineVersion( "jinx", bench::VersionString( Jinx::MajorVersion, Jinx::MinorVersion, Jinx::PatchNumber ) );
+#endif
+#if BENCH_ENABLE_TEA
+    bench::SetEngineVersion( "tea", bench::VersionString( TEASCRIPT_VERSION_MAJOR, TEASCRIPT_VERSION_MINOR, TEASCRIPT_VERSION_PATCH ) );
+#endif
+#if BENCH_ENABLE_CHAI
+    bench::SetEngineVersion( "chai", chaiscript::Build_Info::version() );
+#endif
+
+    auto const phases = cmd.GetList( "phase", { "ready", "first" } );
+    auto const levels = cmd.GetList( "level", { "core", "util", "full" } );
+
+    std::cout << "Benchmarking the startup of TeaScript, ChaiScript and Jinx.\n";
+
+    int failed = 0;
+    for( auto const &phase : phases ) {
+        if( phase != "ready" && phase != "first" ) {
+            std::cout << "Unknown phase: " << phase << std::endl;
+            return EXIT_FAILURE;
+        }
+        [[maybe_unused]] bool const first = phase == "first";
+        for( auto const &level : levels ) {
+            if( level != "core" && level != "util" && level != "full" ) {
+                std::cout << "Unknown level: " << level << std::endl;
+                return EXIT_FAILURE;
+            }
+            bench::Suite  suite( cmd, "startup", { { "phase", phase }, { "level", level } } );
+
+#if BENCH_ENABLE_TEA
+            if( first ) {
+                suite.Add( "tea", "TeaScript Engine", [=] { return exec_tea_first( level ); } );
+#if TEASCRIPT_VERSION >= TEASCRIPT_BUILD_VERSION_NUMBER(0,14,0)
+                suite.Add( "tea-vm", "TeaScript Engine compiled for TeaStackVM", [=] { return exec_tea_vm_first( level ); } );
+#endif
+                suite.Add( "tea-context", "TeaScript Context + Parser", [=] { return exec_tea_context_first( level ); } );
+            } else {
+                suite.Add( "tea", "TeaScript Engine", [=] { return exec_tea_ready( level ); } );
+                suite.Add( "tea-context", "TeaScript Context", [=] { return exec_tea_context_ready( level ); } );
+            }
+#endif
+
+            // no config levels available.
+            if( level == "full" ) {
+#if BENCH_ENABLE_CHAI
+                suite.Add( "chai", "ChaiScript", first ? &exec_chai_first : &exec_chai_ready );
+#endif
+#if BENCH_ENABLE_JINX
+                suite.Add( "jinx", "Jinx", first ? &exec_jinx_first : &exec_jinx_ready );
+#endif
+            }
+
+            failed += suite.Run();
+        }
+    }
+
+    return failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+
+#if !defined BENCH_DRIVER
+int main( int argc, char *argv[] )
+{
+    bench::GetConfig() = { .warmup_runs = BENCH_WARMUP_RUNS, .min_runs = BENCH_MIN_RUNS, .max_runs = BENCH_MAX_RUNS,
+                           .target_rel_error = BENCH_TARGET_REL_ERROR };
+
+    return bench::Main( argc, argv, &BenchStartup );
+}
+#endif
@@ -4,14 +4,29 @@
  */
 
 
-// Benchmarking variable lookup / change in TeaScript's Context.
+// Benchmarking variable lookup / change in TeaScript's Context and the counterparts in the host API of ChaiScript and Jinx.
+//
+// The names of the variables are precomputed in a table and the accessed names in a list (in the order of the access
+// pattern), so only the work of the Context (hashing, comparing, ...) is measured.
 
 
-#define BENCH_SCOPES            10
-#define BENCH_VARS_PER_SCOPE    1000
-#define BENCH_OPERATIONS        ((BENCH_VARS_PER_SCOPE) / 2)
+#define BENCH_SCOPES            10                              // default for --scopes
+#define BENCH_VARS_PER_SCOPE    1000                            // default for --vars
+#define BENCH_OPERATIONS        ((BENCH_VARS_PER_SCOPE) / 2)    // default for --ops (if not given: vars per scope / 2)
+#define BENCH_ZIPF_S            1.0                             // default for --zipf-s, the skew of the Zipf access pattern.
+#define BENCH_SEED              42                              // seed for the random access patterns (the same for each run).
 
-#define BENCH_ITERATIONS        10
+// defaults for the scaling sweep (--sweep=scopes or --sweep=vars)
+#define BENCH_SWEEP_SCOPES      1,10,100,1000                   // default for --scopes with --sweep=scopes
+#define BENCH_SWEEP_VARS        1,10,100,1000,10000,100000,1000000  // default for --vars with --sweep=vars
+#define BENCH_SWEEP_FIX_SCOPES  2                               // default for --scopes with --sweep=vars
+#define BENCH_SWEEP_FIX_VARS    100                             // default for --vars with --sweep=scopes
+#define BENCH_SWEEP_OPS         1000                            // default for --ops with a sweep (limited to the vars per scope)
+
+#define BENCH_WARMUP_RUNS       1
+#define BENCH_MIN_RUNS          10
+#define BENCH_MAX_RUNS          50
+#define BENCH_TARGET_REL_ERROR  0.02
 
 
 #define BENCH_ENABLE_LOOKUP     1
@@ -20,11 +35,20 @@
 #define BENCH_ENABLE_SHARED_SET 1
 #define BENCH_ENABLE_REMOVE     1
 
+#define BENCH_ENABLE_CHAI       1       // 1 == Enable ChaiScript, 0 == Disable (TeaScript is always enabled)
+#define BENCH_ENABLE_JINX       1       // 1 == Enable Jinx, 0 == Disable
+
+// NOTE: all enabled tests are compiled in. Which are run and with which parameters can be selected
+//       via command line, e.g. --op=lookup,add --scopes=10,100 --vars=1000 --names=short,prefix --pattern=seq,zipf (see --help)
+
 
 
 // With this define a switch between the old (== 0) and the new (== 1) implementation is possible. 
 // This define only exists for version 0.13. 0.12 and before only have the old impl, 0.14 and later will only have the new impl.
+// NOTE: If it is defined in the project settings already, that value will be used (must be the same for all files of the project).
+#if !defined TEASCRIPT_USE_COLLECTION_VARIABLE_STORAGE
 # define TEASCRIPT_USE_COLLECTION_VARIABLE_STORAGE     1
+#endif
 
 // define this for disable using of Boost container but using std container
 // undefine(!) it for Boost is used (if present in include path)
@@ -32,6 +56,9 @@
 // NOTE: Using boost is only implemented for the new implementaion. The old will always use std container.
 //#define TEASCRIPT_DISABLE_BOOST     1
 
+// NOTE: Both defines are set in the project settings of the build variants Bench_VariableLookup_Std (std container)
+//       and Bench_VariableLookup_Legacy (old implementation, TeaScript 0.13 only). They can be compared with Bench_Variants.
+
 
 
 // handle some annoying compile errors on MSVC
@@ -60,44 +87,184 @@
 
 #include "teascript/Context.hpp"
 
+// the build variant, it is printed and stored with the engine version of TeaScript.
+// only 0.13 has both storage implementations, so the label follows the version and not only the defines.
+#if TEASCRIPT_VERSION < TEASCRIPT_BUILD_VERSION_NUMBER(0,13,0)
+# define BENCH_TEA_VARIANT      "legacy storage, std"
+#elif TEASCRIPT_VERSION >= TEASCRIPT_BUILD_VERSION_NUMBER(0,14,0) && !TEASCRIPT_USE_COLLECTION_VARIABLE_STORAGE
+# error The old variable storage (Bench_VariableLookup_Legacy) only exists up to TeaScript 0.13
+#elif TEASCRIPT_USE_COLLECTION_VARIABLE_STORAGE && !defined TEASCRIPT_DISABLE_BOOST
+# define BENCH_TEA_VARIANT      "collection storage, boost (if present)"
+#elif TEASCRIPT_USE_COLLECTION_VARIABLE_STORAGE
+# define BENCH_TEA_VARIANT      "collection storage, std"
+#else
+# define BENCH_TEA_VARIANT      "legacy storage, std"
+#endif
+
 
+#include <algorithm>
 #include <cstdlib> // EXIT_SUCCESS
 #include <cstdio>
+#include <cmath>
 #include <iostream>
 #include <chrono>
+#include <map>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../Common/BenchCore.hpp"
+#include "../Common/BenchCmdLine.hpp"
+#include "../Common/BenchFit.hpp"
+#if !defined BENCH_DRIVER
+# define BENCH_ALLOC_IMPLEMENTATION // this is the main translation unit
+#endif
+#include "../Common/BenchMain.hpp"
+
+#if BENCH_ENABLE_JINX
+#include <Jinx.hpp>
+#endif
+#if BENCH_ENABLE_CHAI
+#if defined(_WIN32)
+#  define NOMINMAX
+#  define WIN32_LEAN_AND_MEAN
+# endif
+# if defined( _MSC_VER )
+#  pragma warning( push )
+#  pragma warning( disable: 4244 )
+# endif
+#include <chaiscript/chaiscript.hpp>
+# if defined( _MSC_VER )
+#  pragma warning( pop )
+# endif
+#endif
 
 
-// for time measurement...
+namespace {
 
-auto Now()
+// the layout of the variables in the Context
+struct VarLayout
 {
-    return std::chrono::steady_clock::now();
-}
+    int  scopes         = BENCH_SCOPES;
+    int  vars_per_scope = BENCH_VARS_PER_SCOPE;
+    int  operations     = BENCH_OPERATIONS;
+};
 
-double CalcTimeInSecs( auto s, auto e )
+// the names of the variables, precomputed, so building the names is not part of the measurement.
+struct NameTable
+{
+    std::vector<std::vector<std::string>>  names;   // [scope][var], vars_per_scope + operations names per scope (the latter for add).
+    std::vector<std::string>               misses;  // names in the same style which are never defined.
+};
+
+// the styles of the names:
+//   short  - "var_S_V"
+//   long   - long names which differ at the beginning
+//   prefix - long names with a shared prefix, they differ only at the end
+//   mixed  - names of varying length (4 to ~60 chars)
+std::string make_name( std::string const &style, int s, int v )
 {
-    std::chrono::duration<double> const  timesecs = e - s;
-    return timesecs.count();
+    auto const id = std::to_string( s ) + "_" + std::to_string( v );
+    if( style == "long" ) {
+        return "var_" + id + "_with_a_rather_long_name_for_the_variable";
+    } else if( style == "prefix" ) {
+        return "a_rather_long_shared_prefix_of_all_variables_" + id;
+    } else if( style == "mixed" ) {
+        auto const pad = static_cast<size_t>((static_cast<unsigned int>(s) * 7919u + static_cast<unsigned int>(v) * 104729u) % 48u);
+        return "v" + id + std::string( pad, 'x' );
+    }
+    return "var_" + id;
 }
 
+NameTable make_names( VarLayout const &l, std::string const &style )
+{
+    NameTable  t;
+    t.names.resize( static_cast<size_t>(l.scopes) );
+    for( int scope = 0; scope < l.scopes; ++scope ) {
+        auto &names = t.names[static_cast<size_t>(scope)];
+        names.reserve( static_cast<size_t>(l.vars_per_scope + l.operations) );
+        for( int var_idx = 0; var_idx < l.vars_per_scope + l.operations; ++var_idx ) {
+            names.push_back( make_name( style, scope, var_idx ) );
+        }
+    }
+    // behind the names for add, so never defined.
+    for( int i = 0; i < l.operations; ++i ) {
+        t.misses.push_back( make_name( style, l.scopes - 1, l.vars_per_scope + l.operations + i ) );
+    }
+    return t;
+}
 
-
-// FIXME: better use 'random' names and store them in table??
-std::string make_name( int s, int v )
+// the names accessed by the operations in the current and in the global scope.
+struct Access
 {
-    return "var_" + std::to_string( s ) + "_" + std::to_string( v );
+    std::vector<std::string const *>  current;
+    std::vector<std::string const *>  global;
+};
+
+// the access patterns:
+//   seq     - the first 'operations' variables in order of definition
+//   uniform - uniform random over all variables of the scope
+//   zipf    - Zipf distributed (parameter s) over all variables, the hot set is spread over the scope
+//   miss    - only names which are not defined
+Access make_access( NameTable const &t, VarLayout const &l, std::string const &pattern, double const zipf_s )
+{
+    Access  a;
+    auto const ops = static_cast<size_t>(l.operations);
+    auto const n   = static_cast<size_t>(l.vars_per_scope);
+    std::vector<size_t>  idx;
+    idx.reserve( ops );
+    std::mt19937_64  rng( BENCH_SEED );
+    if( pattern == "seq" || pattern == "miss" ) {
+        for( size_t i = 0; i < ops; ++i ) {
+            idx.push_back( i );
+        }
+    } else if( pattern == "uniform" ) {
+        std::uniform_int_distribution<size_t>  dist( 0, n - 1 );
+        for( size_t i = 0; i < ops; ++i ) {
+            idx.push_back( dist( rng ) );
+        }
+    } else if( pattern == "zipf" ) {
+        // inverse transform sampling over the cumulated weights 1/rank^s, the ranks are mapped to shuffled variables.
+        std::vector<double>  cdf( n );
+        double sum = 0.0;
+        for( size_t r = 0; r < n; ++r ) {
+            sum   += 1.0 / std::pow( static_cast<double>(r + 1), zipf_s );
+            cdf[r] = sum;
+        }
+        std::vector<size_t>  rank_to_var( n );
+        std::iota( rank_to_var.begin(), rank_to_var.end(), size_t{ 0 } );
+        std::shuffle( rank_to_var.begin(), rank_to_var.end(), rng );
+        std::uniform_real_distribution<double>  dist( 0.0, sum );
+        for( size_t i = 0; i < ops; ++i ) {
+            auto const r = static_cast<size_t>(std::lower_bound( cdf.begin(), cdf.end(), dist( rng ) ) - cdf.begin());
+            idx.push_back( rank_to_var[std::min( r, n - 1 )] );
+        }
+    }
+
+    for( auto const i : idx ) {
+        if( pattern == "miss" ) {
+            a.current.push_back( &t.misses[i] );
+            a.global.push_back( &t.misses[i] );
+        } else {
+            a.current.push_back( &t.names[static_cast<size_t>(l.scopes - 1)][i] );
+            a.global.push_back( &t.names[0][i] );
+        }
+    }
+    return a;
 }
 
-void setup( teascript::Context &c )
+void setup( teascript::Context &c, VarLayout const &l, NameTable const &t )
 {
     // reset everything
     c = teascript::Context( teascript::TypeSystem() );
     
-    for( int scope = 0; scope < BENCH_SCOPES; ++scope ) {
+    for( int scope = 0; scope < l.scopes; ++scope ) {
 
-        for( int var_idx = 0; var_idx < BENCH_VARS_PER_SCOPE; ++var_idx ) {
+        for( int var_idx = 0; var_idx < l.vars_per_scope; ++var_idx ) {
            
-            c.AddValueObject( make_name( scope, var_idx ), teascript::ValueObject( static_cast<long long>(scope) * var_idx, true ) );
+            c.AddValueObject( t.names[static_cast<size_t>(scope)][static_cast<size_t>(var_idx)], teascript::ValueObject( static_cast<long long>(scope) * var_idx, true ) );
         }
 
         c.EnterScope();
@@ -105,160 +272,516 @@ void setup( teascript::Context &c )
     c.ExitScope(); // one too much.
 }
 
-double exec_lookup( teascript::Context &c )
+// NOTE: an access of a not defined name throws (pattern miss), the exception handling is part of the measurement then.
+
+double exec_lookup( teascript::Context &c, Access const &a )
 {
     teascript::ValueObject val_res;
     unsigned long long res = 0;
-    auto start = Now();
+    auto start = bench::Start();
     // first current scope
-    for( int i = 0; i < BENCH_OPERATIONS; ++i ) {
-        val_res = c.FindValueObject( make_name( BENCH_SCOPES - 1, i ) );
-        res += static_cast<unsigned long long>(val_res.GetValue<teascript::Integer>());
+    for( auto const *name : a.current ) {
+        try {
+            val_res = c.FindValueObject( *name );
+            res += static_cast<unsigned long long>(val_res.GetValue<teascript::Integer>());
+        } catch( teascript::exception::runtime_error const & ) {
+            ++res;
+        }
     }
 #if 1
     // then global scope
-    for( int i = 0; i < BENCH_OPERATIONS; ++i ) {
-        val_res = c.FindValueObject( make_name( 0, i ) );
-        res += static_cast<unsigned long long>(val_res.GetValue<teascript::Integer>());
+    for( auto const *name : a.global ) {
+        try {
+            val_res = c.FindValueObject( *name );
+            res += static_cast<unsigned long long>(val_res.GetValue<teascript::Integer>());
+        } catch( teascript::exception::runtime_error const & ) {
+            ++res;
+        }
     }
 #endif
-    auto end = Now();
+    auto end = bench::Stop();
 
-    std::cout << "value: " << res << std::endl;
+    bench::PrintValue( res );
 
-    return CalcTimeInSecs( start, end );
+    return bench::CalcTimeInSecs( start, end );
 }
 
 
-double exec_remove( teascript::Context &c )
+double exec_remove( teascript::Context &c, VarLayout const &l, NameTable const &t )
 {
+    auto const &names = t.names[static_cast<size_t>(l.scopes - 1)];
     teascript::ValueObject val_res;
     unsigned long long res = 0;
-    auto start = Now();
+    auto start = bench::Start();
     // only current scope possible
-    for( int i = 0; i < BENCH_OPERATIONS; ++i ) {
-        val_res = c.RemoveValueObject( make_name( BENCH_SCOPES - 1, i ) );
+    for( int i = 0; i < l.operations; ++i ) {
+        val_res = c.RemoveValueObject( names[static_cast<size_t>(i)] );
         res += static_cast<unsigned long long>(val_res.GetValue<teascript::Integer>());
     }
-    auto end = Now();
+    auto end = bench::Stop();
 
-    std::cout << "value: " << res << std::endl;
+    bench::PrintValue( res );
 
-    return CalcTimeInSecs( start, end );
+    return bench::CalcTimeInSecs( start, end );
 }
 
-double exec_add( teascript::Context &c )
+double exec_add( teascript::Context &c, VarLayout const &l, NameTable const &t )
 {
+    auto const &names = t.names[static_cast<size_t>(l.scopes - 1)];
     teascript::ValueObject  to_add( 1LL, true );
     teascript::ValueObject val_res;
     unsigned long long res = 0;
-    auto start = Now();
+    auto start = bench::Start();
     // only current scope possible
-    for( int i = 0; i < BENCH_OPERATIONS; ++i ) {
-        val_res = c.AddValueObject( make_name( BENCH_SCOPES - 1, BENCH_VARS_PER_SCOPE + i ), to_add );
+    for( int i = 0; i < l.operations; ++i ) {
+        val_res = c.AddValueObject( names[static_cast<size_t>(l.vars_per_scope + i)], to_add );
         res += static_cast<unsigned long long>(val_res.GetValue<teascript::Integer>());
     }
-    auto end = Now();
+    auto end = bench::Stop();
 
-    std::cout << "value: " << res << std::endl;
+    bench::PrintValue( res );
 
-    return CalcTimeInSecs( start, end );
+    return bench::CalcTimeInSecs( start, end );
 }
 
 
-double exec_set_copy( teascript::Context &c )
+double exec_set_copy( teascript::Context &c, Access const &a )
 {
     teascript::ValueObject  copy_from( 1LL, true );
     teascript::ValueObject val_res;
     unsigned long long res = 0;
-    auto start = Now();
+    auto start = bench::Start();
     // only current scope for now
-    for( int i = 0; i < BENCH_OPERATIONS; ++i ) {
-        val_res = c.SetValue( make_name( BENCH_SCOPES - 1, i ), copy_from, false );
-        res += static_cast<unsigned long long>(val_res.GetValue<teascript::Integer>());
+    for( auto const *name : a.current ) {
+        try {
+            val_res = c.SetValue( *name, copy_from, false );
+            res += static_cast<unsigned long long>(val_res.GetValue<teascript::Integer>());
+        } catch( teascript::exception::runtime_error const & ) {
+            ++res;
+        }
     }
-    auto end = Now();
+    auto end = bench::Stop();
 
-    std::cout << "value: " << res << std::endl;
+    bench::PrintValue( res );
 
-    return CalcTimeInSecs( start, end );
+    return bench::CalcTimeInSecs( start, end );
 }
 
 
-double exec_set_shared( teascript::Context &c )
+double exec_set_shared( teascript::Context &c, Access const &a )
 {
     teascript::ValueObject  shared_with( 1LL, true );
     teascript::ValueObject val_res;
     unsigned long long res = 0;
-    auto start = Now();
+    auto start = bench::Start();
     // only current scope for now
-    for( int i = 0; i < BENCH_OPERATIONS; ++i ) {
-        val_res = c.SetValue( make_name( BENCH_SCOPES - 1, i ), shared_with, true );
-        res += static_cast<unsigned long long>(val_res.GetValue<teascript::Integer>());
+    for( auto const *name : a.current ) {
+        try {
+            val_res = c.SetValue( *name, shared_with, true );
+            res += static_cast<unsigned long long>(val_res.GetValue<teascript::Integer>());
+        } catch( teascript::exception::runtime_error const & ) {
+            ++res;
+        }
+    }
+    auto end = bench::Stop();
+
+    bench::PrintValue( res );
+
+    return bench::CalcTimeInSecs( start, end );
+}
+
+
+// ChaiScript and Jinx don't have scopes in their host API. Only the variables of the global (first) and of the current (last)
+// scope are created, the Lookup accesses the same names as for TeaScript. Add and Set use the names of the current scope.
+
+#if BENCH_ENABLE_CHAI
+// the variables are added as globals (chai) or as locals (chai-local).
+void setup_chai( std::unique_ptr<chaiscript::ChaiScript> &chai, VarLayout const &l, NameTable const &t, bool const local )
+{
+    chai = std::make_unique<chaiscript::ChaiScript>();
+    // only the first and the last scope.
+    for( int scope = 0; scope < l.scopes; scope = (scope == l.scopes - 1 ? l.scopes : l.scopes - 1) ) {
+        for( int var_idx = 0; var_idx < l.vars_per_scope; ++var_idx ) {
+            auto const &name = t.names[static_cast<size_t>(scope)][static_cast<size_t>(var_idx)];
+            auto const  val  = chaiscript::var( static_cast<long long>(scope) * var_idx );
+            if( local ) {
+                chai->add( val, name );
+            } else {
+                chai->add_global( val, name );
+            }
+        }
+    }
+}
+
+// there is no lookup in the host API, so the name is evaluated (includes the parsing of the name).
+double exec_chai_lookup( chaiscript::ChaiScript &chai, Access const &a )
+{
+    unsigned long long res = 0;
+    auto start = bench::Start();
+    for( auto const *names : { &a.current, &a.global } ) {
+        for( auto const *name : *names ) {
+            try {
+                res += static_cast<unsigned long long>(chaiscript::boxed_cast<long long>(chai.eval( *name )));
+            } catch( chaiscript::exception::eval_error const & ) {
+                ++res;
+            }
+        }
+    }
+    auto end = bench::Stop();
+
+    bench::PrintValue( res );
+
+    return bench::CalcTimeInSecs( start, end );
+}
+
+double exec_chai_add( chaiscript::ChaiScript &chai, VarLayout const &l, NameTable const &t, bool const local )
+{
+    auto const &names = t.names[static_cast<size_t>(l.scopes - 1)];
+    auto const  to_add = chaiscript::var( 1LL );
+    auto start = bench::Start();
+    for( int i = 0; i < l.operations; ++i ) {
+        if( local ) {
+            chai.add( to_add, names[static_cast<size_t>(l.vars_per_scope + i)] );
+        } else {
+            chai.add_global( to_add, names[static_cast<size_t>(l.vars_per_scope + i)] );
+        }
+    }
+    auto end = bench::Stop();
+
+    return bench::CalcTimeInSecs( start, end );
+}
+
+double exec_chai_set( chaiscript::ChaiScript &chai, Access const &a )
+{
+    auto const copy_from = chaiscript::var( 1LL );
+    auto start = bench::Start();
+    for( auto const *name : a.current ) {
+        chai.set_global( copy_from, *name );
+    }
+    auto end = bench::Stop();
+
+    return bench::CalcTimeInSecs( start, end );
+}
+#endif
+
+#if BENCH_ENABLE_JINX
+// the names as Jinx::String (own allocator), converted before the measurement.
+struct JinxNames
+{
+    std::vector<Jinx::String>  current;
+    std::vector<Jinx::String>  global;
+    std::vector<Jinx::String>  add;
+};
+
+JinxNames make_jinx_names( Access const &a, VarLayout const &l, NameTable const &t )
+{
+    JinxNames  j;
+    for( auto const *name : a.current ) {
+        j.current.emplace_back( name->c_str() );
+    }
+    for( auto const *name : a.global ) {
+        j.global.emplace_back( name->c_str() );
+    }
+    for( int i = 0; i < l.operations; ++i ) {
+        j.add.emplace_back( t.names[static_cast<size_t>(l.scopes - 1)][static_cast<size_t>(l.vars_per_scope + i)].c_str() );
+    }
+    return j;
+}
+
+// the variables are library properties (jinx) or variables of a script (jinx-script).
+struct JinxVars
+{
+    Jinx::RuntimePtr  runtime;
+    Jinx::LibraryPtr  library;
+    Jinx::ScriptPtr   script;
+};
+
+bool setup_jinx( JinxVars &j, VarLayout const &l, NameTable const &t, bool const script )
+{
+    j = JinxVars{};
+    j.runtime = Jinx::CreateRuntime(); // Jinx::Initialize() is done once in BenchVariableLookup()
+    j.library = j.runtime->GetLibrary( "vars" );
+    if( script ) {
+        j.script = j.runtime->CreateScript( "" );
+        if( !j.script ) {
+            puts( "Jinx Error!" );
+            return false;
+        }
+    }
+    // only the first and the last scope.
+    for( int scope = 0; scope < l.scopes; scope = (scope == l.scopes - 1 ? l.scopes : l.scopes - 1) ) {
+        for( int var_idx = 0; var_idx < l.vars_per_scope; ++var_idx ) {
+            auto const *name = t.names[static_cast<size_t>(scope)][static_cast<size_t>(var_idx)].c_str();
+            auto const  val  = Jinx::Variant( static_cast<int64_t>(scope) * var_idx );
+            if( script ) {
+                j.script->SetVariable( name, val );
+            } else {
+                j.library->RegisterProperty( Jinx::Visibility::Public, Jinx::Access::ReadWrite, name, val );
+            }
+        }
+    }
+    return true;
+}
+
+// not defined names result in a null variant.
+double exec_jinx_lookup( JinxVars &j, JinxNames const &n )
+{
+    unsigned long long res = 0;
+    auto start = bench::Start();
+    for( auto const *names : { &n.current, &n.global } ) {
+        for( auto const &name : *names ) {
+            auto const val = j.script ? j.script->GetVariable( name ) : j.library->GetProperty( name );
+            res += val.IsNull() ? 1ULL : static_cast<unsigned long long>(val.GetInteger());
+        }
+    }
+    auto end = bench::Stop();
+
+    bench::PrintValue( res );
+
+    return bench::CalcTimeInSecs( start, end );
+}
+
+double exec_jinx_add( JinxVars &j, JinxNames const &n )
+{
+    auto const to_add = Jinx::Variant( static_cast<int64_t>(1) );
+    auto start = bench::Start();
+    for( auto const &name : n.add ) {
+        if( j.script ) {
+            j.script->SetVariable( name, to_add );
+        } else {
+            j.library->RegisterProperty( Jinx::Visibility::Public, Jinx::Access::ReadWrite, name, to_add );
+        }
     }
-    auto end = Now();
+    auto end = bench::Stop();
 
-    std::cout << "value: " << res << std::endl;
+    return bench::CalcTimeInSecs( start, end );
+}
 
-    return CalcTimeInSecs( start, end );
+double exec_jinx_set( JinxVars &j, JinxNames const &n )
+{
+    auto const copy_from = Jinx::Variant( static_cast<int64_t>(1) );
+    auto start = bench::Start();
+    for( auto const &name : n.current ) {
+        if( j.script ) {
+            j.script->SetVariable( name, copy_from );
+        } else {
+            j.library->SetProperty( name, copy_from );
+        }
+    }
+    auto end = bench::Stop();
+
+    return bench::CalcTimeInSecs( start, end );
 }
+#endif
+
+
+} // namespace
 
 
-int main()
+void PrintUsageVariableLookup()
 {
-    std::cout << std::fixed;
-    std::cout << std::setprecision( 8 );
+    std::cout << "VariableLookup options:\n"
+                 "  --op=lookup,add,set,shared-set,remove   operation(s) to test (default: all)\n"
+                 "  --scopes=N,...                          count of scopes (default: " << BENCH_SCOPES << ")\n"
+                 "  --vars=N,...                            variables per scope (default: " << BENCH_VARS_PER_SCOPE << ")\n"
+                 "  --ops=N                                 operations per test (default: vars per scope / 2)\n"
+                 "  --names=short,long,prefix,mixed         style(s) of the variable names (default: short)\n"
+                 "  --pattern=seq,uniform,zipf,miss         access pattern(s) of lookup and set (default: seq)\n"
+                 "                                          add and remove are always sequential (only run with seq)\n"
+                 "  --zipf-s=X                              parameter s of the Zipf distribution (default: " << BENCH_ZIPF_S << ")\n"
+                 "  --sweep=scopes|vars                     scaling sweep over the scope depth or the vars per scope,\n"
+                 "                                          prints the fitted complexity of the time per operation\n"
+                 "                                          (defaults: scopes 1..1000 with " << BENCH_SWEEP_FIX_VARS << " vars resp. vars 1..1M in "
+              << BENCH_SWEEP_FIX_SCOPES << " scopes, ops min(" << BENCH_SWEEP_OPS << ", vars))\n"
+                 "engines: tea, chai (globals), chai-local (locals), jinx (library properties), jinx-script (script variables)\n"
+                 "         chai and jinx only support Lookup, Add and Set (not with pattern miss).\n";
+}
+
+int BenchVariableLookup( bench::CmdLine const &cmd )
+{
+    if( cmd.Has( "help" ) ) {
+        PrintUsageVariableLookup();
+        return EXIT_SUCCESS;
+    }
+
+    bench::ApplyConfig( cmd );
+    bench::SetEngineVersion( "tea", bench::VersionString( TEASCRIPT_VERSION_MAJOR, TEASCRIPT_VERSION_MINOR, TEASCRIPT_VERSION_PATCH ) + " (" BENCH_TEA_VARIANT ")" );
+    std::cout << "TeaScript variant: " BENCH_TEA_VARIANT << std::endl;
+#if BENCH_ENABLE_JINX
+    bench::SetEngineVersion( "jinx", bench::VersionString( Jinx::MajorVersion, Jinx::MinorVersion, Jinx::PatchNumber ) );
+    bench::SetEngineVersion( "jinx-script", bench::VersionString( Jinx::MajorVersion, Jinx::MinorVersion, Jinx::PatchNumber ) );
+    Jinx::GlobalParams  params;
+    params.errorOnMaxInstrunctions = false;
+    Jinx::Initialize( params );
+#endif
+#if BENCH_ENABLE_CHAI
+    bench::SetEngineVersion( "chai", chaiscript::Build_Info::version() );
+    bench::SetEngineVersion( "chai-local", chaiscript::Build_Info::version() );
+#endif
+
+    auto const sweep = cmd.Get( "sweep" );
+    if( !sweep.empty() && sweep != "scopes" && sweep != "vars" ) {
+        std::cout << "Unknown sweep: " << sweep << std::endl;
+        return EXIT_FAILURE;
+    }
+    bool const sweep_scopes = sweep == "scopes";
+    bool const sweep_vars   = sweep == "vars";
+
+    auto const scopes   = cmd.GetIntList( "scopes", sweep_scopes ? std::vector<long long>{ BENCH_SWEEP_SCOPES }
+                                                                 : std::vector<long long>{ sweep_vars ? BENCH_SWEEP_FIX_SCOPES : BENCH_SCOPES } );
+    auto const vars     = cmd.GetIntList( "vars", sweep_vars ? std::vector<long long>{ BENCH_SWEEP_VARS }
+                                                             : std::vector<long long>{ sweep_scopes ? BENCH_SWEEP_FIX_VARS : BENCH_VARS_PER_SCOPE } );
+    auto const styles   = cmd.GetList( "names", { "short" } );
+    auto const patterns = cmd.GetList( "pattern", { "seq" } );
+    auto const zipf_s   = cmd.GetDouble( "zipf-s", BENCH_ZIPF_S );
+
+    for( auto const &style : styles ) {
+        if( style != "short" && style != "long" && style != "prefix" && style != "mixed" ) {
+            std::cout << "Unknown names: " << style << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+    for( auto const &pattern : patterns ) {
+        if( pattern != "seq" && pattern != "uniform" && pattern != "zipf" && pattern != "miss" ) {
+            std::cout << "Unknown pattern: " << pattern << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
 
-    std::cout << "Benchmarking TeaScript Variable Lookup, Remove and Set by directly use the Context class.\n";
+    std::cout << "Benchmarking TeaScript Variable Lookup, Remove and Set by directly use the Context class (and ChaiScript and Jinx via their host API).\n";
 
     teascript::Context c;
+#if BENCH_ENABLE_CHAI
+    std::unique_ptr<chaiscript::ChaiScript>  chai;
+#endif
+#if BENCH_ENABLE_JINX
+    JinxVars  jinx;
+#endif
+
+    // test title and the fixed parameters -> swept size and median time per operation, for the sweep.
+    std::map<std::string, std::pair<std::vector<double>, std::vector<double>>>  scaling;
+    std::map<std::string, bench::eComplexity>                                  expected;
+
+    int failed = 0;
+    for( auto const scope_count : scopes ) {
+        for( auto const var_count : vars ) {
+            VarLayout  l;
+            l.scopes         = static_cast<int>(scope_count);
+            l.vars_per_scope = static_cast<int>(var_count);
+            l.operations     = static_cast<int>(sweep.empty() ? cmd.GetInt( "ops", var_count / 2 )
+                                                              : std::min( cmd.GetInt( "ops", BENCH_SWEEP_OPS ), var_count ));
+            if( l.scopes < 1 || l.vars_per_scope < l.operations || l.operations < 1 ) {
+                std::cout << "Wrong parameters: scopes and ops must be >= 1 and ops <= vars." << std::endl;
+                return EXIT_FAILURE;
+            }
+
+            for( auto const &style : styles ) {
+                auto const names = make_names( l, style );
+                for( auto const &pattern : patterns ) {
+                    auto const access = make_access( names, l, pattern, zipf_s );
+                    bool const seq    = pattern == "seq";
+
+                    bench::Suite  suite( cmd, "varlookup", { { "scopes", std::to_string( l.scopes ) }, { "vars", std::to_string( l.vars_per_scope ) },
+                                                             { "ops", std::to_string( l.operations ) }, { "names", style }, { "pattern", pattern } } );
+                    suite.SetOps( static_cast<double>(l.operations), "operation" );
 
 #if BENCH_ENABLE_LOOKUP
-    std::cout << "\nStart Test Lookup" << std::endl;
-    for( int i = BENCH_ITERATIONS; i != 0; --i ) {
-        setup( c );
-        auto secs = exec_lookup( c );
-        std::cout << "Calculation took: " << secs << " seconds." << std::endl;
-    }
+                    if( cmd.Matches( "op", "lookup" ) ) {
+                        suite.Add( "tea", "Lookup", [&] { setup( c, l, names ); return exec_lookup( c, access ); }, 2.0 * l.operations ); // current and global scope
+                    }
 #endif
 
 #if BENCH_ENABLE_ADD
-    std::cout << "\nStart Test Add" << std::endl;
-    for( int i = BENCH_ITERATIONS; i != 0; --i ) {
-        setup( c );
-        auto secs = exec_add( c );
-        std::cout << "Calculation took: " << secs << " seconds." << std::endl;
-    }
+                    if( seq && cmd.Matches( "op", "add" ) ) {
+                        suite.Add( "tea", "Add", [&] { setup( c, l, names ); return exec_add( c, l, names ); } );
+                    }
 #endif
 
 #if BENCH_ENABLE_SET
-    std::cout << "\nStart Test Set Assign" << std::endl;
-    for( int i = BENCH_ITERATIONS; i != 0; --i ) {
-        setup( c );
-        auto secs = exec_set_copy( c );
-        std::cout << "Calculation took: " << secs << " seconds." << std::endl;
-    }
+                    if( cmd.Matches( "op", "set" ) ) {
+                        suite.Add( "tea", "Set Assign", [&] { setup( c, l, names ); return exec_set_copy( c, access ); } );
+                    }
 #endif
 
 #if BENCH_ENABLE_SHARED_SET
-    std::cout << "\nStart Test Set SharedAssign" << std::endl;
-    for( int i = BENCH_ITERATIONS; i != 0; --i ) {
-        setup( c );
-        auto secs = exec_set_shared( c );
-        std::cout << "Calculation took: " << secs << " seconds." << std::endl;
-    }
+                    if( cmd.Matches( "op", "shared-set" ) ) {
+                        suite.Add( "tea", "Set SharedAssign", [&] { setup( c, l, names ); return exec_set_shared( c, access ); } );
+                    }
 #endif
 
 #if BENCH_ENABLE_REMOVE
-    std::cout << "\nStart Test Remove" << std::endl;
-    for( int i = BENCH_ITERATIONS; i != 0; --i ) {
-        setup( c );
-        auto secs = exec_remove( c );
-        std::cout << "Calculation took: " << secs << " seconds." << std::endl;
-    }
+                    if( seq && cmd.Matches( "op", "remove" ) ) {
+                        suite.Add( "tea", "Remove", [&] { setup( c, l, names ); return exec_remove( c, l, names ); } );
+                    }
+#endif
+
+#if BENCH_ENABLE_CHAI
+                    for( bool const local : { false, true } ) {
+                        auto const engine = local ? "chai-local" : "chai";
+                        if( cmd.Matches( "op", "lookup" ) ) {
+                            suite.Add( engine, "Lookup", [&, local] { setup_chai( chai, l, names, local ); return exec_chai_lookup( *chai, access ); }, 2.0 * l.operations );
+                        }
+                        if( seq && cmd.Matches( "op", "add" ) ) {
+                            suite.Add( engine, "Add", [&, local] { setup_chai( chai, l, names, local ); return exec_chai_add( *chai, l, names, local ); } );
+                        }
+                        if( !local && pattern != "miss" && cmd.Matches( "op", "set" ) ) { // set_global() only
+                            suite.Add( engine, "Set Assign", [&] { setup_chai( chai, l, names, false ); return exec_chai_set( *chai, access ); } );
+                        }
+                    }
 #endif
 
-    puts( "\n\nTest end." );
+#if BENCH_ENABLE_JINX
+                    auto const jinx_names = make_jinx_names( access, l, names );
+                    for( bool const script : { false, true } ) {
+                        auto const engine = script ? "jinx-script" : "jinx";
+                        if( cmd.Matches( "op", "lookup" ) ) {
+                            suite.Add( engine, "Lookup", [&, script] { return setup_jinx( jinx, l, names, script ) ? exec_jinx_lookup( jinx, jinx_names ) : -1.0; }, 2.0 * l.operations );
+                        }
+                        if( seq && cmd.Matches( "op", "add" ) ) {
+                            suite.Add( engine, "Add", [&, script] { return setup_jinx( jinx, l, names, script ) ? exec_jinx_add( jinx, jinx_names ) : -1.0; } );
+                        }
+                        if( pattern != "miss" && cmd.Matches( "op", "set" ) ) {
+                            suite.Add( engine, "Set Assign", [&, script] { return setup_jinx( jinx, l, names, script ) ? exec_jinx_set( jinx, jinx_names ) : -1.0; } );
+                        }
+                    }
+#endif
+
+                    auto const first = bench::Records().size();
+                    failed += suite.Run();
+
+                    if( !sweep.empty() ) {
+                        for( auto i = first; i < bench::Records().size(); ++i ) {
+                            auto const &r   = bench::Records()[i];
+                            auto const  key = r.engine + " " + r.title + (sweep_scopes ? " (vars=" + std::to_string( l.vars_per_scope ) : " (scopes=" + std::to_string( l.scopes ))
+                                                      + " names=" + style + " pattern=" + pattern + ")";
+                            scaling[key].first.push_back( static_cast<double>(sweep_scopes ? l.scopes : l.vars_per_scope) );
+                            scaling[key].second.push_back( r.result.stats.median / r.ops );
+                            // hashed access is O(1), O(log n) is tolerated for the cache effects of the growing data.
+                            // the global lookup and not defined names must walk through all scopes, so O(depth).
+                            expected[key] = sweep_scopes && (r.title == "Lookup" || pattern == "miss") ? bench::eComplexity::ON : bench::eComplexity::OLogN;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    if( !scaling.empty() ) {
+        std::cout << "\nscaling of the time per operation over the " << (sweep_scopes ? "scope depth" : "vars per scope") << ":\n";
+        for( auto const &[key, values] : scaling ) {
+            bench::PrintScaling( "  " + key, values.first, values.second, expected[key] );
+        }
+    }
+
+    return failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
 
-    return EXIT_SUCCESS;
-}
\ No newline at end of file
+#if !defined BENCH_DRIVER
+int main( int argc, char *argv[] )
+{
+    bench::GetConfig() = { .warmup_runs = BENCH_WARMUP_RUNS, .min_runs = BENCH_MIN_RUNS, .max_runs = BENCH_MAX_RUNS,
+                           .target_rel_error = BENCH_TARGET_REL_ERROR };
+
+    return bench::Main( argc, argv, &BenchVariableLookup );
+}
+#endif
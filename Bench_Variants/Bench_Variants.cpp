@@ -0,0 +1,285 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (C) 2024 Florian Thake, <contact |at| tea-age.solutions>.
+ * SPDX-License-Identifier: MIT
+ */
+
+
+// Runs the build variants of a benchmark interleaved with identical parameters and compares their results.
+//
+// The variants are separate executables of the same benchmark, built with different defines, e.g.
+//   Bench_VariableLookup        - new variable storage (collection) with Boost container,
+//   Bench_VariableLookup_Std    - new variable storage with std container (TEASCRIPT_DISABLE_BOOST),
+//   Bench_VariableLookup_Legacy - old variable storage (TEASCRIPT_USE_COLLECTION_VARIABLE_STORAGE 0, only TeaScript 0.13
+//                                 has both implementations, with 0.14 and later it does not build).
+// The variant of each executable is printed with the engine versions, before 0.13 all variants use the old storage.
+// In each round every variant is executed once with the options after -- (plus --json=FILE). The order is rotated
+// per round, so a drift of the machine state (thermal, other processes) hits all variants equally.
+// Afterwards the samples of all rounds are merged per test and every variant is compared with the first one:
+// the relative difference of the means and its significance (Welch's t-test, see bench::Compare()).
+//
+// Example:
+//   Bench_Variants --variants=Bench_VariableLookup,Bench_VariableLookup_Std,Bench_VariableLookup_Legacy --rounds=5 -- --op=lookup,set --scopes=10
+
+
+#define BENCH_ROUNDS        3       // default for --rounds
+#define BENCH_THRESHOLD     0.02    // default for --threshold
+#define BENCH_ALPHA         0.05    // default for --alpha
+
+
+#include "../Common/BenchCore.hpp"
+#include "../Common/BenchCmdLine.hpp"
+#include "../Common/BenchReport.hpp"
+
+#include <cstdio>
+#include <cstdlib> // EXIT_SUCCESS
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+
+namespace {
+
+struct Variant
+{
+    std::string                           exe;
+    std::string                           name;      // the file name without extension.
+    std::map<std::string, bench::Record>  records;   // the merged records of all rounds by key.
+    std::vector<std::string>              order;     // the keys in the order of the first run.
+    int                                   failed = 0;
+};
+
+std::string key_of( bench::Record const &r )
+{
+    return r.benchmark + " | " + bench::detail::ParamsToString( r.params ) + " | " + r.engine + " | " + r.title;
+}
+
+std::string shell_quote( std::string const &s )
+{
+#if defined( _WIN32 )
+    return '"' + s + '"';
+#else
+    std::string  res = "'";
+    for( char const c : s ) {
+        if( c == '\'' ) {
+            res += "'\\''";
+        } else {
+            res += c;
+        }
+    }
+    return res + '\'';
+#endif
+}
+
+// the path of the executable, it is searched as given and next to this executable.
+std::string find_executable( std::string const &name, std::filesystem::path const &self_dir )
+{
+    namespace fs = std::filesystem;
+    std::error_code  ec;
+    std::vector<fs::path>  candidates{ fs::path( name ), self_dir / name };
+#if defined( _WIN32 )
+    candidates.push_back( fs::path( name + ".exe" ) );
+    candidates.push_back( self_dir / (name + ".exe") );
+#endif
+    for( auto const &p : candidates ) {
+        if( fs::is_regular_file( p, ec ) ) {
+            return fs::absolute( p, ec ).string();
+        }
+    }
+    return name; // let the shell search it in the PATH.
+}
+
+// runs the variant once and merges its results. returns false if no results were written.
+bool run_variant( Variant &v, std::vector<std::string> const &args, std::string const &json, bool const keep )
+{
+    std::string  command = shell_quote( v.exe );
+    for( auto const &arg : args ) {
+        command += ' ' + shell_quote( arg );
+    }
+    command += ' ' + shell_quote( "--json=" + json );
+#if defined( _WIN32 )
+    command = '"' + command + '"'; // cmd.exe strips the outer quotes.
+#endif
+
+    // a file of a former invocation (e.g. with --keep) must not be taken as result if the variant fails.
+    std::error_code  ec;
+    std::filesystem::remove( json, ec );
+
+    std::cout << "\n=== " << v.name << " ===" << std::endl;
+    fflush( stdout );
+    int const status = std::system( command.c_str() );
+
+    if( !std::filesystem::exists( json, ec ) ) {
+        std::cout << "NOTE: " << v.name << " wrote no results (exit status " << status << ")." << std::endl;
+        ++v.failed;
+        return false;
+    }
+    if( status != 0 ) {
+        std::cout << "NOTE: " << v.name << " exit status " << status << " (some tests failed)." << std::endl;
+    }
+    try {
+        for( auto &r : bench::LoadJson( json ) ) {
+            auto key = key_of( r );
+            auto const it = v.records.find( key );
+            if( it == v.records.end() ) {
+                v.order.push_back( key );
+                v.records.emplace( std::move( key ), std::move( r ) );
+                continue;
+            }
+            auto &samples = it->second.result.samples;
+            samples.insert( samples.end(), r.result.samples.begin(), r.result.samples.end() );
+        }
+    } catch( std::exception const &ex ) {
+        std::cout << ex.what() << std::endl;
+        ++v.failed;
+        return false;
+    }
+    if( !keep ) {
+        std::filesystem::remove( json, ec );
+    }
+    return true;
+}
+
+void print_comparison( std::vector<Variant> const &variants, double const threshold, double const alpha )
+{
+    auto const &base = variants.front();
+    std::size_t  width = 8;
+    for( auto const &v : variants ) {
+        width = std::max( width, v.name.size() + 2 );
+    }
+
+    std::cout << "\n\nComparison of the variants with " << base.name << " (mean of all rounds, threshold: " << std::setprecision( 2 )
+              << threshold * 100.0 << " %, alpha: " << alpha << ")\n";
+    for( auto const &v : variants ) {
+        for( auto const &[key, rec] : v.records ) {
+            if( !rec.engine_version.empty() ) {
+                std::cout << std::left << std::setw( static_cast<int>(width) ) << v.name << std::right << rec.engine << ' ' << rec.engine_version << '\n';
+                break;
+            }
+        }
+    }
+
+    int significant = 0;
+    for( auto const &key : base.order ) {
+        auto const &b = base.records.at( key );
+        std::cout << '\n' << key << '\n';
+        std::cout << std::left << std::setw( static_cast<int>(width) ) << "variant" << std::right << "       mean [s]   runs     change         t\n";
+        for( auto const &v : variants ) {
+            std::cout << std::left << std::setw( static_cast<int>(width) ) << v.name << std::right;
+            auto const it = v.records.find( key );
+            if( it == v.records.end() ) {
+                std::cout << "        missing\n";
+                continue;
+            }
+            auto const &s = it->second.result.stats;
+            std::cout << std::setprecision( 8 ) << std::setw( 15 ) << s.mean << std::setw( 7 ) << s.count;
+            if( &v == &base ) {
+                std::cout << "   baseline\n";
+                continue;
+            }
+            auto const c = bench::Compare( b.result.stats, s, threshold, alpha );
+            std::cout << std::showpos << std::setprecision( 2 ) << std::setw( 10 ) << c.rel_change * 100.0 << " %" << std::noshowpos
+                      << std::setw( 10 ) << c.t;
+            if( c.verdict == bench::Comparison::eVerdict::Regression ) {
+                std::cout << "  slower (significant)";
+                ++significant;
+            } else if( c.verdict == bench::Comparison::eVerdict::Improvement ) {
+                std::cout << "  faster (significant)";
+                ++significant;
+            }
+            std::cout << '\n';
+        }
+    }
+    std::cout << '\n' << significant << " significant difference(s)." << std::endl;
+}
+
+void print_usage()
+{
+    std::cout << "usage: Bench_Variants --variants=exe1,exe2,... [options] -- [options of the benchmarks]\n"
+                 "  --variants=a,b,... the executables of the build variants, the first is the baseline\n"
+                 "  --rounds=N         count of interleaved rounds (default: " << BENCH_ROUNDS << ")\n"
+                 "  --threshold=X      minimum relative change of the mean to be flagged (default: " << BENCH_THRESHOLD << ")\n"
+                 "  --alpha=X          significance level of the t-test (default: " << BENCH_ALPHA << ")\n"
+                 "  --json=FILE        write the merged results of all variants as JSON (with the parameter variant)\n"
+                 "  --keep             keep the JSON files of the single runs (Bench_Variants.<variant>.<round>.json)\n";
+}
+
+} // namespace
+
+
+int main( int argc, char *argv[] )
+{
+    std::cout << std::fixed;
+    std::cout << std::setprecision( 8 );
+
+    // the options before -- are for this runner, the remaining are passed to the variants.
+    int sep = 1;
+    while( sep < argc && std::string_view( argv[sep] ) != "--" ) {
+        ++sep;
+    }
+    bench::CmdLine const      cmd( sep, argv );
+    std::vector<std::string>  args( argv + std::min( sep + 1, argc ), argv + argc );
+
+    if( cmd.Has( "help" ) || !cmd.Has( "variants" ) ) {
+        print_usage();
+        return cmd.Has( "help" ) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    auto const self_dir = std::filesystem::absolute( std::filesystem::path( argv[0] ) ).parent_path();
+    std::vector<Variant>  variants;
+    for( auto const &name : cmd.GetList( "variants" ) ) {
+        Variant  v;
+        v.exe  = find_executable( name, self_dir );
+        v.name = std::filesystem::path( name ).stem().string();
+        variants.push_back( std::move( v ) );
+    }
+    if( variants.size() < 2 ) {
+        std::cout << "At least 2 variants are needed!" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    auto const rounds = std::max( cmd.GetInt( "rounds", BENCH_ROUNDS ), 1LL );
+    bool const keep   = cmd.Has( "keep" );
+    for( long long round = 0; round < rounds; ++round ) {
+        std::cout << "\n##### round " << round + 1 << " of " << rounds << " #####" << std::endl;
+        for( std::size_t i = 0; i < variants.size(); ++i ) {
+            auto &v = variants[(i + static_cast<std::size_t>(round)) % variants.size()];
+            run_variant( v, args, "Bench_Variants." + v.name + '.' + std::to_string( round ) + ".json", keep );
+        }
+    }
+
+    std::vector<bench::Record>  merged;
+    for( auto &v : variants ) {
+        for( auto const &key : v.order ) {
+            auto &r = v.records.at( key );
+            r.result.stats = bench::CalcStats( r.result.samples );
+            merged.push_back( r );
+            merged.back().params.emplace_back( "variant", v.name );
+        }
+    }
+    if( variants.front().records.empty() ) {
+        std::cout << "No results of the baseline " << variants.front().name << '!' << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    print_comparison( variants, cmd.GetDouble( "threshold", BENCH_THRESHOLD ), cmd.GetDouble( "alpha", BENCH_ALPHA ) );
+
+    int res = EXIT_SUCCESS;
+    if( cmd.Has( "json" ) && !bench::WriteJson( cmd.Get( "json" ), merged ) ) {
+        res = EXIT_FAILURE;
+    }
+    for( auto const &v : variants ) {
+        if( v.failed > 0 ) {
+            std::cout << "NOTE: " << v.failed << " run(s) of " << v.name << " failed." << std::endl;
+        }
+    }
+    cmd.WarnUnused();
+
+    puts( "\n\nTest end." );
+
+    return res;
+}
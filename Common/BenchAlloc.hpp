@@ -0,0 +1,476 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (C) 2024 Florian Thake, <contact |at| tea-age.solutions>.
+ * SPDX-License-Identifier: MIT
+ */
+#pragma once
+
+// Heap allocation accounting for the measured region.
+//
+// Enabled with --alloc. The global operator new / delete are replaced (and with glibc also malloc, calloc, realloc,
+// free and the aligned variants, so allocations of C libraries and custom allocators are seen as well).
+// During the measured region (see bench::RegionHook) the count of allocations / frees, the allocated bytes and
+// the live bytes at the end and the peak of the live bytes (both relative to the start of the region) of all threads
+// are counted.
+// The bytes are the usable sizes reported by the allocator, so they include its rounding.
+// Independent of --alloc a HeapScope measures the retained heap bytes of a scope (e.g. the memory of an object),
+// ResidentBytes() returns the resident set size of the process (see BenchAllocators.hpp).
+// The replacement of operator new dispatches to the allocator selected via --allocator (see BenchAllocators.hpp).
+// NOTE: The counting itself costs some time in the measured region, so compare timings only without --alloc.
+//
+// The replacements must exist exactly once in a program. The main translation unit defines
+// BENCH_ALLOC_IMPLEMENTATION before including this header (or BenchMain.hpp).
+// Define BENCH_ALLOC_HOOKS as 0 for build without any replacement.
+
+
+#include "BenchAllocators.hpp"
+#include "BenchCore.hpp"
+#include "BenchCmdLine.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <new>
+
+#if defined( _MSC_VER )
+# include <malloc.h>   // _msize
+#elif defined( __APPLE__ )
+# include <malloc/malloc.h> // malloc_size
+#else
+# include <malloc.h>   // malloc_usable_size
+#endif
+
+#if !defined BENCH_ALLOC_HOOKS
+# define BENCH_ALLOC_HOOKS  1
+#endif
+
+// with glibc the malloc family can be replaced as well (the originals are available as __libc_*).
+#if !defined BENCH_ALLOC_INTERPOSE_MALLOC
+# if defined( __GLIBC__ )
+#  define BENCH_ALLOC_INTERPOSE_MALLOC  1
+# else
+#  define BENCH_ALLOC_INTERPOSE_MALLOC  0
+# endif
+#endif
+
+
+namespace bench {
+
+namespace detail {
+
+struct AllocCounters
+{
+    std::atomic<bool>           active{ false };
+    std::atomic<std::uint64_t>  allocs{ 0 };
+    std::atomic<std::uint64_t>  frees{ 0 };
+    std::atomic<std::uint64_t>  bytes{ 0 };
+    std::atomic<std::int64_t>   live{ 0 };
+    std::atomic<std::int64_t>   peak{ 0 };
+    // for HeapScope, counted while at least one scope exists and never reset.
+    std::atomic<int>            scopes{ 0 };
+    std::atomic<std::uint64_t>  scope_allocs{ 0 };
+    std::atomic<std::int64_t>   scope_live{ 0 };
+};
+
+inline AllocCounters &GetAllocCounters() noexcept
+{
+    static AllocCounters  counters; // constant initialized, usable before main.
+    return counters;
+}
+
+/// true if the replacements are linked into the program.
+inline bool &AllocHooksInstalled() noexcept
+{
+    static bool  installed = false;
+    return installed;
+}
+
+inline void OnAlloc( std::size_t const size ) noexcept
+{
+    auto &c = GetAllocCounters();
+    if( c.scopes.load( std::memory_order_relaxed ) > 0 ) {
+        c.scope_allocs.fetch_add( 1, std::memory_order_relaxed );
+        c.scope_live.fetch_add( static_cast<std::int64_t>(size), std::memory_order_relaxed );
+    }
+    if( !c.active.load( std::memory_order_relaxed ) ) {
+        return;
+    }
+    c.allocs.fetch_add( 1, std::memory_order_relaxed );
+    c.bytes.fetch_add( size, std::memory_order_relaxed );
+    auto const live = c.live.fetch_add( static_cast<std::int64_t>(size), std::memory_order_relaxed ) + static_cast<std::int64_t>(size);
+    auto peak = c.peak.load( std::memory_order_relaxed );
+    while( live > peak && !c.peak.compare_exchange_weak( peak, live, std::memory_order_relaxed ) ) {
+    }
+}
+
+inline void OnFree( std::size_t const size ) noexcept
+{
+    auto &c = GetAllocCounters();
+    if( c.scopes.load( std::memory_order_relaxed ) > 0 ) {
+        c.scope_live.fetch_sub( static_cast<std::int64_t>(size), std::memory_order_relaxed );
+    }
+    if( !c.active.load( std::memory_order_relaxed ) ) {
+        return;
+    }
+    c.frees.fetch_add( 1, std::memory_order_relaxed );
+    c.live.fetch_sub( static_cast<std::int64_t>(size), std::memory_order_relaxed );
+}
+
+} // namespace detail
+
+
+/// RegionHook which counts the heap allocations of the measured region.
+class AllocTracker : public RegionHook
+{
+    std::uint64_t  mAllocs = 0;
+    std::uint64_t  mFrees  = 0;
+    std::uint64_t  mBytes  = 0;
+    std::int64_t   mLive   = 0;   // live bytes at the end of the regions
+    std::int64_t   mPeak   = 0;
+
+public:
+    void OnStart() override
+    {
+        auto &c = detail::GetAllocCounters();
+        c.allocs.store( 0, std::memory_order_relaxed );
+        c.frees.store( 0, std::memory_order_relaxed );
+        c.bytes.store( 0, std::memory_order_relaxed );
+        c.live.store( 0, std::memory_order_relaxed );
+        c.peak.store( 0, std::memory_order_relaxed );
+        c.active.store( true, std::memory_order_seq_cst );
+    }
+
+    void OnStop() override
+    {
+        auto &c = detail::GetAllocCounters();
+        c.active.store( false, std::memory_order_seq_cst );
+        mAllocs += c.allocs.load( std::memory_order_relaxed );
+        mFrees  += c.frees.load( std::memory_order_relaxed );
+        mBytes  += c.bytes.load( std::memory_order_relaxed );
+        mLive   += c.live.load( std::memory_order_relaxed );
+        mPeak    = std::max( mPeak, c.peak.load( std::memory_order_relaxed ) );
+    }
+
+    void Collect( Metrics &rMetrics ) override
+    {
+        rMetrics.emplace_back( "allocs", static_cast<double>(mAllocs) );
+        rMetrics.emplace_back( "alloc-bytes", static_cast<double>(mBytes) );
+        rMetrics.emplace_back( "frees", static_cast<double>(mFrees) );
+        rMetrics.emplace_back( "live-bytes", static_cast<double>(mLive) );
+        rMetrics.emplace_back( "peak-live-bytes", static_cast<double>(mPeak) );
+        mAllocs = mFrees = mBytes = 0;
+        mLive = mPeak = 0;
+    }
+};
+
+
+/// Measures the allocations and the retained heap bytes from its construction on (e.g. for the memory of an object).
+/// Works independent of --alloc, nested and together with the AllocTracker. The allocations of all threads are counted.
+class HeapScope
+{
+    std::uint64_t  mAllocs = 0;
+    std::int64_t   mLive   = 0;
+
+public:
+    HeapScope() noexcept
+    {
+        auto &c = detail::GetAllocCounters();
+        c.scopes.fetch_add( 1, std::memory_order_seq_cst );
+        mAllocs = c.scope_allocs.load( std::memory_order_relaxed );
+        mLive   = c.scope_live.load( std::memory_order_relaxed );
+    }
+
+    ~HeapScope()
+    {
+        detail::GetAllocCounters().scopes.fetch_sub( 1, std::memory_order_seq_cst );
+    }
+
+    HeapScope( HeapScope const & ) = delete;
+    HeapScope &operator=( HeapScope const & ) = delete;
+
+    /// false if the replacements are not built in (then all values are 0).
+    static bool Available() noexcept { return detail::AllocHooksInstalled(); }
+
+    /// count of allocations since the construction.
+    std::uint64_t Allocs() const noexcept
+    {
+        return detail::GetAllocCounters().scope_allocs.load( std::memory_order_relaxed ) - mAllocs;
+    }
+
+    /// bytes allocated and not freed since the construction (negative if more older memory was freed).
+    std::int64_t LiveBytes() const noexcept
+    {
+        return detail::GetAllocCounters().scope_live.load( std::memory_order_relaxed ) - mLive;
+    }
+};
+
+/// enables the allocation accounting if requested via --alloc. returns false if not available.
+inline bool EnableAllocTracking( CmdLine const &cmd )
+{
+    if( !cmd.Has( "alloc" ) ) {
+        return false;
+    }
+    if( !detail::AllocHooksInstalled() ) {
+        std::cout << "NOTE: allocation hooks are not built in (BENCH_ALLOC_HOOKS), continuing without." << std::endl;
+        return false;
+    }
+    std::cout << "NOTE: allocation accounting is enabled, the timings include its overhead." << std::endl;
+    AddRegionHook( std::make_unique<AllocTracker>() );
+    return true;
+}
+
+} // namespace bench
+
+
+#if defined BENCH_ALLOC_IMPLEMENTATION && BENCH_ALLOC_HOOKS
+
+#if BENCH_ALLOC_INTERPOSE_MALLOC
+extern "C" {
+void *__libc_malloc( std::size_t );
+void *__libc_calloc( std::size_t, std::size_t );
+void *__libc_realloc( void *, std::size_t );
+void *__libc_memalign( std::size_t, std::size_t );
+void  __libc_free( void * );
+}
+#endif
+
+namespace bench::detail {
+
+static bool const alloc_hooks_installed = (AllocHooksInstalled() = true);
+static bool const allocator_dispatch_installed = (AllocatorDispatchInstalled() = true);
+
+inline std::size_t UsableSize( void *p ) noexcept
+{
+#if defined( _MSC_VER )
+    return _msize( p );
+#elif defined( __APPLE__ )
+    return malloc_size( p );
+#else
+    return malloc_usable_size( p );
+#endif
+}
+
+inline void *RawMalloc( std::size_t const size ) noexcept
+{
+#if BENCH_ALLOC_INTERPOSE_MALLOC
+    return __libc_malloc( size );
+#else
+    return std::malloc( size );
+#endif
+}
+
+inline void *RawAlignedMalloc( std::size_t const size, std::size_t const align ) noexcept
+{
+#if BENCH_ALLOC_INTERPOSE_MALLOC
+    return __libc_memalign( align, size );
+#elif defined( _MSC_VER )
+    return _aligned_malloc( size, align );
+#else
+    void *p = nullptr;
+    return posix_memalign( &p, std::max( align, sizeof( void * ) ), size ) == 0 ? p : nullptr;
+#endif
+}
+
+inline void RawFree( void *p ) noexcept
+{
+#if BENCH_ALLOC_INTERPOSE_MALLOC
+    __libc_free( p );
+#else
+    std::free( p );
+#endif
+}
+
+inline void *CountedNew( std::size_t size ) noexcept
+{
+    std::size_t usable = 0;
+    if( void *p = AllocatorNew( size, usable ); p != nullptr ) {
+        OnAlloc( usable );
+        return p;
+    }
+    void *p = RawMalloc( size == 0 ? 1 : size );
+    if( p != nullptr ) {
+        OnAlloc( UsableSize( p ) );
+    }
+    return p;
+}
+
+inline void *CountedAlignedNew( std::size_t size, std::align_val_t const al ) noexcept
+{
+    void *p = RawAlignedMalloc( size == 0 ? 1 : size, static_cast<std::size_t>(al) );
+    if( p != nullptr ) {
+#if defined( _MSC_VER ) && !BENCH_ALLOC_INTERPOSE_MALLOC
+        OnAlloc( _aligned_msize( p, static_cast<std::size_t>(al), 0 ) );
+#else
+        OnAlloc( UsableSize( p ) );
+#endif
+    }
+    return p;
+}
+
+inline void CountedDelete( void *p ) noexcept
+{
+    if( InRegion( p ) ) {
+        OnFree( AllocatorDelete( p ) );
+        return;
+    }
+    if( p != nullptr ) {
+        OnFree( UsableSize( p ) );
+        RawFree( p );
+    }
+}
+
+inline void CountedAlignedDelete( void *p, [[maybe_unused]] std::align_val_t const al ) noexcept
+{
+    if( p != nullptr ) {
+#if defined( _MSC_VER ) && !BENCH_ALLOC_INTERPOSE_MALLOC
+        OnFree( _aligned_msize( p, static_cast<std::size_t>(al), 0 ) );
+        _aligned_free( p );
+#else
+        OnFree( UsableSize( p ) );
+        RawFree( p );
+#endif
+    }
+}
+
+} // namespace bench::detail
+
+
+void *operator new( std::size_t size )
+{
+    if( void *p = bench::detail::CountedNew( size ); p != nullptr ) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void *operator new[]( std::size_t size )
+{
+    return ::operator new( size );
+}
+
+void *operator new( std::size_t size, std::nothrow_t const & ) noexcept
+{
+    return bench::detail::CountedNew( size );
+}
+
+void *operator new[]( std::size_t size, std::nothrow_t const & ) noexcept
+{
+    return bench::detail::CountedNew( size );
+}
+
+void *operator new( std::size_t size, std::align_val_t al )
+{
+    if( void *p = bench::detail::CountedAlignedNew( size, al ); p != nullptr ) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void *operator new[]( std::size_t size, std::align_val_t al )
+{
+    return ::operator new( size, al );
+}
+
+void *operator new( std::size_t size, std::align_val_t al, std::nothrow_t const & ) noexcept
+{
+    return bench::detail::CountedAlignedNew( size, al );
+}
+
+void *operator new[]( std::size_t size, std::align_val_t al, std::nothrow_t const & ) noexcept
+{
+    return bench::detail::CountedAlignedNew( size, al );
+}
+
+void operator delete( void *p ) noexcept { bench::detail::CountedDelete( p ); }
+void operator delete[]( void *p ) noexcept { bench::detail::CountedDelete( p ); }
+void operator delete( void *p, std::size_t ) noexcept { bench::detail::CountedDelete( p ); }
+void operator delete[]( void *p, std::size_t ) noexcept { bench::detail::CountedDelete( p ); }
+void operator delete( void *p, std::nothrow_t const & ) noexcept { bench::detail::CountedDelete( p ); }
+void operator delete[]( void *p, std::nothrow_t const & ) noexcept { bench::detail::CountedDelete( p ); }
+void operator delete( void *p, std::align_val_t al ) noexcept { bench::detail::CountedAlignedDelete( p, al ); }
+void operator delete[]( void *p, std::align_val_t al ) noexcept { bench::detail::CountedAlignedDelete( p, al ); }
+void operator delete( void *p, std::size_t, std::align_val_t al ) noexcept { bench::detail::CountedAlignedDelete( p, al ); }
+void operator delete[]( void *p, std::size_t, std::align_val_t al ) noexcept { bench::detail::CountedAlignedDelete( p, al ); }
+void operator delete( void *p, std::align_val_t al, std::nothrow_t const & ) noexcept { bench::detail::CountedAlignedDelete( p, al ); }
+void operator delete[]( void *p, std::align_val_t al, std::nothrow_t const & ) noexcept { bench::detail::CountedAlignedDelete( p, al ); }
+
+
+#if BENCH_ALLOC_INTERPOSE_MALLOC
+extern "C" {
+
+void *malloc( std::size_t size ) noexcept
+{
+    void *p = __libc_malloc( size );
+    if( p != nullptr ) {
+        bench::detail::OnAlloc( malloc_usable_size( p ) );
+    }
+    return p;
+}
+
+void *calloc( std::size_t n, std::size_t size ) noexcept
+{
+    void *p = __libc_calloc( n, size );
+    if( p != nullptr ) {
+        bench::detail::OnAlloc( malloc_usable_size( p ) );
+    }
+    return p;
+}
+
+void *realloc( void *old, std::size_t size ) noexcept
+{
+    std::size_t const old_size = old != nullptr ? malloc_usable_size( old ) : 0;
+    void *p = __libc_realloc( old, size );
+    if( p != nullptr || size == 0 ) {
+        if( old != nullptr ) {
+            bench::detail::OnFree( old_size );
+        }
+        if( p != nullptr ) {
+            bench::detail::OnAlloc( malloc_usable_size( p ) );
+        }
+    }
+    return p;
+}
+
+void *memalign( std::size_t align, std::size_t size ) noexcept
+{
+    void *p = __libc_memalign( align, size );
+    if( p != nullptr ) {
+        bench::detail::OnAlloc( malloc_usable_size( p ) );
+    }
+    return p;
+}
+
+void *aligned_alloc( std::size_t align, std::size_t size ) noexcept
+{
+    return memalign( align, size );
+}
+
+int posix_memalign( void **pp, std::size_t align, std::size_t size ) noexcept
+{
+    if( align < sizeof( void * ) || (align & (align - 1)) != 0 ) {
+        return EINVAL;
+    }
+    void *p = memalign( align, size );
+    if( p == nullptr ) {
+        return ENOMEM;
+    }
+    *pp = p;
+    return 0;
+}
+
+void free( void *p ) noexcept
+{
+    if( p != nullptr ) {
+        bench::detail::OnFree( malloc_usable_size( p ) );
+        __libc_free( p );
+    }
+}
+
+} // extern "C"
+#endif // BENCH_ALLOC_INTERPOSE_MALLOC
+
+#endif // BENCH_ALLOC_IMPLEMENTATION
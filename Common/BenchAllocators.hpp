@@ -0,0 +1,408 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (C) 2024 Florian Thake, <contact |at| tea-age.solutions>.
+ * SPDX-License-Identifier: MIT
+ */
+#pragma once
+
+// Alternative allocators for the global operator new (see BenchAlloc.hpp) and the resident set size.
+//
+// With --allocator=system,arena,pool each test runs once per allocator (see bench::Suite):
+//   system - the malloc of the C runtime.
+//   arena  - a bump allocator per thread, delete is a no-op. Between the runs the arenas are rewound (if nothing is alive).
+//   pool   - a free list per size class (16 bytes steps up to 512 bytes) per thread.
+// The arenas and pools take their memory in chunks of 1 MB from one reserved address range, so every delete can find
+// the owner of a pointer independent of the current allocator. Allocations which are too big (or over-aligned) and
+// the malloc family of C always use the system allocator.
+// The memory of the chunks is never returned to the OS (like most of such allocators in production).
+
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#if defined( _WIN32 )
+# if !defined NOMINMAX
+#  define NOMINMAX
+# endif
+# if !defined WIN32_LEAN_AND_MEAN
+#  define WIN32_LEAN_AND_MEAN
+# endif
+# include <windows.h>
+# include <psapi.h>    // GetProcessMemoryInfo
+#elif defined( __APPLE__ )
+# include <mach/mach.h>
+# include <sys/mman.h>
+#elif defined( __linux__ )
+# include <fcntl.h>
+# include <sys/mman.h>
+# include <unistd.h>
+#endif
+
+
+namespace bench {
+
+enum class eAllocator { System, Arena, Pool };
+
+inline char const *AllocatorName( eAllocator const a ) noexcept
+{
+    switch( a ) {
+    case eAllocator::Arena: return "arena";
+    case eAllocator::Pool:  return "pool";
+    default:                return "system";
+    }
+}
+
+/// parses the name of an allocator, returns false if unknown.
+inline bool ParseAllocator( std::string const &name, eAllocator &rAllocator ) noexcept
+{
+    for( auto const a : { eAllocator::System, eAllocator::Arena, eAllocator::Pool } ) {
+        if( name == AllocatorName( a ) ) {
+            rAllocator = a;
+            return true;
+        }
+    }
+    return false;
+}
+
+namespace detail {
+
+constexpr std::size_t    kChunkSize   = std::size_t( 1 ) << 20;     // 1 MB
+constexpr std::size_t    kChunkCount  = 16 * 1024;                  // 16 GB of address space (only reserved)
+constexpr std::size_t    kAllocAlign  = 16;
+constexpr std::size_t    kArenaMax    = kChunkSize / 4;             // bigger allocations go to the system allocator.
+constexpr std::size_t    kPoolClasses = 32;                         // 16, 32, ..., 512 bytes
+constexpr std::size_t    kPoolMax     = kPoolClasses * kAllocAlign;
+constexpr int            kMaxHeaps    = 256;                        // max threads with an own arena / pool at the same time.
+constexpr std::uint32_t  kNoChunk     = 0xFFFFFFFFu;
+
+struct Heap;
+
+struct ChunkInfo
+{
+    Heap          *owner      = nullptr;
+    std::uint32_t  next       = kNoChunk;   // the next chunk of an arena
+    std::uint32_t  size_class = 0;          // of a pool chunk
+    bool           arena      = false;
+};
+
+/// the arena and the pools of one thread (the memory is adopted by the next thread after the thread ended).
+struct Heap
+{
+    std::atomic<bool>          used{ false };
+    // arena
+    std::uint32_t              arena_first = kNoChunk;
+    std::uint32_t              arena_cur   = kNoChunk;
+    char                      *arena_ptr   = nullptr;
+    char                      *arena_end   = nullptr;
+    std::uint64_t              arena_allocs = 0;
+    std::uint64_t              arena_frees  = 0;
+    std::atomic<std::uint64_t> arena_remote_frees{ 0 };  // from other threads
+    // pool
+    void                      *free_list[kPoolClasses] = {};
+    char                      *pool_ptr[kPoolClasses]  = {};
+    char                      *pool_end[kPoolClasses]  = {};
+};
+
+struct Region
+{
+    char                        *base = nullptr;
+    std::atomic<bool>            reserved{ false };
+    std::atomic<std::uint32_t>   next_chunk{ 0 };
+    ChunkInfo                    chunks[kChunkCount];
+    Heap                         heaps[kMaxHeaps];
+};
+
+inline Region &GetRegion() noexcept
+{
+    static Region  region; // constant initialized, usable before main.
+    return region;
+}
+
+/// true if the replacement of operator new dispatches to the allocators (set by BenchAlloc.hpp).
+inline bool &AllocatorDispatchInstalled() noexcept
+{
+    static bool  installed = false;
+    return installed;
+}
+
+inline std::atomic<int> &ActiveAllocator() noexcept
+{
+    static std::atomic<int>  active{ 0 };
+    return active;
+}
+
+inline bool ReserveRegion() noexcept
+{
+    auto &r = GetRegion();
+    if( r.reserved.load( std::memory_order_acquire ) ) {
+        return r.base != nullptr;
+    }
+#if defined( _WIN32 )
+    r.base = static_cast<char *>(VirtualAlloc( nullptr, kChunkSize * kChunkCount, MEM_RESERVE, PAGE_NOACCESS ));
+#elif defined( __linux__ ) || defined( __APPLE__ )
+    int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+# if defined( MAP_NORESERVE )
+    flags |= MAP_NORESERVE;
+# endif
+    void *p = mmap( nullptr, kChunkSize * kChunkCount, PROT_READ | PROT_WRITE, flags, -1, 0 );
+    r.base  = p == MAP_FAILED ? nullptr : static_cast<char *>(p);
+#endif
+    r.reserved.store( true, std::memory_order_release );
+    return r.base != nullptr;
+}
+
+inline bool InRegion( void const *p ) noexcept
+{
+    auto const &r = GetRegion();
+    return r.base != nullptr && p >= r.base && p < r.base + kChunkSize * kChunkCount;
+}
+
+inline std::uint32_t ChunkIndex( void const *p ) noexcept
+{
+    return static_cast<std::uint32_t>(static_cast<std::size_t>(static_cast<char const *>(p) - GetRegion().base) / kChunkSize);
+}
+
+inline char *ChunkBase( std::uint32_t const idx ) noexcept
+{
+    return GetRegion().base + static_cast<std::size_t>(idx) * kChunkSize;
+}
+
+inline std::uint32_t ClaimChunk( Heap &h, bool const arena, std::uint32_t const size_class ) noexcept
+{
+    auto &r = GetRegion();
+    auto const idx = r.next_chunk.fetch_add( 1, std::memory_order_relaxed );
+    if( idx >= kChunkCount ) {
+        return kNoChunk;
+    }
+#if defined( _WIN32 )
+    if( VirtualAlloc( ChunkBase( idx ), kChunkSize, MEM_COMMIT, PAGE_READWRITE ) == nullptr ) {
+        return kNoChunk;
+    }
+#endif
+    r.chunks[idx] = ChunkInfo{ &h, kNoChunk, size_class, arena };
+    return idx;
+}
+
+struct HeapHolder
+{
+    Heap  *heap = nullptr;
+    bool   dead = false;
+
+    ~HeapHolder()
+    {
+        if( heap != nullptr ) {
+            heap->used.store( false, std::memory_order_release );
+        }
+        heap = nullptr;
+        dead = true;
+    }
+};
+
+/// the heap of the calling thread or nullptr (then the system allocator is used).
+inline Heap *CurrentHeap() noexcept
+{
+    thread_local HeapHolder  holder;
+    if( holder.heap == nullptr && !holder.dead ) {
+        for( auto &h : GetRegion().heaps ) {
+            bool expected = false;
+            if( h.used.compare_exchange_strong( expected, true, std::memory_order_acquire ) ) {
+                holder.heap = &h;
+                break;
+            }
+        }
+    }
+    return holder.heap;
+}
+
+inline void *ArenaAlloc( Heap &h, std::size_t const size, std::size_t &rUsable ) noexcept
+{
+    // a header in front of each block with its size (for the accounting).
+    auto const need = (size + kAllocAlign + kAllocAlign - 1) & ~(kAllocAlign - 1);
+    if( need > kArenaMax ) {
+        return nullptr;
+    }
+    if( h.arena_ptr == nullptr || static_cast<std::size_t>(h.arena_end - h.arena_ptr) < need ) {
+        // the next chunk: the chain is reused after a reset, otherwise a new one is claimed.
+        auto &r = GetRegion();
+        auto next = h.arena_cur == kNoChunk ? h.arena_first : r.chunks[h.arena_cur].next;
+        if( next == kNoChunk ) {
+            next = ClaimChunk( h, true, 0 );
+            if( next == kNoChunk ) {
+                return nullptr;
+            }
+            if( h.arena_cur == kNoChunk ) {
+                h.arena_first = next;
+            } else {
+                r.chunks[h.arena_cur].next = next;
+            }
+        }
+        h.arena_cur = next;
+        h.arena_ptr = ChunkBase( next );
+        h.arena_end = h.arena_ptr + kChunkSize;
+    }
+    auto *p = h.arena_ptr;
+    h.arena_ptr += need;
+    ++h.arena_allocs;
+    *reinterpret_cast<std::size_t *>(p) = need;
+    rUsable = need - kAllocAlign;
+    return p + kAllocAlign;
+}
+
+inline void *PoolAlloc( Heap &h, std::size_t const size, std::size_t &rUsable ) noexcept
+{
+    auto const c = size == 0 ? 0 : (size - 1) / kAllocAlign;
+    if( c >= kPoolClasses ) {
+        return nullptr;
+    }
+    auto const block = (c + 1) * kAllocAlign;
+    rUsable = block;
+    if( void *p = h.free_list[c]; p != nullptr ) {
+        h.free_list[c] = *static_cast<void **>(p);
+        return p;
+    }
+    if( h.pool_ptr[c] == nullptr || static_cast<std::size_t>(h.pool_end[c] - h.pool_ptr[c]) < block ) {
+        auto const idx = ClaimChunk( h, false, static_cast<std::uint32_t>(c) );
+        if( idx == kNoChunk ) {
+            return nullptr;
+        }
+        h.pool_ptr[c] = ChunkBase( idx );
+        h.pool_end[c] = h.pool_ptr[c] + kChunkSize;
+    }
+    auto *p = h.pool_ptr[c];
+    h.pool_ptr[c] += block;
+    return p;
+}
+
+/// allocates with the active allocator. returns nullptr if the system allocator must be used.
+inline void *AllocatorNew( std::size_t const size, std::size_t &rUsable ) noexcept
+{
+    auto const mode = static_cast<eAllocator>(ActiveAllocator().load( std::memory_order_relaxed ));
+    if( mode == eAllocator::System ) {
+        return nullptr;
+    }
+    auto *h = CurrentHeap();
+    if( h == nullptr ) {
+        return nullptr;
+    }
+    return mode == eAllocator::Arena ? ArenaAlloc( *h, size, rUsable ) : PoolAlloc( *h, size, rUsable );
+}
+
+/// frees a block of the arenas or pools (InRegion( p ) must be true), returns its usable size.
+inline std::size_t AllocatorDelete( void *p ) noexcept
+{
+    auto const &info = GetRegion().chunks[ChunkIndex( p )];
+    if( info.arena ) {
+        auto const size = *reinterpret_cast<std::size_t const *>(static_cast<char *>(p) - kAllocAlign);
+        if( info.owner == CurrentHeap() ) {
+            ++info.owner->arena_frees;
+        } else {
+            info.owner->arena_remote_frees.fetch_add( 1, std::memory_order_relaxed );
+        }
+        return size - kAllocAlign;
+    }
+    auto const c = info.size_class;
+    // the block goes to the pool of the calling thread (it is lost if the thread has no heap).
+    if( auto *h = CurrentHeap(); h != nullptr ) {
+        *static_cast<void **>(p) = h->free_list[c];
+        h->free_list[c] = p;
+    }
+    return (c + 1) * kAllocAlign;
+}
+
+} // namespace detail
+
+
+/// true if the arena and pool allocators can be used (the replacement of operator new is built in).
+inline bool AllocatorsAvailable() noexcept
+{
+    return detail::AllocatorDispatchInstalled() && detail::ReserveRegion();
+}
+
+/// sets the allocator of operator new for all threads. the memory of all allocators can be deleted in every mode.
+/// returns false if not available.
+inline bool SetAllocator( eAllocator const a ) noexcept
+{
+    if( a != eAllocator::System && !AllocatorsAvailable() ) {
+        return false;
+    }
+    detail::ActiveAllocator().store( static_cast<int>(a), std::memory_order_seq_cst );
+    return true;
+}
+
+/// rewinds the arenas of all threads which have no live allocations, returns false if at least one has.
+/// must only be called when no test is running (e.g. between the runs).
+inline bool ResetArenas() noexcept
+{
+    bool all = true;
+    for( auto &h : detail::GetRegion().heaps ) {
+        if( h.arena_first == detail::kNoChunk ) {
+            continue;
+        }
+        if( h.arena_allocs != h.arena_frees + h.arena_remote_frees.load( std::memory_order_relaxed ) ) {
+            all = false;
+            continue;
+        }
+        h.arena_allocs = h.arena_frees = 0;
+        h.arena_remote_frees.store( 0, std::memory_order_relaxed );
+        h.arena_cur = detail::kNoChunk;
+        h.arena_ptr = h.arena_end = nullptr;
+    }
+    return all;
+}
+
+/// the bytes of all chunks claimed by the arenas and pools.
+inline std::uint64_t AllocatorChunkBytes() noexcept
+{
+    auto const chunks = std::min<std::size_t>( detail::GetRegion().next_chunk.load( std::memory_order_relaxed ), detail::kChunkCount );
+    return static_cast<std::uint64_t>(chunks * detail::kChunkSize);
+}
+
+
+/// the resident set size of the process in bytes, 0 if not available.
+inline std::size_t ResidentBytes() noexcept
+{
+#if defined( _WIN32 )
+    PROCESS_MEMORY_COUNTERS  pmc{};
+    if( GetProcessMemoryInfo( GetCurrentProcess(), &pmc, sizeof( pmc ) ) ) {
+        return pmc.WorkingSetSize;
+    }
+    return 0;
+#elif defined( __APPLE__ )
+    mach_task_basic_info_data_t  info{};
+    mach_msg_type_number_t       count = MACH_TASK_BASIC_INFO_COUNT;
+    if( task_info( mach_task_self(), MACH_TASK_BASIC_INFO, reinterpret_cast<task_info_t>(&info), &count ) == KERN_SUCCESS ) {
+        return info.resident_size;
+    }
+    return 0;
+#elif defined( __linux__ )
+    // the 2nd value of statm are the resident pages. no stdio, so no allocation is done.
+    int const fd = ::open( "/proc/self/statm", O_RDONLY );
+    if( fd < 0 ) {
+        return 0;
+    }
+    char buf[128] = {};
+    auto const len = ::read( fd, buf, sizeof( buf ) - 1 );
+    ::close( fd );
+    if( len <= 0 ) {
+        return 0;
+    }
+    char const *p = buf;
+    while( *p != ' ' && *p != '\0' ) {
+        ++p;
+    }
+    if( *p == '\0' ) {
+        return 0;
+    }
+    std::size_t pages = 0;
+    for( ++p; *p >= '0' && *p <= '9'; ++p ) {
+        pages = pages * 10 + static_cast<std::size_t>(*p - '0');
+    }
+    return pages * static_cast<std::size_t>(::sysconf( _SC_PAGESIZE ));
+#else
+    return 0;
+#endif
+}
+
+} // namespace bench
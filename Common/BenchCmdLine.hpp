@@ -0,0 +1,144 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (C) 2024 Florian Thake, <contact |at| tea-age.solutions>.
+ * SPDX-License-Identifier: MIT
+ */
+#pragma once
+
+// Minimal command line parser for the benchmarks.
+// Options are given as --key=value or as --flag. Lists are comma separated, e.g. --engine=tea-vm,chai
+
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <set>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+
+namespace bench {
+
+class CmdLine
+{
+    std::map<std::string, std::string>   mOptions;
+    std::vector<std::string>             mPositional;
+    mutable std::set<std::string>        mUsed;
+
+public:
+    CmdLine() = default;
+
+    CmdLine( int argc, char *argv[] )
+    {
+        for( int i = 1; i < argc; ++i ) {
+            std::string_view const arg = argv[i];
+            if( arg.starts_with( "--" ) ) {
+                auto const eq = arg.find( '=' );
+                std::string key( arg.substr( 2, eq == std::string_view::npos ? std::string_view::npos : eq - 2 ) );
+                std::string value( eq == std::string_view::npos ? std::string_view( "1" ) : arg.substr( eq + 1 ) );
+                mOptions.insert_or_assign( std::move( key ), std::move( value ) );
+            } else {
+                mPositional.emplace_back( arg );
+            }
+        }
+    }
+
+    /// sets (or overwrites) an option.
+    void Set( std::string const &key, std::string const &value )
+    {
+        mOptions[key] = value;
+    }
+
+    bool Has( std::string const &key ) const
+    {
+        mUsed.insert( key );
+        return mOptions.contains( key );
+    }
+
+    std::string Get( std::string const &key, std::string const &def = {} ) const
+    {
+        mUsed.insert( key );
+        auto const it = mOptions.find( key );
+        return it != mOptions.end() ? it->second : def;
+    }
+
+    long long GetInt( std::string const &key, long long const def ) const
+    {
+        auto const s = Get( key );
+        return s.empty() ? def : std::strtoll( s.c_str(), nullptr, 0 );
+    }
+
+    double GetDouble( std::string const &key, double const def ) const
+    {
+        auto const s = Get( key );
+        return s.empty() ? def : std::strtod( s.c_str(), nullptr );
+    }
+
+    /// returns the comma separated values of the option or def if the option is not present.
+    std::vector<std::string> GetList( std::string const &key, std::vector<std::string> const &def = {} ) const
+    {
+        if( !Has( key ) ) {
+            return def;
+        }
+        return Split( Get( key ) );
+    }
+
+    std::vector<long long> GetIntList( std::string const &key, std::vector<long long> const &def = {} ) const
+    {
+        if( !Has( key ) ) {
+            return def;
+        }
+        std::vector<long long>  res;
+        for( auto const &s : Split( Get( key ) ) ) {
+            res.push_back( std::strtoll( s.c_str(), nullptr, 0 ) );
+        }
+        return res;
+    }
+
+    /// true if the option is not present, is "all" or the list contains the value.
+    bool Matches( std::string const &key, std::string const &value ) const
+    {
+        if( !Has( key ) ) {
+            return true;
+        }
+        for( auto const &s : Split( Get( key ) ) ) {
+            if( s == value || s == "all" ) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    std::vector<std::string> const &GetPositional() const noexcept
+    {
+        return mPositional;
+    }
+
+    /// prints a note for every option which was never queried (most likely a typo).
+    void WarnUnused() const
+    {
+        for( auto const &[key, value] : mOptions ) {
+            if( !mUsed.contains( key ) ) {
+                std::cout << "NOTE: option --" << key << " was not used." << std::endl;
+            }
+        }
+    }
+
+    static std::vector<std::string> Split( std::string const &s, char const sep = ',' )
+    {
+        std::vector<std::string>  res;
+        size_t pos = 0;
+        while( pos <= s.size() ) {
+            auto const next = std::min( s.find( sep, pos ), s.size() );
+            if( next > pos ) {
+                res.push_back( s.substr( pos, next - pos ) );
+            }
+            pos = next + 1;
+        }
+        return res;
+    }
+};
+
+} // namespace bench
@@ -0,0 +1,1152 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (C) 2024 Florian Thake, <contact |at| tea-age.solutions>.
+ * SPDX-License-Identifier: MIT
+ */
+#pragma once
+
+// Common benchmark core which is shared by all benchmarks.
+//
+// Every exec_* function measures only its region of interest (e.g. the execution of the script, parsing and
+// bootstrapping are excluded) by enclosing it with bench::Start() and bench::Stop() and returns the time in
+// seconds via bench::CalcTimeInSecs() (or a negative value on error).
+// bench::Run() calls such a function for some warmup runs first and then repeats it until the confidence
+// interval of the mean is narrow enough (or a limit is reached) and prints the statistic of all measured runs.
+// bench::Suite collects the tests of one benchmark for one parameter set, all engines can be selected at runtime.
+// The results of all tests are collected in bench::Records() (see BenchReport.hpp).
+// Instrumentation of the measured region (e.g. hardware counters, see BenchPerf.hpp) is done via RegionHooks,
+// which are called outside of the measured time.
+// Short regions (e.g. the C++ references) are measured in batches with a low overhead timer (see BenchTimer.hpp).
+// With --threads=1,2,4,... the tests of a Suite which allows it run concurrently on several threads (see RunThreaded()).
+// With --isolate each test (or each run) of a Suite is executed in an own child process (see BenchIsolate.hpp),
+// with --shuffle the tests of a Suite are run in random order.
+// With --allocator=system,arena,pool each test of a Suite runs once per allocator of operator new (see BenchAllocators.hpp).
+
+
+#include "BenchAllocators.hpp"
+#include "BenchCmdLine.hpp"
+#include "BenchIsolate.hpp"
+#include "BenchThreads.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <exception>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <numeric>
+#include <optional>
+#include <random>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+
+namespace bench {
+
+// for time measurement...
+
+using Clock     = std::chrono::steady_clock;
+using TimePoint = Clock::time_point;
+
+/// Metrics of the measured region beside the time (e.g. hardware counters) as name/value pairs.
+using Metrics = std::vector<std::pair<std::string, double>>;
+
+/// Interface for an instrumentation of the measured region.
+/// OnStart() is called before the start time is taken and OnStop() after the end time is taken,
+/// so the instrumentation itself is not part of the measured time.
+class RegionHook
+{
+public:
+    virtual ~RegionHook() = default;
+
+    virtual void OnStart() = 0;
+    virtual void OnStop() = 0;
+
+    /// called in a child process of --isolate (e.g. for reopen resources which belong to the thread of the parent).
+    virtual void OnFork() {}
+
+    /// true if only the calling thread is instrumented. such hooks are not called for RunThreaded(),
+    /// because the measuring thread only waits for the workers there.
+    virtual bool CallingThreadOnly() const noexcept { return false; }
+
+    /// adds the metrics of all regions since the last call to rMetrics and resets them.
+    virtual void Collect( Metrics &rMetrics ) = 0;
+};
+
+namespace detail {
+inline std::vector<std::unique_ptr<RegionHook>> &RegionHooks() noexcept
+{
+    static std::vector<std::unique_ptr<RegionHook>>  hooks;
+    return hooks;
+}
+} // namespace detail
+
+/// installs an instrumentation for all measured regions.
+inline void AddRegionHook( std::unique_ptr<RegionHook> hook )
+{
+    detail::RegionHooks().push_back( std::move( hook ) );
+}
+
+/// marks the start of the measured region.
+/// in a worker thread of RunThreaded() it waits until all workers are ready, the hooks are called by the measuring thread.
+inline TimePoint Start()
+{
+    auto &worker = detail::CurrentWorker();
+    if( worker.region != nullptr ) {
+        if( !worker.started ) {
+            worker.started = true;
+            worker.region->start.arrive_and_wait();
+        }
+        return Clock::now();
+    }
+    for( auto const &hook : detail::RegionHooks() ) {
+        hook->OnStart();
+    }
+    return Clock::now();
+}
+
+/// marks the end of the measured region.
+/// in a worker thread of RunThreaded() it waits (after taking the time) until all workers are done.
+inline TimePoint Stop()
+{
+    auto const now = Clock::now();
+    auto &worker = detail::CurrentWorker();
+    if( worker.region != nullptr ) {
+        if( worker.started && !worker.stopped ) {
+            worker.stopped = true;
+            worker.region->stop.arrive_and_wait();
+        }
+        return now;
+    }
+    auto &hooks = detail::RegionHooks();
+    for( auto it = hooks.rbegin(); it != hooks.rend(); ++it ) {
+        (*it)->OnStop();
+    }
+    return now;
+}
+
+namespace detail {
+inline Metrics &TestMetrics() noexcept
+{
+    static Metrics  metrics;
+    return metrics;
+}
+} // namespace detail
+
+/// adds a metric of the current run from within a test (in addition to the ones of the hooks).
+inline void AddMetric( std::string name, double const value )
+{
+    detail::TestMetrics().emplace_back( std::move( name ), value );
+}
+
+/// collects the metrics of all hooks and tests since the last call.
+inline Metrics CollectMetrics()
+{
+    Metrics  m;
+    for( auto const &hook : detail::RegionHooks() ) {
+        hook->Collect( m );
+    }
+    for( auto &metric : detail::TestMetrics() ) {
+        m.push_back( std::move( metric ) );
+    }
+    detail::TestMetrics().clear();
+    return m;
+}
+
+inline double CalcTimeInSecs( TimePoint const s, TimePoint const e )
+{
+    std::chrono::duration<double> const  timesecs = e - s;
+    return timesecs.count();
+}
+
+/// runs test on count threads concurrently, each test must create its own engine.
+/// returns the wall time from the common start (all threads are ready) until the last thread is done,
+/// or a negative value if a test failed. The mean and max latency of the threads are added as metrics.
+inline double RunThreaded( int const count, std::function<double()> const &test, bool const pin )
+{
+    ThreadRegion         region( count );
+    std::vector<double>  latencies( static_cast<size_t>(count), -1.0 );
+    std::vector<std::thread>  threads;
+    threads.reserve( static_cast<size_t>(count) );
+    for( int i = 0; i < count; ++i ) {
+        threads.emplace_back( [&, i] {
+            if( pin ) {
+                PinCurrentThread( static_cast<unsigned int>(i) );
+            }
+            auto &worker = detail::CurrentWorker();
+            worker = detail::WorkerState{ &region, i };
+            try {
+                latencies[static_cast<size_t>(i)] = test();
+            } catch( std::exception const &ex ) {
+                puts( ex.what() );
+            }
+            // the test might have failed before or inside the measured region.
+            if( !worker.started ) {
+                region.start.arrive_and_wait();
+            }
+            if( !worker.stopped ) {
+                region.stop.arrive_and_wait();
+            }
+            worker = detail::WorkerState{};
+        } );
+    }
+
+    auto &hooks = detail::RegionHooks();
+    static bool const noted = [&hooks] {
+        if( std::any_of( hooks.begin(), hooks.end(), []( auto const &hook ) { return hook->CallingThreadOnly(); } ) ) {
+            std::cout << "NOTE: with --threads the hardware counters (--perf) are not reported, they would only count the waiting measuring thread." << std::endl;
+        }
+        return true;
+    }();
+    (void)noted;
+    for( auto const &hook : hooks ) {
+        if( !hook->CallingThreadOnly() ) {
+            hook->OnStart();
+        }
+    }
+    region.start.arrive_and_wait();
+    region.stop.arrive_and_wait();
+    for( auto it = hooks.rbegin(); it != hooks.rend(); ++it ) {
+        if( !(*it)->CallingThreadOnly() ) {
+            (*it)->OnStop();
+        }
+    }
+    for( auto &t : threads ) {
+        t.join();
+    }
+
+    double sum = 0.0;
+    double max = 0.0;
+    for( auto const l : latencies ) {
+        if( l < 0.0 ) {
+            return -1.0;
+        }
+        sum += l;
+        max  = std::max( max, l );
+    }
+    AddMetric( "thread-latency-mean-us", sum / count * 1e6 );
+    AddMetric( "thread-latency-max-us", max * 1e6 );
+    return CalcTimeInSecs( region.start_time, region.stop_time );
+}
+
+
+/// The configuration for the repetition of each test.
+struct Config
+{
+    int     warmup_runs      = 1;     // runs before measuring, these are not part of the statistic.
+    int     min_runs         = 5;     // minimum count of measured runs.
+    int     max_runs         = 30;    // maximum count of measured runs.
+    double  target_rel_error = 0.02;  // repeat until half width of the confidence interval / mean is below this...
+    double  max_secs         = 60.0;  // ... or the sum of the measured times exceeds this.
+    double  confidence       = 0.95;  // confidence level of the interval.
+    double  min_batch_secs   = 1e-4;  // short regions are repeated in a batch of at least this time (see BenchTimer.hpp).
+    bool    use_tsc          = true;  // use the TSC as timer for short regions if available (see BenchTimer.hpp).
+};
+
+/// The global config, which is used by Run() if no other is passed.
+inline Config &GetConfig() noexcept
+{
+    static Config  config;
+    return config;
+}
+
+/// applies the common options of the command line to the global config.
+inline void ApplyConfig( CmdLine const &cmd )
+{
+    auto &cfg = GetConfig();
+    if( cmd.Has( "runs" ) ) { // fixed count of runs
+        cfg.min_runs = cfg.max_runs = static_cast<int>(cmd.GetInt( "runs", cfg.min_runs ));
+    }
+    cfg.warmup_runs      = static_cast<int>(cmd.GetInt( "warmup", cfg.warmup_runs ));
+    cfg.min_runs         = static_cast<int>(cmd.GetInt( "min-runs", cfg.min_runs ));
+    cfg.max_runs         = std::max( cfg.min_runs, static_cast<int>(cmd.GetInt( "max-runs", cfg.max_runs )) );
+    cfg.target_rel_error = cmd.GetDouble( "rel-error", cfg.target_rel_error );
+    cfg.max_secs         = cmd.GetDouble( "max-time", cfg.max_secs );
+    cfg.confidence       = cmd.GetDouble( "confidence", cfg.confidence );
+    cfg.min_batch_secs   = cmd.GetDouble( "min-batch-us", cfg.min_batch_secs * 1e6 ) / 1e6;
+    cfg.use_tsc          = cmd.Get( "timer", cfg.use_tsc ? "tsc" : "steady" ) != "steady";
+}
+
+/// prints the usage of the common options.
+inline void PrintCommonUsage()
+{
+    std::cout << "common options:\n"
+                 "  --engine=a,b,...   run only the tests of the given engines (default: all)\n"
+                 "  --runs=N           fixed count of measured runs\n"
+                 "  --warmup=N         count of warmup runs\n"
+                 "  --min-runs=N       minimum count of measured runs\n"
+                 "  --max-runs=N       maximum count of measured runs\n"
+                 "  --rel-error=X      target relative error of the mean (e.g. 0.02)\n"
+                 "  --max-time=S       time budget in seconds for the measured runs of one test\n"
+                 "  --confidence=X     confidence level of the interval (e.g. 0.95)\n"
+                 "  --min-batch-us=X   short regions of the C++ references are repeated in a batch of at least X us (default: 100, 0 == off)\n"
+                 "  --timer=steady     use the steady_clock instead of the TSC for the short regions\n"
+                 "  --threads=N,...    run each test concurrently on N threads, each with its own engine (fib, buffer)\n"
+                 "  --pin=0            do not pin the threads to the cpus\n"
+                 "  --isolate[=run]    run each test (or each run) in an own child process (POSIX only)\n"
+                 "  --cpu=N            pin the child processes of --isolate to cpu N\n"
+                 "  --sched-priority=N run the child processes of --isolate with the real-time priority N (SCHED_FIFO)\n"
+                 "  --shuffle          run the tests of each parameter set in random order (--seed=N for a fixed order)\n"
+                 "  --allocator=a,...  run each test with the allocators system, arena (bump per thread) and pool (size classes)\n";
+}
+
+
+/// The statistic of all measured runs of one test.
+struct Stats
+{
+    size_t  count     = 0;
+    double  min       = 0.0;
+    double  max       = 0.0;
+    double  mean      = 0.0;
+    double  median    = 0.0;
+    double  p90       = 0.0;
+    double  p99       = 0.0;
+    double  stddev    = 0.0;
+    double  ci_low    = 0.0;   // confidence interval of the mean
+    double  ci_high   = 0.0;
+    double  rel_error = 0.0;   // half width of the confidence interval / mean
+
+    bool IsValid() const noexcept { return count > 0; }
+};
+
+/// The result of one test: all measured samples (in seconds) and their statistic.
+struct Result
+{
+    std::vector<double>  samples;
+    Stats                stats;
+    Metrics              metrics;   // mean of all measured runs.
+
+    bool IsValid() const noexcept { return stats.IsValid(); }
+};
+
+
+namespace detail {
+
+// Acklam's approximation of the inverse of the standard normal CDF (relative error < 1.2e-9).
+inline double NormalQuantile( double const p )
+{
+    static constexpr double a[] = { -3.969683028665376e+01,  2.209460984245205e+02, -2.759285104469687e+02,
+                                     1.383577518672690e+02, -3.066479806614716e+01,  2.506628277459239e+00 };
+    static constexpr double b[] = { -5.447609879822406e+01,  1.615858368580409e+02, -1.556989798598866e+02,
+                                     6.680131188771972e+01, -1.328068155288572e+01 };
+    static constexpr double c[] = { -7.784894002430293e-03, -3.223964580411365e-01, -2.400758277161838e+00,
+                                    -2.549732539343734e+00,  4.374664141464968e+00,  2.938163982698783e+00 };
+    static constexpr double d[] = {  7.784695709041462e-03,  3.224671290700398e-01,  2.445134137142996e+00,
+                                     3.754408661907416e+00 };
+    constexpr double p_low = 0.02425;
+
+    if( p < p_low ) {
+        double const q = std::sqrt( -2.0 * std::log( p ) );
+        return (((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q + c[5]) / ((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1.0);
+    } else if( p > 1.0 - p_low ) {
+        double const q = std::sqrt( -2.0 * std::log( 1.0 - p ) );
+        return -(((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q + c[5]) / ((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1.0);
+    }
+    double const q = p - 0.5;
+    double const r = q * q;
+    return (((((a[0] * r + a[1]) * r + a[2]) * r + a[3]) * r + a[4]) * r + a[5]) * q / (((((b[0] * r + b[1]) * r + b[2]) * r + b[3]) * r + b[4]) * r + 1.0);
+}
+
+// quantile of the Student t distribution via Cornish-Fisher expansion (good enough for df >= 3, exact for df 1 and 2).
+inline double StudentTQuantile( double const p, double const df )
+{
+    if( df < 1.5 ) {
+        return std::tan( 3.14159265358979323846 * (p - 0.5) );
+    } else if( df < 2.5 ) {
+        return (2.0 * p - 1.0) / std::sqrt( 2.0 * p * (1.0 - p) );
+    }
+    double const z  = NormalQuantile( p );
+    double const z3 = z * z * z;
+    double const z5 = z3 * z * z;
+    double const z7 = z5 * z * z;
+    double const z9 = z7 * z * z;
+    return z + (z3 + z) / (4.0 * df)
+             + (5.0 * z5 + 16.0 * z3 + 3.0 * z) / (96.0 * df * df)
+             + (3.0 * z7 + 19.0 * z5 + 17.0 * z3 - 15.0 * z) / (384.0 * df * df * df)
+             + (79.0 * z9 + 776.0 * z7 + 1482.0 * z5 - 1920.0 * z3 - 945.0 * z) / (92160.0 * df * df * df * df);
+}
+
+// percentile of sorted values with linear interpolation.
+inline double Percentile( std::vector<double> const &sorted, double const pct )
+{
+    if( sorted.empty() ) {
+        return 0.0;
+    }
+    double const pos  = pct / 100.0 * static_cast<double>(sorted.size() - 1);
+    auto const   idx  = static_cast<size_t>(pos);
+    double const frac = pos - static_cast<double>(idx);
+    if( idx + 1 >= sorted.size() ) {
+        return sorted.back();
+    }
+    return sorted[idx] + frac * (sorted[idx + 1] - sorted[idx]);
+}
+
+// exec_* functions print their result value only for the first run of each test.
+inline bool &PrintValueEnabled() noexcept
+{
+    static bool  enabled = true;
+    return enabled;
+}
+
+} // namespace detail
+
+
+/// calculates the statistic of the given samples (in seconds).
+inline Stats CalcStats( std::vector<double> samples, double const confidence = GetConfig().confidence )
+{
+    Stats  s;
+    if( samples.empty() ) {
+        return s;
+    }
+    std::sort( samples.begin(), samples.end() );
+    s.count  = samples.size();
+    s.min    = samples.front();
+    s.max    = samples.back();
+    s.median = detail::Percentile( samples, 50.0 );
+    s.p90    = detail::Percentile( samples, 90.0 );
+    s.p99    = detail::Percentile( samples, 99.0 );
+
+    double sum = 0.0;
+    for( auto const v : samples ) {
+        sum += v;
+    }
+    s.mean = sum / static_cast<double>(s.count);
+
+    if( s.count > 1 ) {
+        double sq = 0.0;
+        for( auto const v : samples ) {
+            sq += (v - s.mean) * (v - s.mean);
+        }
+        s.stddev = std::sqrt( sq / static_cast<double>(s.count - 1) );
+        double const t    = detail::StudentTQuantile( 1.0 - (1.0 - confidence) / 2.0, static_cast<double>(s.count - 1) );
+        double const half = t * s.stddev / std::sqrt( static_cast<double>(s.count) );
+        s.ci_low    = s.mean - half;
+        s.ci_high   = s.mean + half;
+        s.rel_error = s.mean > 0.0 ? half / s.mean : 0.0;
+    } else {
+        s.ci_low  = s.mean;
+        s.ci_high = s.mean;
+    }
+
+    return s;
+}
+
+
+/// prints the result value of an exec_* function, but only for the first run of a test.
+template< typename T >
+void PrintValue( T const &value )
+{
+    if( detail::PrintValueEnabled() && WorkerIndex() <= 0 ) {
+        std::cout << "value: " << value << std::endl;
+    }
+}
+
+
+/// prints the statistic in the common format.
+inline void PrintStats( Stats const &s, Config const &cfg = GetConfig() )
+{
+    auto const flags = std::cout.flags();
+    auto const prec  = std::cout.precision();
+    std::cout << std::fixed << std::setprecision( 8 );
+    std::cout << "runs: " << s.count << " (warmup: " << cfg.warmup_runs << ")\n";
+    std::cout << "min: " << s.min << "  median: " << s.median << "  mean: " << s.mean << " seconds.\n";
+    std::cout << "p90: " << s.p90 << "  p99: " << s.p99 << "  max: " << s.max << "  stddev: " << s.stddev << '\n';
+    std::cout << std::setprecision( 0 ) << cfg.confidence * 100.0 << "% CI of mean: [" << std::setprecision( 8 ) << s.ci_low << ", " << s.ci_high
+              << "] (+-" << std::setprecision( 2 ) << s.rel_error * 100.0 << " %)" << std::endl;
+    std::cout.flags( flags );
+    std::cout.precision( prec );
+}
+
+
+/// Runs the test function for the configured warmup runs and then repeats it until the relative error
+/// of the mean is below the target (or a limit is reached). The function must return the measured time
+/// in seconds or a negative value on error (the test is aborted then).
+inline Result Run( std::string const &title, std::function<double()> const &test, Config const &cfg = GetConfig() )
+{
+    std::cout << "\nStart Test " << title << std::endl;
+
+    detail::PrintValueEnabled() = true;
+    for( int i = 0; i < cfg.warmup_runs; ++i ) {
+        auto const secs = test();
+        (void)CollectMetrics(); // discard
+        detail::PrintValueEnabled() = false;
+        if( secs < 0.0 ) {
+            std::cout << "Test failed!" << std::endl;
+            detail::PrintValueEnabled() = true;
+            return {};
+        }
+    }
+
+    Result  res;
+    auto   &samples = res.samples;
+    auto   &stats   = res.stats;
+    samples.reserve( static_cast<size_t>(std::max( cfg.max_runs, 1 )) );
+    double total = 0.0;
+    while( true ) {
+        auto const secs = test();
+        detail::PrintValueEnabled() = false;
+        if( secs < 0.0 ) {
+            std::cout << "Test failed!" << std::endl;
+            detail::PrintValueEnabled() = true;
+            return {};
+        }
+        samples.push_back( secs );
+        total += secs;
+        for( auto const &[name, value] : CollectMetrics() ) {
+            auto it = std::find_if( res.metrics.begin(), res.metrics.end(), [&name]( auto const &m ) { return m.first == name; } );
+            if( it == res.metrics.end() ) {
+                res.metrics.emplace_back( name, value );
+            } else {
+                it->second += value;
+            }
+        }
+
+        auto const runs = static_cast<int>(samples.size());
+        if( runs < cfg.min_runs ) {
+            continue;
+        }
+        stats = CalcStats( samples, cfg.confidence );
+        if( stats.rel_error <= cfg.target_rel_error || runs >= cfg.max_runs || total >= cfg.max_secs ) {
+            break;
+        }
+    }
+    detail::PrintValueEnabled() = true;
+    for( auto &m : res.metrics ) {
+        m.second /= static_cast<double>(samples.size());
+    }
+
+    PrintStats( stats, cfg );
+    if( stats.rel_error > cfg.target_rel_error && cfg.min_runs < cfg.max_runs ) {
+        auto const prec = std::cout.precision( 2 );
+        std::cout << "NOTE: target relative error of +-" << cfg.target_rel_error * 100.0 << " % not reached." << std::endl;
+        std::cout.precision( prec );
+    }
+
+    return res;
+}
+
+
+/// the value of the metric name of the result, 0 if not present.
+inline double FindMetric( Result const &res, std::string const &name ) noexcept
+{
+    for( auto const &[n, value] : res.metrics ) {
+        if( n == name ) {
+            return value;
+        }
+    }
+    return 0.0;
+}
+
+/// prints the time and the metrics per operation (and the metrics per run if ops is 0).
+inline void PrintPerOp( Result const &res, double const ops, std::string const &unit )
+{
+    auto const flags = std::cout.flags();
+    auto const prec  = std::cout.precision();
+    std::cout << std::fixed << std::setprecision( 2 );
+    if( ops > 0.0 ) {
+        std::cout << "per " << unit << ": " << res.stats.median / ops * 1e9 << " ns (median)" << std::endl;
+    }
+    double cycles       = 0.0;
+    double instructions = 0.0;
+    for( auto const &[name, value] : res.metrics ) {
+        std::cout << name << ": " << value;
+        if( ops > 0.0 ) {
+            std::cout << " (" << value / ops << " / " << unit << ')';
+        }
+        std::cout << '\n';
+        if( name == "cycles" ) {
+            cycles = value;
+        } else if( name == "instructions" ) {
+            instructions = value;
+        }
+    }
+    if( cycles > 0.0 && instructions > 0.0 ) {
+        std::cout << "IPC: " << instructions / cycles << '\n';
+    }
+    std::cout << std::flush;
+    std::cout.flags( flags );
+    std::cout.precision( prec );
+}
+
+
+/// The parameters of a benchmark run as name/value pairs.
+using Params = std::vector<std::pair<std::string, std::string>>;
+
+/// One record of the results of a run (see BenchReport.hpp for writing and comparing them).
+struct Record
+{
+    std::string  benchmark;
+    std::string  engine;
+    std::string  title;
+    std::string  engine_version;
+    Params       params;
+    Result       result;
+    double       ops = 0.0;   // count of operations per run (e.g. fib calls, pixels), 0 if unknown.
+    std::string  ops_unit;
+};
+
+/// all records of the current process.
+inline std::vector<Record> &Records() noexcept
+{
+    static std::vector<Record>  records;
+    return records;
+}
+
+namespace detail {
+inline std::vector<std::pair<std::string, std::string>> &EngineVersions() noexcept
+{
+    static std::vector<std::pair<std::string, std::string>>  versions;
+    return versions;
+}
+} // namespace detail
+
+/// sets the version for the engine id and all ids starting with "id-" (e.g. "tea" is used for "tea-vm" as well).
+inline void SetEngineVersion( std::string const &id, std::string const &version )
+{
+    for( auto &[key, value] : detail::EngineVersions() ) {
+        if( key == id ) {
+            value = version;
+            return;
+        }
+    }
+    detail::EngineVersions().emplace_back( id, version );
+}
+
+/// returns the version of the engine with the longest matching id, or an empty string.
+inline std::string GetEngineVersion( std::string const &engine )
+{
+    std::string  res;
+    size_t       len = 0;
+    for( auto const &[key, value] : detail::EngineVersions() ) {
+        if( (engine == key || engine.starts_with( key + '-' )) && key.size() > len ) {
+            res = value;
+            len = key.size();
+        }
+    }
+    return res;
+}
+
+/// builds a version string "major.minor.patch".
+inline std::string VersionString( long long const major, long long const minor, long long const patch )
+{
+    return std::to_string( major ) + '.' + std::to_string( minor ) + '.' + std::to_string( patch );
+}
+
+/// the name and version of the compiler (used as version of the C++ reference).
+inline std::string CompilerVersion()
+{
+#if defined( _MSC_VER ) && !defined( __clang__ )
+    return "MSVC " + std::to_string( _MSC_FULL_VER );
+#elif defined( __clang__ )
+    return "clang " __clang_version__;
+#elif defined( __GNUC__ )
+    return "gcc " __VERSION__;
+#else
+    return "unknown";
+#endif
+}
+
+namespace detail {
+
+// the data sent by a child process of --isolate: one line per sample, metric and note.
+inline void WriteChildData( std::string &rOut, std::vector<double> const &samples, Metrics const &metrics )
+{
+    std::ostringstream  os;
+    os << std::setprecision( 17 );
+    for( auto const s : samples ) {
+        os << "s " << s << '\n';
+    }
+    for( auto const &[name, value] : metrics ) {
+        os << "m " << name << ' ' << value << '\n';
+    }
+    rOut += os.str();
+}
+
+inline bool ReadChildData( std::string const &data, std::vector<double> &rSamples, Metrics &rMetrics )
+{
+    static std::set<std::string>  printed_notes;
+    std::istringstream  is( data );
+    std::string         line;
+    while( std::getline( is, line ) ) {
+        if( line.starts_with( "n " ) ) {
+            if( printed_notes.insert( line ).second ) {
+                std::cout << "NOTE: " << line.substr( 2 ) << std::endl;
+            }
+            continue;
+        }
+        std::istringstream  ls( line.size() > 2 ? line.substr( 2 ) : std::string() );
+        if( line.starts_with( "s " ) ) {
+            double  v = 0.0;
+            if( !(ls >> v) ) {
+                return false;
+            }
+            rSamples.push_back( v );
+        } else if( line.starts_with( "m " ) ) {
+            std::string  name;
+            double       v = 0.0;
+            if( !(ls >> name >> v) ) {
+                return false;
+            }
+            rMetrics.emplace_back( std::move( name ), v );
+        } else if( !line.empty() ) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// one random generator for all suites, the seed is printed for reproduce the order.
+inline std::mt19937_64 &ShuffleRng( CmdLine const &cmd )
+{
+    static std::mt19937_64  rng = [&] {
+        auto const seed = cmd.Has( "seed" ) ? static_cast<std::uint64_t>(cmd.GetInt( "seed", 0 )) : std::random_device{}();
+        std::cout << "shuffle seed: " << seed << " (use --seed=" << seed << " for the same order)" << std::endl;
+        return std::mt19937_64( seed );
+    }();
+    return rng;
+}
+
+} // namespace detail
+
+/// A Suite collects the tests of one benchmark with one parameter set and runs them.
+class Suite
+{
+public:
+    struct Test
+    {
+        std::string              engine;  // id for the selection via --engine
+        std::string              title;
+        std::function<double()>  func;
+        double                   ops = 0.0;  // count of operations if differs from the suite, otherwise 0
+    };
+
+private:
+    CmdLine const      &mCmdLine;
+    std::string         mBenchmark;
+    Params              mParams;
+    std::vector<Test>   mTests;
+    double              mOps = 0.0;
+    std::string         mOpsUnit;
+    bool                mThreadsAllowed = false;
+
+    struct ThreadResult
+    {
+        long long  threads;
+        double     median;
+    };
+
+    struct AllocatorResult
+    {
+        eAllocator  allocator;
+        long long   threads;   // 0 == without --threads
+        double      median;
+        double      rss_growth;
+    };
+
+    // the allocators of --allocator, a single std::nullopt for run without changing the allocator.
+    std::vector<std::optional<eAllocator>> GetAllocators() const
+    {
+        if( !mCmdLine.Has( "allocator" ) ) {
+            return { std::nullopt };
+        }
+        std::vector<std::optional<eAllocator>>  res;
+        for( auto const &name : mCmdLine.GetList( "allocator" ) ) {
+            eAllocator  a = eAllocator::System;
+            if( name == "1" || name == "all" ) {
+                res.insert( res.end(), { eAllocator::System, eAllocator::Arena, eAllocator::Pool } );
+                continue;
+            }
+            if( !ParseAllocator( name, a ) ) {
+                std::cout << "NOTE: unknown allocator: " << name << std::endl;
+                continue;
+            }
+            res.push_back( a );
+        }
+        if( std::any_of( res.begin(), res.end(), []( auto const &a ) { return *a != eAllocator::System; } ) && !AllocatorsAvailable() ) {
+            std::cout << "NOTE: the allocators are not available (BENCH_ALLOC_HOOKS or address space), using only the system allocator." << std::endl;
+            std::erase_if( res, []( auto const &a ) { return *a != eAllocator::System; } );
+        }
+        if( res.empty() ) {
+            res.push_back( std::nullopt );
+        }
+        return res;
+    }
+
+    // runs the test with the allocator a, the arenas are rewound after each run.
+    static std::function<double()> WithAllocator( eAllocator const a, std::function<double()> test )
+    {
+        return [a, test = std::move( test )]() -> double {
+            auto const rss = ResidentBytes();
+            SetAllocator( a );
+            double secs = -1.0;
+            try {
+                secs = test();
+            } catch( ... ) {
+                SetAllocator( eAllocator::System );
+                throw;
+            }
+            SetAllocator( eAllocator::System );
+            bool const reset = ResetArenas();
+            AddMetric( "rss-growth-bytes", static_cast<double>(ResidentBytes()) - static_cast<double>(rss) );
+            if( a == eAllocator::Arena ) {
+                AddMetric( "arena-reset", reset ? 1.0 : 0.0 );
+            }
+            return secs;
+        };
+    }
+
+    void PrintAllocatorComparison( std::string const &title, std::vector<AllocatorResult> const &results ) const
+    {
+        if( results.size() < 2 ) {
+            return;
+        }
+        auto const flags = std::cout.flags();
+        auto const prec  = std::cout.precision();
+        std::cout << "\nallocators of " << title << " (median, speedup vs. system):\n";
+        std::cout << "allocator  threads  time [s]        speedup  rss growth [KB]\n";
+        for( auto const &r : results ) {
+            auto const base = std::find_if( results.begin(), results.end(), [&r]( auto const &b ) {
+                return b.threads == r.threads && b.allocator == eAllocator::System;
+            } );
+            std::cout << std::left << std::setw( 11 ) << AllocatorName( r.allocator ) << std::setw( 9 ) << (r.threads > 0 ? std::to_string( r.threads ) : "-")
+                      << std::right << std::fixed << std::setprecision( 8 ) << std::setw( 10 ) << r.median << std::setprecision( 2 ) << std::setw( 13 );
+            if( base != results.end() && r.median > 0.0 ) {
+                std::cout << base->median / r.median << 'x';
+            } else {
+                std::cout << '-' << ' ';
+            }
+            std::cout << std::setw( 17 ) << r.rss_growth / 1024.0 << '\n';
+        }
+        std::cout << std::flush;
+        std::cout.flags( flags );
+        std::cout.precision( prec );
+    }
+
+    enum class eIsolate { None, Test, Run };
+
+    struct Isolation
+    {
+        eIsolate  mode     = eIsolate::None;
+        int       cpu      = -1;  // pin the child processes to this cpu (-1 == not pinned).
+        int       priority = 0;   // real-time priority of the child processes (0 == unchanged).
+    };
+
+    Isolation GetIsolation() const
+    {
+        Isolation  iso;
+        auto const mode = mCmdLine.Get( "isolate", "0" );
+        if( mode == "1" || mode == "test" ) {
+            iso.mode = eIsolate::Test;
+        } else if( mode == "run" ) {
+            iso.mode = eIsolate::Run;
+        } else if( mode != "0" ) {
+            std::cout << "NOTE: unknown --isolate=" << mode << ", use test or run." << std::endl;
+        }
+        iso.cpu      = static_cast<int>(mCmdLine.GetInt( "cpu", -1 ));
+        iso.priority = static_cast<int>(mCmdLine.GetInt( "sched-priority", 0 ));
+        if( iso.mode != eIsolate::None && !IsolationAvailable() ) {
+            std::cout << "NOTE: --isolate is not available on this platform, the tests run in this process." << std::endl;
+            iso.mode = eIsolate::None;
+        }
+        return iso;
+    }
+
+    // the setup of a child process, returns the notes for the parent.
+    static std::string PrepareChild( Isolation const &iso )
+    {
+        for( auto const &hook : detail::RegionHooks() ) {
+            hook->OnFork();
+        }
+        std::string  notes;
+        if( iso.cpu >= 0 && !PinCurrentProcess( static_cast<unsigned int>(iso.cpu) ) ) {
+            notes += "n cannot pin the child processes to cpu " + std::to_string( iso.cpu ) + ".\n";
+        }
+        if( iso.priority > 0 && !SetFixedPriority( iso.priority ) ) {
+            notes += "n cannot set the real-time priority " + std::to_string( iso.priority ) + " (missing permission?).\n";
+        }
+        return notes;
+    }
+
+    // all runs of the test in one child process.
+    static Result RunIsolatedTest( std::string const &title, std::function<double()> const &test, Isolation const &iso )
+    {
+        auto const data = RunInChildProcess( [&]() -> std::optional<std::string> {
+            auto out = PrepareChild( iso );
+            auto res = bench::Run( title, test );
+            if( !res.IsValid() ) {
+                return std::nullopt;
+            }
+            detail::WriteChildData( out, res.samples, res.metrics );
+            return out;
+        } );
+        Result  res;
+        if( !data || !detail::ReadChildData( *data, res.samples, res.metrics ) || res.samples.empty() ) {
+            std::cout << "Test failed (child process)!" << std::endl;
+            return {};
+        }
+        res.stats = CalcStats( res.samples );
+        return res;
+    }
+
+    // each run in a new child process, the warmup runs are done in each child before the measured run.
+    static Result RunIsolatedRuns( std::string const &title, std::function<double()> const &test, Isolation const &iso )
+    {
+        auto       cfg     = GetConfig();
+        int const  warmups = cfg.warmup_runs;
+        cfg.warmup_runs    = 0;
+        return bench::Run( title, [&]() -> double {
+            auto const data = RunInChildProcess( [&]() -> std::optional<std::string> {
+                auto out = PrepareChild( iso );
+                for( int i = 0; i < warmups; ++i ) {
+                    auto const secs = test();
+                    (void)CollectMetrics(); // discard
+                    detail::PrintValueEnabled() = false;
+                    if( secs < 0.0 ) {
+                        return std::nullopt;
+                    }
+                }
+                auto const secs = test();
+                if( secs < 0.0 ) {
+                    return std::nullopt;
+                }
+                detail::WriteChildData( out, { secs }, CollectMetrics() );
+                return out;
+            } );
+            std::vector<double>  samples;
+            Metrics              metrics;
+            if( !data || !detail::ReadChildData( *data, samples, metrics ) || samples.size() != 1 ) {
+                return -1.0;
+            }
+            for( auto &[name, value] : metrics ) {
+                AddMetric( std::move( name ), value );
+            }
+            return samples.front();
+        }, cfg );
+    }
+
+    static Result RunTest( std::string const &title, std::function<double()> const &test, Isolation const &iso )
+    {
+        switch( iso.mode ) {
+        case eIsolate::Test:
+            return RunIsolatedTest( title, test, iso );
+        case eIsolate::Run:
+            return RunIsolatedRuns( title, test, iso );
+        default:
+            return bench::Run( title, test );
+        }
+    }
+
+    void PrintThreadScaling( std::string const &title, std::vector<ThreadResult> const &results, double const ops ) const
+    {
+        if( results.empty() ) {
+            return;
+        }
+        auto const flags = std::cout.flags();
+        auto const prec  = std::cout.precision();
+        auto const &base = results.front();
+        std::cout << "\nscaling of " << title << " (median, each thread does the full work):\n";
+        std::cout << "threads  time [s]        throughput [" << (ops > 0.0 ? mOpsUnit : "run") << "/s]  efficiency\n";
+        for( auto const &r : results ) {
+            double const throughput = (ops > 0.0 ? ops : 1.0) * static_cast<double>(r.threads) / r.median;
+            // weak scaling: the ideal time stays the same with more threads.
+            double const efficiency = base.median / r.median;
+            std::cout << std::left << std::setw( 9 ) << r.threads << std::right << std::fixed << std::setprecision( 8 ) << std::setw( 14 ) << r.median
+                      << std::setprecision( 2 ) << std::setw( 22 ) << throughput << std::setw( 11 ) << efficiency * 100.0 << " %\n";
+        }
+        std::cout << std::flush;
+        std::cout.flags( flags );
+        std::cout.precision( prec );
+    }
+
+public:
+    Suite( CmdLine const &cmd, std::string benchmark, Params params = {} )
+        : mCmdLine( cmd )
+        , mBenchmark( std::move( benchmark ) )
+        , mParams( std::move( params ) )
+    {
+    }
+
+    /// adds the test, but only if its engine is selected. ops overrides the count of operations of the suite (if > 0).
+    void Add( std::string const &engine, std::string const &title, std::function<double()> func, double const ops = 0.0 )
+    {
+        if( mCmdLine.Matches( "engine", engine ) ) {
+            mTests.push_back( Test{ engine, title, std::move( func ), ops } );
+        }
+    }
+
+    /// sets the count of operations of one run of each test, used for normalize the results (e.g. time per pixel).
+    void SetOps( double const ops, std::string unit )
+    {
+        mOps     = ops;
+        mOpsUnit = std::move( unit );
+    }
+
+    /// the tests are allowed to run concurrently on several threads (each test creates its own engine), see --threads.
+    void AllowThreads( bool const allow = true ) noexcept
+    {
+        mThreadsAllowed = allow;
+    }
+
+    std::string const &GetBenchmark() const noexcept { return mBenchmark; }
+    Params const &GetParams() const noexcept { return mParams; }
+
+    /// runs all added tests, returns the count of failed tests.
+    int Run()
+    {
+        std::cout << "\n=== " << mBenchmark;
+        for( auto const &[name, value] : mParams ) {
+            std::cout << ' ' << name << '=' << value;
+        }
+        std::cout << " ===" << std::endl;
+
+        auto const thread_counts = mThreadsAllowed ? mCmdLine.GetIntList( "threads" ) : std::vector<long long>{};
+        bool const pin           = mThreadsAllowed && mCmdLine.Get( "pin", "1" ) != "0";
+        auto const iso           = GetIsolation();
+        auto const allocators    = GetAllocators();
+
+        std::vector<size_t>  order( mTests.size() );
+        std::iota( order.begin(), order.end(), size_t{ 0 } );
+        if( mCmdLine.Get( "shuffle", "0" ) != "0" ) {
+            std::shuffle( order.begin(), order.end(), detail::ShuffleRng( mCmdLine ) );
+            std::cout << "order:";
+            for( auto const i : order ) {
+                std::cout << ' ' << mTests[i].engine;
+            }
+            std::cout << std::endl;
+        }
+
+        int failed = 0;
+        for( auto const i : order ) {
+            auto const &test = mTests[i];
+            double const ops = test.ops > 0.0 ? test.ops : mOps;
+            std::vector<AllocatorResult>  by_allocator;
+            for( auto const &alloc : allocators ) {
+                auto const suffix = alloc ? std::string( " [" ) + AllocatorName( *alloc ) + ']' : std::string();
+                auto       params = mParams;
+                if( alloc ) {
+                    params.emplace_back( "allocator", AllocatorName( *alloc ) );
+                }
+                if( thread_counts.empty() ) {
+                    auto res = RunTest( test.title + suffix, alloc ? WithAllocator( *alloc, test.func ) : test.func, iso );
+                    if( !res.IsValid() ) {
+                        ++failed;
+                        continue;
+                    }
+                    PrintPerOp( res, ops, mOpsUnit );
+                    if( alloc ) {
+                        by_allocator.push_back( AllocatorResult{ *alloc, 0, res.stats.median, FindMetric( res, "rss-growth-bytes" ) } );
+                    }
+                    Records().push_back( Record{ mBenchmark, test.engine, test.title, GetEngineVersion( test.engine ), std::move( params ), std::move( res ), ops, mOpsUnit } );
+                    continue;
+                }
+
+                std::vector<ThreadResult>  scaling;
+                for( auto const count : thread_counts ) {
+                    if( count < 1 ) {
+                        continue;
+                    }
+                    auto const title = test.title + " [" + std::to_string( count ) + " threads]" + suffix;
+                    std::function<double()> threaded = [&] { return RunThreaded( static_cast<int>(count), test.func, pin ); };
+                    auto res = RunTest( title, alloc ? WithAllocator( *alloc, threaded ) : threaded, iso );
+                    if( !res.IsValid() ) {
+                        ++failed;
+                        continue;
+                    }
+                    // the ops of all threads, so the time per op is the inverse of the aggregate throughput.
+                    double const all_ops = ops * static_cast<double>(count);
+                    PrintPerOp( res, all_ops, mOpsUnit );
+                    scaling.push_back( ThreadResult{ count, res.stats.median } );
+                    if( alloc ) {
+                        by_allocator.push_back( AllocatorResult{ *alloc, count, res.stats.median, FindMetric( res, "rss-growth-bytes" ) } );
+                    }
+                    auto thread_params = params;
+                    thread_params.emplace_back( "threads", std::to_string( count ) );
+                    Records().push_back( Record{ mBenchmark, test.engine, test.title, GetEngineVersion( test.engine ), std::move( thread_params ), std::move( res ), all_ops, mOpsUnit } );
+                }
+                PrintThreadScaling( test.title + suffix, scaling, ops );
+            }
+            PrintAllocatorComparison( test.title, by_allocator );
+        }
+        return failed;
+    }
+};
+
+
+/// prints for the records since first the one-time cost (the metric cost_metric in microseconds, e.g. the compile time),
+/// the time of one run (median) and after how many runs a test is faster in total than the record of base_engine.
+/// the records are grouped by their parameters (e.g. --threads, --allocator), each group has its own baseline.
+inline void PrintBreakEven( std::string const &caption, std::size_t const first, std::string const &cost_metric, std::string const &base_engine )
+{
+    auto const &records = Records();
+    std::vector<Params>  groups;
+    for( auto i = first; i < records.size(); ++i ) {
+        if( std::find( groups.begin(), groups.end(), records[i].params ) == groups.end() ) {
+            groups.push_back( records[i].params );
+        }
+    }
+
+    auto const flags = std::cout.flags();
+    auto const prec  = std::cout.precision();
+    for( auto const &params : groups ) {
+        std::string  group_caption = caption;
+        if( groups.size() > 1 ) {
+            group_caption += " [";
+            for( auto const &[name, value] : params ) {
+                group_caption += (group_caption.back() == '[' ? "" : " ") + name + '=' + value;
+            }
+            group_caption += ']';
+        }
+        auto const in_group = [&]( Record const &r ) { return r.params == params; };
+        auto const base_it  = std::find_if( records.begin() + static_cast<std::ptrdiff_t>(first), records.end(),
+                                            [&]( Record const &r ) { return in_group( r ) && r.engine == base_engine; } );
+        if( base_it == records.end() ) {
+            std::cout << "\nNOTE: " << group_caption << ": no result of " << base_engine << ", no break-even is printed." << std::endl;
+            continue;
+        }
+        auto const &base      = *base_it;
+        double const base_cost = FindMetric( base.result, cost_metric ) * 1e-6;
+        double const base_run  = base.result.stats.median;
+        std::size_t  width     = 6;
+        for( auto i = first; i < records.size(); ++i ) {
+            if( in_group( records[i] ) ) {
+                width = std::max( width, records[i].title.size() + 2 );
+            }
+        }
+
+        std::cout << '\n' << group_caption << " (median, break-even vs. " << base.title << "):\n";
+        std::cout << std::left << std::setw( static_cast<int>(width) ) << "test" << std::right << std::setw( 16 ) << cost_metric
+                  << "         run [s]   cost + 1 run [s]  break-even\n";
+        for( auto i = first; i < records.size(); ++i ) {
+            auto const &r = records[i];
+            if( !in_group( r ) ) {
+                continue;
+            }
+            double const cost = FindMetric( r.result, cost_metric ) * 1e-6;
+            double const run  = r.result.stats.median;
+            std::cout << std::left << std::setw( static_cast<int>(width) ) << r.title << std::right << std::fixed
+                      << std::setprecision( 2 ) << std::setw( 16 ) << cost * 1e6
+                      << std::setprecision( 8 ) << std::setw( 16 ) << run << std::setw( 19 ) << cost + run << "  ";
+            if( &r == &base ) {
+                std::cout << "baseline";
+            } else if( cost <= base_cost && run <= base_run ) {
+                std::cout << "always";
+            } else if( run >= base_run ) {
+                std::cout << "never";
+            } else {
+                std::cout << static_cast<long long>(std::ceil( (cost - base_cost) / (base_run - run) )) << " run(s)";
+            }
+            std::cout << '\n';
+        }
+    }
+    std::cout << std::flush;
+    std::cout.flags( flags );
+    std::cout.precision( prec );
+}
+
+} // namespace bench
@@ -0,0 +1,165 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (C) 2024 Florian Thake, <contact |at| tea-age.solutions>.
+ * SPDX-License-Identifier: MIT
+ */
+#pragma once
+
+// Fitting of measured times to the problem size n for see how a test scales.
+//
+// FitPowerLaw() fits t = a * n^b (least squares in log-log space), b ~ 1 means linear, b > 1 superlinear.
+// FitComplexity() fits t = a * f(n) for O(1), O(log n), O(n), O(n log n) and O(n^2) and returns the one with the
+// lowest relative RMS error.
+
+
+#include <algorithm>
+#include <cmath>
+#include <initializer_list>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+
+namespace bench {
+
+struct PowerLawFit
+{
+    double  factor   = 0.0;   // a
+    double  exponent = 0.0;   // b
+    double  r2       = 0.0;   // coefficient of determination in log-log space
+    bool    valid    = false;
+};
+
+/// fits y = a * x^b. needs at least 2 points with different x, all values must be > 0.
+inline PowerLawFit FitPowerLaw( std::vector<double> const &x, std::vector<double> const &y )
+{
+    PowerLawFit  res;
+    size_t const n = std::min( x.size(), y.size() );
+    if( n < 2 ) {
+        return res;
+    }
+    double sx = 0.0, sy = 0.0, sxx = 0.0, sxy = 0.0, syy = 0.0;
+    for( size_t i = 0; i < n; ++i ) {
+        if( x[i] <= 0.0 || y[i] <= 0.0 ) {
+            return res;
+        }
+        double const lx = std::log( x[i] );
+        double const ly = std::log( y[i] );
+        sx  += lx;
+        sy  += ly;
+        sxx += lx * lx;
+        sxy += lx * ly;
+        syy += ly * ly;
+    }
+    double const dn  = static_cast<double>(n);
+    double const vxx = sxx - sx * sx / dn;
+    double const vyy = syy - sy * sy / dn;
+    double const vxy = sxy - sx * sy / dn;
+    if( vxx <= 0.0 ) {
+        return res;
+    }
+    res.exponent = vxy / vxx;
+    res.factor   = std::exp( (sy - res.exponent * sx) / dn );
+    res.r2       = vyy > 0.0 ? (vxy * vxy) / (vxx * vyy) : 1.0;
+    res.valid    = true;
+    return res;
+}
+
+enum class eComplexity { O1, OLogN, ON, ONLogN, ON2 };
+
+inline char const *ComplexityName( eComplexity const c ) noexcept
+{
+    switch( c ) {
+    case eComplexity::O1:     return "O(1)";
+    case eComplexity::OLogN:  return "O(log n)";
+    case eComplexity::ON:     return "O(n)";
+    case eComplexity::ONLogN: return "O(n log n)";
+    case eComplexity::ON2:    return "O(n^2)";
+    }
+    return "?";
+}
+
+struct ComplexityFit
+{
+    eComplexity  complexity = eComplexity::O1;
+    double       factor     = 0.0;   // a of y = a * f(n)
+    double       rms        = 0.0;   // relative RMS error (relative to the mean of y)
+    bool         valid      = false;
+};
+
+/// fits y = a * f(x) for all supported complexities and returns the best one. needs at least 2 points.
+inline ComplexityFit FitComplexity( std::vector<double> const &x, std::vector<double> const &y )
+{
+    ComplexityFit  best;
+    size_t const n = std::min( x.size(), y.size() );
+    if( n < 2 ) {
+        return best;
+    }
+    auto const f = []( eComplexity const c, double const v ) {
+        switch( c ) {
+        case eComplexity::O1:     return 1.0;
+        case eComplexity::OLogN:  return std::log2( std::max( v, 2.0 ) );
+        case eComplexity::ON:     return v;
+        case eComplexity::ONLogN: return v * std::log2( std::max( v, 2.0 ) );
+        case eComplexity::ON2:    return v * v;
+        }
+        return 1.0;
+    };
+    double mean = 0.0;
+    for( size_t i = 0; i < n; ++i ) {
+        mean += y[i];
+    }
+    mean /= static_cast<double>(n);
+    if( mean <= 0.0 ) {
+        return best;
+    }
+    for( auto const c : { eComplexity::O1, eComplexity::OLogN, eComplexity::ON, eComplexity::ONLogN, eComplexity::ON2 } ) {
+        // least squares for a single factor: a = sum( y * f ) / sum( f * f )
+        double sff = 0.0, syf = 0.0;
+        for( size_t i = 0; i < n; ++i ) {
+            double const fv = f( c, x[i] );
+            sff += fv * fv;
+            syf += y[i] * fv;
+        }
+        double const a = syf / sff;
+        double sq = 0.0;
+        for( size_t i = 0; i < n; ++i ) {
+            double const d = y[i] - a * f( c, x[i] );
+            sq += d * d;
+        }
+        double const rms = std::sqrt( sq / static_cast<double>(n) ) / mean;
+        if( !best.valid || rms < best.rms ) {
+            best = ComplexityFit{ c, a, rms, true };
+        }
+    }
+    return best;
+}
+
+/// prints the scaling of y (e.g. the median times) over x (e.g. the sizes).
+/// if the best fit is worse than expected it will be flagged (never for the default O(n^2)).
+inline void PrintScaling( std::string const &label, std::vector<double> const &x, std::vector<double> const &y,
+                          eComplexity const expected = eComplexity::ON2 )
+{
+    auto const pl = FitPowerLaw( x, y );
+    auto const cf = FitComplexity( x, y );
+    if( !pl.valid || !cf.valid ) {
+        std::cout << label << ": not enough data for a fit." << std::endl;
+        return;
+    }
+    auto const flags = std::cout.flags();
+    auto const prec  = std::cout.precision();
+    std::cout << std::fixed << std::setprecision( 2 );
+    std::cout << label << ": ~ n^" << pl.exponent << " (R^2 " << std::setprecision( 3 ) << pl.r2 << "), best fit "
+              << ComplexityName( cf.complexity ) << " (rms " << std::setprecision( 1 ) << cf.rms * 100.0 << " %)";
+    if( pl.exponent > 1.15 ) {
+        std::cout << " - superlinear!";
+    }
+    if( cf.complexity > expected ) {
+        std::cout << " - worse than expected " << ComplexityName( expected ) << '!';
+    }
+    std::cout << std::endl;
+    std::cout.flags( flags );
+    std::cout.precision( prec );
+}
+
+} // namespace bench
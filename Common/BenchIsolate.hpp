@@ -0,0 +1,164 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (C) 2024 Florian Thake, <contact |at| tea-age.solutions>.
+ * SPDX-License-Identifier: MIT
+ */
+#pragma once
+
+// Process isolation for the benchmarks (POSIX only).
+//
+// With --isolate each test (or with --isolate=run each run) is executed in a forked child process, so the heap
+// fragmentation, the warmed allocator arenas and the caches of one engine do not bias the next one. The child starts
+// with a copy of the (small) state of the parent, sends its result back via a pipe and exits.
+// The child can be pinned to one cpu (--cpu=N) and run with a fixed real-time priority (--sched-priority=N).
+// See bench::Suite in BenchCore.hpp for the usage.
+
+
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <functional>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <vector>
+
+#if defined( __unix__ ) || defined( __APPLE__ )
+# include <cerrno>
+# include <sched.h>
+# include <sys/types.h>
+# include <sys/wait.h>
+# include <unistd.h>
+# define BENCH_HAS_FORK 1
+#else
+# define BENCH_HAS_FORK 0
+#endif
+
+
+namespace bench {
+
+/// functions which are called in the parent before a child process is forked (e.g. for a lazy initialization,
+/// which should not be repeated in each child).
+inline std::vector<void (*)()> &BeforeForkFuncs() noexcept
+{
+    static std::vector<void (*)()>  funcs;
+    return funcs;
+}
+
+/// true if the tests can be executed in child processes.
+constexpr bool IsolationAvailable() noexcept
+{
+    return BENCH_HAS_FORK != 0;
+}
+
+/// pins the calling process to the given logical cpu. returns false if not possible.
+inline bool PinCurrentProcess( unsigned int const cpu ) noexcept
+{
+#if defined( __linux__ )
+    cpu_set_t  set;
+    CPU_ZERO( &set );
+    CPU_SET( cpu, &set );
+    return sched_setaffinity( 0, sizeof( set ), &set ) == 0;
+#else
+    (void)cpu;
+    return false;
+#endif
+}
+
+/// sets a fixed real-time priority (SCHED_FIFO) for the calling process. returns false if not possible (e.g. missing permission).
+inline bool SetFixedPriority( int const priority ) noexcept
+{
+#if defined( __linux__ )
+    sched_param  param{};
+    param.sched_priority = priority;
+    return sched_setscheduler( 0, SCHED_FIFO, &param ) == 0;
+#else
+    (void)priority;
+    return false;
+#endif
+}
+
+/// executes child in a forked child process and returns the data it produced (sent via a pipe).
+/// returns std::nullopt if child returned std::nullopt, threw an exception or the child process failed.
+inline std::optional<std::string> RunInChildProcess( std::function<std::optional<std::string>()> const &child )
+{
+#if BENCH_HAS_FORK
+    for( auto const func : BeforeForkFuncs() ) {
+        func();
+    }
+    // otherwise the buffered output would be written by both processes.
+    std::cout.flush();
+    fflush( stdout );
+
+    int fds[2];
+    if( pipe( fds ) != 0 ) {
+        puts( "cannot create pipe for the child process!" );
+        return std::nullopt;
+    }
+    pid_t const pid = fork();
+    if( pid < 0 ) {
+        close( fds[0] );
+        close( fds[1] );
+        puts( "cannot fork the child process!" );
+        return std::nullopt;
+    }
+
+    if( pid == 0 ) { // the child
+        close( fds[0] );
+        int status = EXIT_FAILURE;
+        try {
+            auto const data = child();
+            if( data ) {
+                size_t done = 0;
+                while( done < data->size() ) {
+                    auto const n = write( fds[1], data->data() + done, data->size() - done );
+                    if( n < 0 && errno == EINTR ) {
+                        continue;
+                    }
+                    if( n <= 0 ) {
+                        break;
+                    }
+                    done += static_cast<size_t>(n);
+                }
+                status = done == data->size() ? EXIT_SUCCESS : EXIT_FAILURE;
+            }
+        } catch( std::exception const &ex ) {
+            puts( ex.what() );
+        }
+        std::cout.flush();
+        fflush( stdout );
+        close( fds[1] );
+        _exit( status ); // no destructors and atexit handlers of the copied state of the parent.
+    }
+
+    close( fds[1] );
+    std::string  data;
+    char         buf[4096];
+    for( ;; ) {
+        auto const n = read( fds[0], buf, sizeof( buf ) );
+        if( n < 0 && errno == EINTR ) {
+            continue;
+        }
+        if( n <= 0 ) {
+            break;
+        }
+        data.append( buf, static_cast<size_t>(n) );
+    }
+    close( fds[0] );
+
+    int status = 0;
+    while( waitpid( pid, &status, 0 ) < 0 && errno == EINTR ) {
+    }
+    if( !WIFEXITED( status ) || WEXITSTATUS( status ) != EXIT_SUCCESS ) {
+        if( WIFSIGNALED( status ) ) {
+            std::cout << "child process terminated by signal " << WTERMSIG( status ) << std::endl;
+        }
+        return std::nullopt;
+    }
+    return data;
+#else
+    (void)child;
+    return std::nullopt;
+#endif
+}
+
+} // namespace bench
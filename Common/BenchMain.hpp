@@ -0,0 +1,66 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (C) 2024 Florian Thake, <contact |at| tea-age.solutions>.
+ * SPDX-License-Identifier: MIT
+ */
+#pragma once
+
+// The common main of all benchmarks (and of Bench_Driver).
+// Parses the command line, installs the requested instrumentation, runs the benchmark entry and finishes the report.
+// The main translation unit must define BENCH_ALLOC_IMPLEMENTATION before including this header (see BenchAlloc.hpp).
+
+
+#include "BenchAlloc.hpp"
+#include "BenchCore.hpp"
+#include "BenchCmdLine.hpp"
+#include "BenchPerf.hpp"
+#include "BenchReport.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+
+
+namespace bench {
+
+/// prints the usage of the instrumentation options.
+inline void PrintInstrumentationUsage()
+{
+    std::cout << "instrumentation options:\n"
+                 "  --perf[=a,b,...]   hardware counters for the measured region (Linux only), available:\n"
+                 "                     ";
+    for( auto const &name : PerfCounterNames() ) {
+        std::cout << name << ' ';
+    }
+    std::cout << "\n"
+                 "  --alloc            count heap allocations, allocated bytes and peak live bytes of the measured region\n";
+}
+
+/// the common main, entry is the benchmark (or the dispatcher of Bench_Driver).
+inline int Main( int argc, char *argv[], int (*entry)( CmdLine const & ) )
+{
+    std::cout << std::fixed;
+    std::cout << std::setprecision( 8 );
+
+    CmdLine const  cmd( argc, argv );
+    if( cmd.Has( "help" ) ) {
+        PrintCommonUsage();
+        PrintInstrumentationUsage();
+        PrintReportUsage();
+    }
+
+    int res = EXIT_SUCCESS;
+    if( !cmd.Has( "current" ) ) { // otherwise only compare a former result.
+        EnablePerfCounters( cmd );
+        EnableAllocTracking( cmd );
+        res = entry( cmd );
+    }
+    res = FinishReport( cmd, res );
+    cmd.WarnUnused();
+
+    puts( "\n\nTest end." );
+
+    return res;
+}
+
+} // namespace bench
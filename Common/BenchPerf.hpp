@@ -0,0 +1,230 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (C) 2024 Florian Thake, <contact |at| tea-age.solutions>.
+ * SPDX-License-Identifier: MIT
+ */
+#pragma once
+
+// Hardware performance counters for the measured region via Linux perf_event_open.
+//
+// Enabled with --perf (all counters) or --perf=cycles,instructions,... The counters are enabled / disabled around
+// exactly the same region as the time measurement (see bench::RegionHook) and only count user space of the
+// calling thread. If a counter is not available (other OS, container without permission, missing PMU in a VM, ...)
+// it is skipped with a note and the benchmarks run as usual.
+
+
+#include "BenchCore.hpp"
+#include "BenchCmdLine.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#if defined( __linux__ )
+# include <linux/perf_event.h>
+# include <sys/ioctl.h>
+# include <sys/syscall.h>
+# include <unistd.h>
+# include <cerrno>
+#endif
+
+
+namespace bench {
+
+/// the names of all supported counters.
+inline std::vector<std::string> PerfCounterNames()
+{
+    return { "cycles", "instructions", "branch-misses", "L1d-misses", "LLC-misses", "dTLB-misses" };
+}
+
+#if defined( __linux__ )
+
+/// RegionHook which reads the hardware performance counters of the calling thread.
+class PerfCounters : public RegionHook
+{
+    struct Counter
+    {
+        std::string    name;
+        int            fd    = -1;
+        std::uint64_t  sum   = 0;   // sum of all regions since last Collect()
+        std::uint64_t  start[3] = {}; // value, time enabled, time running at OnStart()
+        std::uint32_t  type   = 0;
+        std::uint64_t  config = 0;
+    };
+    std::vector<Counter>  mCounters;
+    std::uint64_t         mRegions = 0;   // the measured regions since the last Collect().
+
+    static bool Config( std::string const &name, std::uint32_t &rType, std::uint64_t &rConfig )
+    {
+        auto const cache = []( std::uint64_t const id ) {
+            return id | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        };
+        rType = PERF_TYPE_HARDWARE;
+        if( name == "cycles" ) {
+            rConfig = PERF_COUNT_HW_CPU_CYCLES;
+        } else if( name == "instructions" ) {
+            rConfig = PERF_COUNT_HW_INSTRUCTIONS;
+        } else if( name == "branch-misses" ) {
+            rConfig = PERF_COUNT_HW_BRANCH_MISSES;
+        } else {
+            rType = PERF_TYPE_HW_CACHE;
+            if( name == "L1d-misses" ) {
+                rConfig = cache( PERF_COUNT_HW_CACHE_L1D );
+            } else if( name == "LLC-misses" ) {
+                rConfig = cache( PERF_COUNT_HW_CACHE_LL );
+            } else if( name == "dTLB-misses" ) {
+                rConfig = cache( PERF_COUNT_HW_CACHE_DTLB );
+            } else {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    static int Open( std::uint32_t const type, std::uint64_t const config ) noexcept
+    {
+        perf_event_attr  attr;
+        std::memset( &attr, 0, sizeof( attr ) );
+        attr.size           = sizeof( attr );
+        attr.type           = type;
+        attr.config         = config;
+        attr.disabled       = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv     = 1;
+        attr.read_format    = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        return static_cast<int>(syscall( SYS_perf_event_open, &attr, 0 /*this thread*/, -1 /*any cpu*/, -1 /*no group*/, 0 ));
+    }
+
+    // reads value, time enabled and time running.
+    static bool Read( int const fd, std::uint64_t (&rData)[3] ) noexcept
+    {
+        return read( fd, rData, sizeof( rData ) ) == static_cast<ssize_t>(sizeof( rData ));
+    }
+
+public:
+    /// opens the given counters, the not available ones are skipped with a note.
+    explicit PerfCounters( std::vector<std::string> const &names )
+    {
+        for( auto const &name : names ) {
+            std::uint32_t  type   = 0;
+            std::uint64_t  config = 0;
+            if( !Config( name, type, config ) ) {
+                std::cout << "NOTE: unknown hardware counter: " << name << std::endl;
+                continue;
+            }
+            int const fd = Open( type, config );
+            if( fd < 0 ) {
+                std::cout << "NOTE: hardware counter " << name << " not available (" << std::strerror( errno ) << ")." << std::endl;
+                continue;
+            }
+            mCounters.push_back( Counter{ name, fd, 0, type, config } );
+        }
+    }
+
+    ~PerfCounters() override
+    {
+        for( auto const &c : mCounters ) {
+            close( c.fd );
+        }
+    }
+
+    PerfCounters( PerfCounters const & ) = delete;
+    PerfCounters &operator=( PerfCounters const & ) = delete;
+
+    bool IsEmpty() const noexcept { return mCounters.empty(); }
+
+    // PERF_EVENT_IOC_RESET would clear only the value but not the times, so the start values are kept instead.
+    void OnStart() override
+    {
+        for( auto &c : mCounters ) {
+            if( !Read( c.fd, c.start ) ) {
+                std::memset( c.start, 0, sizeof( c.start ) );
+            }
+        }
+        for( auto const &c : mCounters ) {
+            ioctl( c.fd, PERF_EVENT_IOC_ENABLE, 0 );
+        }
+    }
+
+    // the inherited counters would count the thread of the parent.
+    void OnFork() override
+    {
+        for( auto &c : mCounters ) {
+            close( c.fd );
+            c.fd  = Open( c.type, c.config );
+            c.sum = 0;
+            std::memset( c.start, 0, sizeof( c.start ) );
+        }
+        mRegions = 0;
+        std::erase_if( mCounters, []( Counter const &c ) { return c.fd < 0; } );
+    }
+
+    void OnStop() override
+    {
+        for( auto const &c : mCounters ) {
+            ioctl( c.fd, PERF_EVENT_IOC_DISABLE, 0 );
+        }
+        for( auto &c : mCounters ) {
+            std::uint64_t  data[3] = {};
+            if( !Read( c.fd, data ) ) {
+                continue;
+            }
+            std::uint64_t const value   = data[0] - c.start[0];
+            std::uint64_t const enabled = data[1] - c.start[1];
+            std::uint64_t const running = data[2] - c.start[2];
+            // scale if the counter was multiplexed with others, only with the times of this region.
+            if( running > 0 && running < enabled ) {
+                c.sum += static_cast<std::uint64_t>(static_cast<double>(value) * static_cast<double>(enabled) / static_cast<double>(running));
+            } else {
+                c.sum += value;
+            }
+        }
+        ++mRegions;
+    }
+
+    // opened with pid 0 and without inherit, so the workers of RunThreaded() are not counted.
+    bool CallingThreadOnly() const noexcept override { return true; }
+
+    void Collect( Metrics &rMetrics ) override
+    {
+        if( mRegions == 0 ) { // e.g. with --threads, no values instead of zeros.
+            return;
+        }
+        mRegions = 0;
+        for( auto &c : mCounters ) {
+            rMetrics.emplace_back( c.name, static_cast<double>(c.sum) );
+            c.sum = 0;
+        }
+    }
+};
+
+#endif // __linux__
+
+
+/// enables the hardware counters if requested via --perf. returns false if none is available.
+inline bool EnablePerfCounters( CmdLine const &cmd )
+{
+    if( !cmd.Has( "perf" ) ) {
+        return false;
+    }
+    auto names = cmd.GetList( "perf" );
+    if( names.empty() || names.front() == "1" || names.front() == "all" ) {
+        names = PerfCounterNames();
+    }
+#if defined( __linux__ )
+    auto counters = std::make_unique<PerfCounters>( names );
+    if( counters->IsEmpty() ) {
+        std::cout << "NOTE: no hardware counters available, continuing without." << std::endl;
+        return false;
+    }
+    AddRegionHook( std::move( counters ) );
+    return true;
+#else
+    std::cout << "NOTE: hardware counters are only supported on Linux, continuing without." << std::endl;
+    return false;
+#endif
+}
+
+} // namespace bench
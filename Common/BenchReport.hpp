@@ -0,0 +1,638 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (C) 2024 Florian Thake, <contact |at| tea-age.solutions>.
+ * SPDX-License-Identifier: MIT
+ */
+#pragma once
+
+// Machine readable results and the comparison with a stored baseline.
+//
+// All records of a run (see bench::Records()) can be written as JSON (--json=file) and/or CSV (--csv=file).
+// With --compare=baseline.json the records are compared with the baseline. A test is flagged as regression
+// (or improvement) if the difference of the means is statistically significant (Welch's t-test, --alpha)
+// AND greater than the threshold (--threshold). The exit status is non-zero if a regression is found.
+// With --current=file the records of a former run are compared instead of running the benchmarks.
+
+
+#include "BenchCore.hpp"
+#include "BenchCmdLine.hpp"
+
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#if defined( __linux__ ) || defined( __APPLE__ )
+# include <sys/utsname.h>
+#endif
+
+
+namespace bench {
+
+/// Information about the host and the build, which is stored together with the records.
+inline Params HostInfo()
+{
+    Params  info;
+
+    std::string os = "unknown";
+    std::string hostname;
+#if defined( _WIN32 )
+    os = "Windows";
+    if( auto const name = std::getenv( "COMPUTERNAME" ); name != nullptr ) {
+        hostname = name;
+    }
+#elif defined( __linux__ ) || defined( __APPLE__ )
+    struct utsname  uts {};
+    if( uname( &uts ) == 0 ) {
+        os       = std::string( uts.sysname ) + ' ' + uts.release + ' ' + uts.machine;
+        hostname = uts.nodename;
+    }
+#endif
+    info.emplace_back( "os", os );
+    info.emplace_back( "hostname", hostname );
+
+    std::string cpu;
+#if defined( _WIN32 )
+    if( auto const id = std::getenv( "PROCESSOR_IDENTIFIER" ); id != nullptr ) {
+        cpu = id;
+    }
+#elif defined( __linux__ )
+    std::ifstream  cpuinfo( "/proc/cpuinfo" );
+    std::string    line;
+    while( std::getline( cpuinfo, line ) ) {
+        if( line.starts_with( "model name" ) ) {
+            auto const pos = line.find( ':' );
+            if( pos != std::string::npos && pos + 2 <= line.size() ) {
+                cpu = line.substr( pos + 2 );
+            }
+            break;
+        }
+    }
+#endif
+    info.emplace_back( "cpu", cpu );
+    info.emplace_back( "hardware_threads", std::to_string( std::thread::hardware_concurrency() ) );
+
+    info.emplace_back( "compiler", CompilerVersion() );
+#if defined( NDEBUG )
+    info.emplace_back( "build", "Release" );
+#else
+    info.emplace_back( "build", "Debug" );
+#endif
+
+    char  buf[32] = {};
+    auto const now = std::time( nullptr );
+    std::strftime( buf, sizeof( buf ), "%Y-%m-%dT%H:%M:%SZ", std::gmtime( &now ) );
+    info.emplace_back( "date", buf );
+
+    return info;
+}
+
+
+namespace detail {
+
+inline std::string JsonEscape( std::string const &s )
+{
+    std::string  res;
+    res.reserve( s.size() + 2 );
+    for( char const c : s ) {
+        switch( c ) {
+        case '"':  res += "\\\""; break;
+        case '\\': res += "\\\\"; break;
+        case '\n': res += "\\n"; break;
+        case '\r': res += "\\r"; break;
+        case '\t': res += "\\t"; break;
+        default:
+            if( static_cast<unsigned char>(c) < 0x20 ) {
+                char  hex[8];
+                std::snprintf( hex, sizeof( hex ), "\\u%04x", static_cast<unsigned>(c) );
+                res += hex;
+            } else {
+                res += c;
+            }
+        }
+    }
+    return res;
+}
+
+inline std::string Num( double const d )
+{
+    char  buf[32];
+    std::snprintf( buf, sizeof( buf ), "%.12g", d );
+    return buf;
+}
+
+inline std::string CsvQuote( std::string const &s )
+{
+    if( s.find_first_of( ",\"\n" ) == std::string::npos ) {
+        return s;
+    }
+    std::string  res = "\"";
+    for( char const c : s ) {
+        if( c == '"' ) {
+            res += '"';
+        }
+        res += c;
+    }
+    return res + '"';
+}
+
+inline std::string ParamsToString( Params const &params )
+{
+    std::string  res;
+    for( auto const &[name, value] : params ) {
+        if( !res.empty() ) {
+            res += ' ';
+        }
+        res += name + '=' + value;
+    }
+    return res;
+}
+
+
+/// Minimal JSON value and parser, sufficient for reading the files written by WriteJson().
+struct JsonValue
+{
+    enum class eType { Null, Bool, Number, String, Array, Object };
+    eType                                     type = eType::Null;
+    bool                                      boolean = false;
+    double                                    number  = 0.0;
+    std::string                               string;
+    std::vector<JsonValue>                    array;
+    std::vector<std::pair<std::string, JsonValue>>  object;
+
+    JsonValue const *Find( std::string const &key ) const
+    {
+        for( auto const &[k, v] : object ) {
+            if( k == key ) {
+                return &v;
+            }
+        }
+        return nullptr;
+    }
+
+    std::string GetString( std::string const &key ) const
+    {
+        auto const v = Find( key );
+        return v != nullptr && v->type == eType::String ? v->string : std::string();
+    }
+
+    double GetNumber( std::string const &key ) const
+    {
+        auto const v = Find( key );
+        return v != nullptr && v->type == eType::Number ? v->number : 0.0;
+    }
+};
+
+class JsonParser
+{
+    std::string const  &mText;
+    size_t              mPos = 0;
+
+    void SkipWs()
+    {
+        while( mPos < mText.size() && std::isspace( static_cast<unsigned char>(mText[mPos]) ) ) {
+            ++mPos;
+        }
+    }
+
+    [[noreturn]] void Fail( char const *what ) const
+    {
+        throw std::runtime_error( std::string( "JSON parse error: " ) + what + " at offset " + std::to_string( mPos ) );
+    }
+
+    void Expect( char const c )
+    {
+        SkipWs();
+        if( mPos >= mText.size() || mText[mPos] != c ) {
+            Fail( "unexpected character" );
+        }
+        ++mPos;
+    }
+
+    std::string ParseString()
+    {
+        Expect( '"' );
+        std::string  res;
+        while( mPos < mText.size() && mText[mPos] != '"' ) {
+            char c = mText[mPos++];
+            if( c == '\\' ) {
+                if( mPos >= mText.size() ) {
+                    Fail( "unterminated string" );
+                }
+                c = mText[mPos++];
+                switch( c ) {
+                case 'n': res += '\n'; break;
+                case 'r': res += '\r'; break;
+                case 't': res += '\t'; break;
+                case 'b': res += '\b'; break;
+                case 'f': res += '\f'; break;
+                case 'u':
+                    if( mPos + 4 > mText.size() ) {
+                        Fail( "invalid escape" );
+                    }
+                    // only ASCII is written by us.
+                    res += static_cast<char>(std::strtol( mText.substr( mPos, 4 ).c_str(), nullptr, 16 ) & 0x7f);
+                    mPos += 4;
+                    break;
+                default:   res += c; break;
+                }
+            } else {
+                res += c;
+            }
+        }
+        if( mPos >= mText.size() ) {
+            Fail( "unterminated string" );
+        }
+        ++mPos;
+        return res;
+    }
+
+    JsonValue ParseValue()
+    {
+        SkipWs();
+        if( mPos >= mText.size() ) {
+            Fail( "unexpected end" );
+        }
+        JsonValue  v;
+        char const c = mText[mPos];
+        if( c == '{' ) {
+            ++mPos;
+            v.type = JsonValue::eType::Object;
+            SkipWs();
+            if( mPos < mText.size() && mText[mPos] == '}' ) {
+                ++mPos;
+                return v;
+            }
+            while( true ) {
+                auto key = ParseString();
+                Expect( ':' );
+                v.object.emplace_back( std::move( key ), ParseValue() );
+                SkipWs();
+                if( mPos < mText.size() && mText[mPos] == ',' ) {
+                    ++mPos;
+                    continue;
+                }
+                Expect( '}' );
+                return v;
+            }
+        } else if( c == '[' ) {
+            ++mPos;
+            v.type = JsonValue::eType::Array;
+            SkipWs();
+            if( mPos < mText.size() && mText[mPos] == ']' ) {
+                ++mPos;
+                return v;
+            }
+            while( true ) {
+                v.array.push_back( ParseValue() );
+                SkipWs();
+                if( mPos < mText.size() && mText[mPos] == ',' ) {
+                    ++mPos;
+                    continue;
+                }
+                Expect( ']' );
+                return v;
+            }
+        } else if( c == '"' ) {
+            v.type   = JsonValue::eType::String;
+            v.string = ParseString();
+        } else if( mText.compare( mPos, 4, "true" ) == 0 ) {
+            v.type    = JsonValue::eType::Bool;
+            v.boolean = true;
+            mPos += 4;
+        } else if( mText.compare( mPos, 5, "false" ) == 0 ) {
+            v.type = JsonValue::eType::Bool;
+            mPos += 5;
+        } else if( mText.compare( mPos, 4, "null" ) == 0 ) {
+            mPos += 4;
+        } else {
+            char const *const begin = mText.c_str() + mPos;
+            char             *end   = nullptr;
+            v.type   = JsonValue::eType::Number;
+            v.number = std::strtod( begin, &end );
+            if( end == begin ) {
+                Fail( "invalid value" );
+            }
+            mPos += static_cast<size_t>(end - begin);
+        }
+        return v;
+    }
+
+public:
+    explicit JsonParser( std::string const &text ) : mText( text ) {}
+
+    JsonValue Parse()
+    {
+        auto v = ParseValue();
+        SkipWs();
+        if( mPos != mText.size() ) {
+            Fail( "trailing characters" );
+        }
+        return v;
+    }
+};
+
+} // namespace detail
+
+
+/// writes all records together with the host info as JSON.
+inline bool WriteJson( std::string const &path, std::vector<Record> const &records = Records() )
+{
+    std::ofstream  out( path, std::ios::out | std::ios::trunc );
+    if( !out ) {
+        std::cout << "Cannot write " << path << std::endl;
+        return false;
+    }
+    using detail::JsonEscape;
+    using detail::Num;
+
+    out << "{\n  \"host\": {";
+    bool first = true;
+    for( auto const &[name, value] : HostInfo() ) {
+        out << (first ? "\n" : ",\n") << "    \"" << JsonEscape( name ) << "\": \"" << JsonEscape( value ) << '"';
+        first = false;
+    }
+    out << "\n  },\n  \"records\": [";
+    first = true;
+    for( auto const &r : records ) {
+        out << (first ? "\n" : ",\n") << "    {\n";
+        first = false;
+        out << "      \"benchmark\": \"" << JsonEscape( r.benchmark ) << "\",\n";
+        out << "      \"engine\": \"" << JsonEscape( r.engine ) << "\",\n";
+        out << "      \"title\": \"" << JsonEscape( r.title ) << "\",\n";
+        out << "      \"engine_version\": \"" << JsonEscape( r.engine_version ) << "\",\n";
+        out << "      \"params\": {";
+        bool first_param = true;
+        for( auto const &[name, value] : r.params ) {
+            out << (first_param ? " " : ", ") << '"' << JsonEscape( name ) << "\": \"" << JsonEscape( value ) << '"';
+            first_param = false;
+        }
+        out << " },\n      \"samples\": [";
+        for( size_t i = 0; i < r.result.samples.size(); ++i ) {
+            out << (i == 0 ? "" : ", ") << Num( r.result.samples[i] );
+        }
+        auto const &s = r.result.stats;
+        out << "],\n      \"stats\": { \"count\": " << s.count << ", \"min\": " << Num( s.min ) << ", \"median\": " << Num( s.median )
+            << ", \"mean\": " << Num( s.mean ) << ", \"p90\": " << Num( s.p90 ) << ", \"p99\": " << Num( s.p99 ) << ", \"max\": " << Num( s.max )
+            << ", \"stddev\": " << Num( s.stddev ) << ", \"ci_low\": " << Num( s.ci_low ) << ", \"ci_high\": " << Num( s.ci_high )
+            << ", \"rel_error\": " << Num( s.rel_error ) << " }";
+        out << ",\n      \"ops\": " << Num( r.ops ) << ",\n      \"ops_unit\": \"" << JsonEscape( r.ops_unit ) << '"';
+        out << ",\n      \"metrics\": {";
+        bool first_metric = true;
+        for( auto const &[name, value] : r.result.metrics ) {
+            out << (first_metric ? " " : ", ") << '"' << JsonEscape( name ) << "\": " << Num( value );
+            first_metric = false;
+        }
+        out << " }\n    }";
+    }
+    out << "\n  ]\n}\n";
+    return static_cast<bool>(out);
+}
+
+/// writes all records as CSV, one line per record. The host info is repeated in each line.
+inline bool WriteCsv( std::string const &path, std::vector<Record> const &records = Records() )
+{
+    std::ofstream  out( path, std::ios::out | std::ios::trunc );
+    if( !out ) {
+        std::cout << "Cannot write " << path << std::endl;
+        return false;
+    }
+    using detail::CsvQuote;
+    using detail::Num;
+
+    auto const host = HostInfo();
+    out << "benchmark,engine,title,engine_version,params,count,min,median,mean,p90,p99,max,stddev,ci_low,ci_high,rel_error,samples,ops,ops_unit,metrics";
+    for( auto const &[name, value] : host ) {
+        out << ',' << name;
+    }
+    out << '\n';
+    for( auto const &r : records ) {
+        auto const &s = r.result.stats;
+        std::string samples;
+        for( auto const d : r.result.samples ) {
+            samples += (samples.empty() ? "" : ";") + Num( d );
+        }
+        std::string metrics;
+        for( auto const &[name, value] : r.result.metrics ) {
+            metrics += (metrics.empty() ? "" : ";") + name + '=' + Num( value );
+        }
+        out << CsvQuote( r.benchmark ) << ',' << CsvQuote( r.engine ) << ',' << CsvQuote( r.title ) << ',' << CsvQuote( r.engine_version ) << ','
+            << CsvQuote( detail::ParamsToString( r.params ) ) << ',' << s.count << ',' << Num( s.min ) << ',' << Num( s.median ) << ','
+            << Num( s.mean ) << ',' << Num( s.p90 ) << ',' << Num( s.p99 ) << ',' << Num( s.max ) << ',' << Num( s.stddev ) << ','
+            << Num( s.ci_low ) << ',' << Num( s.ci_high ) << ',' << Num( s.rel_error ) << ',' << samples << ','
+            << Num( r.ops ) << ',' << CsvQuote( r.ops_unit ) << ',' << CsvQuote( metrics );
+        for( auto const &[name, value] : host ) {
+            out << ',' << CsvQuote( value );
+        }
+        out << '\n';
+    }
+    return static_cast<bool>(out);
+}
+
+/// loads the records of a JSON file written by WriteJson(). throws on error.
+inline std::vector<Record> LoadJson( std::string const &path )
+{
+    std::ifstream  in( path );
+    if( !in ) {
+        throw std::runtime_error( "Cannot read " + path );
+    }
+    std::stringstream  ss;
+    ss << in.rdbuf();
+    auto const text = ss.str();
+    auto const root = detail::JsonParser( text ).Parse();
+
+    std::vector<Record>  records;
+    auto const recs = root.Find( "records" );
+    if( recs == nullptr || recs->type != detail::JsonValue::eType::Array ) {
+        throw std::runtime_error( "No records in " + path );
+    }
+    for( auto const &v : recs->array ) {
+        Record  r;
+        r.benchmark      = v.GetString( "benchmark" );
+        r.engine         = v.GetString( "engine" );
+        r.title          = v.GetString( "title" );
+        r.engine_version = v.GetString( "engine_version" );
+        if( auto const params = v.Find( "params" ); params != nullptr ) {
+            for( auto const &[name, value] : params->object ) {
+                r.params.emplace_back( name, value.string );
+            }
+        }
+        if( auto const samples = v.Find( "samples" ); samples != nullptr ) {
+            for( auto const &d : samples->array ) {
+                r.result.samples.push_back( d.number );
+            }
+        }
+        r.ops      = v.GetNumber( "ops" );
+        r.ops_unit = v.GetString( "ops_unit" );
+        if( auto const metrics = v.Find( "metrics" ); metrics != nullptr ) {
+            for( auto const &[name, value] : metrics->object ) {
+                r.result.metrics.emplace_back( name, value.number );
+            }
+        }
+        if( !r.result.samples.empty() ) {
+            r.result.stats = CalcStats( r.result.samples );
+        } else if( auto const stats = v.Find( "stats" ); stats != nullptr ) {
+            auto &s = r.result.stats;
+            s.count   = static_cast<size_t>(stats->GetNumber( "count" ));
+            s.min     = stats->GetNumber( "min" );
+            s.median  = stats->GetNumber( "median" );
+            s.mean    = stats->GetNumber( "mean" );
+            s.p90     = stats->GetNumber( "p90" );
+            s.p99     = stats->GetNumber( "p99" );
+            s.max     = stats->GetNumber( "max" );
+            s.stddev  = stats->GetNumber( "stddev" );
+            s.ci_low  = stats->GetNumber( "ci_low" );
+            s.ci_high = stats->GetNumber( "ci_high" );
+        }
+        records.push_back( std::move( r ) );
+    }
+    return records;
+}
+
+
+/// The outcome of the comparison of one test with its baseline.
+struct Comparison
+{
+    enum class eVerdict { Same, Regression, Improvement };
+    eVerdict  verdict     = eVerdict::Same;
+    double    rel_change  = 0.0;    // (current - baseline) / baseline of the means
+    double    t           = 0.0;    // Welch's t statistic
+    double    t_crit      = 0.0;    // critical value for alpha
+};
+
+/// compares the means of two results with Welch's t-test.
+inline Comparison Compare( Stats const &baseline, Stats const &current, double const threshold, double const alpha )
+{
+    Comparison  c;
+    if( baseline.mean <= 0.0 ) {
+        return c;
+    }
+    c.rel_change = (current.mean - baseline.mean) / baseline.mean;
+
+    auto const n1 = static_cast<double>(baseline.count);
+    auto const n2 = static_cast<double>(current.count);
+    if( n1 < 2.0 || n2 < 2.0 ) { // no variance, only the threshold can be used.
+        c.verdict = c.rel_change > threshold ? Comparison::eVerdict::Regression
+                  : c.rel_change < -threshold ? Comparison::eVerdict::Improvement : Comparison::eVerdict::Same;
+        return c;
+    }
+    double const v1 = baseline.stddev * baseline.stddev / n1;
+    double const v2 = current.stddev * current.stddev / n2;
+    double const se = std::sqrt( v1 + v2 );
+    if( se <= 0.0 ) {
+        c.t = c.rel_change == 0.0 ? 0.0 : (c.rel_change > 0.0 ? 1e9 : -1e9);
+    } else {
+        c.t = (current.mean - baseline.mean) / se;
+    }
+    double const df = se > 0.0 ? (v1 + v2) * (v1 + v2) / (v1 * v1 / (n1 - 1.0) + v2 * v2 / (n2 - 1.0)) : n1 + n2 - 2.0;
+    c.t_crit = detail::StudentTQuantile( 1.0 - alpha / 2.0, std::max( df, 1.0 ) );
+
+    if( std::abs( c.t ) > c.t_crit && std::abs( c.rel_change ) > threshold ) {
+        c.verdict = c.rel_change > 0.0 ? Comparison::eVerdict::Regression : Comparison::eVerdict::Improvement;
+    }
+    return c;
+}
+
+/// compares all records with the baseline records and prints the result. returns the count of regressions.
+inline int CompareWithBaseline( std::vector<Record> const &baseline, std::vector<Record> const &current, double const threshold, double const alpha )
+{
+    auto key_of = []( Record const &r ) {
+        return r.benchmark + " | " + detail::ParamsToString( r.params ) + " | " + r.engine + " | " + r.title;
+    };
+    std::map<std::string, Record const *>  base;
+    for( auto const &r : baseline ) {
+        base[key_of( r )] = &r;
+    }
+
+    auto const flags = std::cout.flags();
+    auto const prec  = std::cout.precision();
+    std::cout << "\nComparison with baseline (threshold: " << std::fixed << std::setprecision( 2 ) << threshold * 100.0
+              << " %, alpha: " << alpha << ")\n";
+
+    int regressions  = 0;
+    int improvements = 0;
+    for( auto const &r : current ) {
+        auto const key = key_of( r );
+        auto const it  = base.find( key );
+        if( it == base.end() ) {
+            std::cout << "NEW          " << key << std::endl;
+            continue;
+        }
+        auto const &b = *it->second;
+        auto const  c = Compare( b.result.stats, r.result.stats, threshold, alpha );
+        char const *verdict = "same        ";
+        if( c.verdict == Comparison::eVerdict::Regression ) {
+            verdict = "REGRESSION  ";
+            ++regressions;
+        } else if( c.verdict == Comparison::eVerdict::Improvement ) {
+            verdict = "improvement ";
+            ++improvements;
+        }
+        std::cout << verdict << ' ' << key << ": " << std::setprecision( 8 ) << b.result.stats.mean << " -> " << r.result.stats.mean
+                  << " (" << std::showpos << std::setprecision( 2 ) << c.rel_change * 100.0 << std::noshowpos << " %, t = " << c.t << ")";
+        if( b.engine_version != r.engine_version ) {
+            std::cout << " [version " << b.engine_version << " -> " << r.engine_version << ']';
+        }
+        std::cout << std::endl;
+        base.erase( it );
+    }
+    for( auto const &[key, rec] : base ) {
+        std::cout << "MISSING      " << key << std::endl;
+    }
+    std::cout << regressions << " regression(s), " << improvements << " improvement(s)." << std::endl;
+    std::cout.flags( flags );
+    std::cout.precision( prec );
+
+    return regressions;
+}
+
+
+/// prints the usage of the report options.
+inline void PrintReportUsage()
+{
+    std::cout << "report options:\n"
+                 "  --json=FILE        write all results as JSON\n"
+                 "  --csv=FILE         write all results as CSV\n"
+                 "  --compare=FILE     compare the results with a baseline (JSON), exit status is non-zero on regressions\n"
+                 "  --current=FILE     compare this former result (JSON) instead of running the benchmarks\n"
+                 "  --threshold=X      minimum relative change of the mean to be flagged (default: 0.05)\n"
+                 "  --alpha=X          significance level of the t-test (default: 0.05)\n";
+}
+
+/// writes the files and does the comparison as requested by the command line. returns the final exit status.
+inline int FinishReport( CmdLine const &cmd, int const status )
+{
+    int res = status;
+    try {
+        std::vector<Record> const  current = cmd.Has( "current" ) ? LoadJson( cmd.Get( "current" ) ) : Records();
+
+        if( cmd.Has( "json" ) && !WriteJson( cmd.Get( "json" ), current ) ) {
+            res = EXIT_FAILURE;
+        }
+        if( cmd.Has( "csv" ) && !WriteCsv( cmd.Get( "csv" ), current ) ) {
+            res = EXIT_FAILURE;
+        }
+        if( cmd.Has( "compare" ) ) {
+            auto const baseline = LoadJson( cmd.Get( "compare" ) );
+            if( CompareWithBaseline( baseline, current, cmd.GetDouble( "threshold", 0.05 ), cmd.GetDouble( "alpha", 0.05 ) ) > 0 ) {
+                res = EXIT_FAILURE;
+            }
+        }
+    } catch( std::exception const &ex ) {
+        std::cout << ex.what() << std::endl;
+        res = EXIT_FAILURE;
+    }
+    return res;
+}
+
+} // namespace bench
@@ -0,0 +1,105 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (C) 2024 Florian Thake, <contact |at| tea-age.solutions>.
+ * SPDX-License-Identifier: MIT
+ */
+#pragma once
+
+// Thread utilities for the multi-threaded benchmarks.
+//
+// A ThreadRegion synchronizes the measured regions of several worker threads: bench::Start() in a worker waits
+// until all workers have done their setup (e.g. created their own engine), bench::Stop() waits until all are done.
+// So the existing exec_* functions can run unchanged on several threads (see bench::RunThreaded() in BenchCore.hpp).
+
+
+#include <algorithm>
+#include <barrier>
+#include <chrono>
+#include <cstddef>
+#include <thread>
+
+#if defined( _WIN32 )
+# if !defined NOMINMAX
+#  define NOMINMAX
+# endif
+# if !defined WIN32_LEAN_AND_MEAN
+#  define WIN32_LEAN_AND_MEAN
+# endif
+# include <windows.h>
+#elif defined( __linux__ )
+# include <pthread.h>
+# include <sched.h>
+#endif
+
+
+namespace bench {
+
+/// pins the calling thread to the given logical cpu (modulo the count of cpus). returns false if not possible.
+inline bool PinCurrentThread( unsigned int cpu ) noexcept
+{
+    auto const cpus = std::max( std::thread::hardware_concurrency(), 1u );
+    cpu %= cpus;
+#if defined( _WIN32 )
+    if( cpu >= 64 ) {
+        return false; // only the first processor group is supported.
+    }
+    return SetThreadAffinityMask( GetCurrentThread(), DWORD_PTR( 1 ) << cpu ) != 0;
+#elif defined( __linux__ )
+    cpu_set_t  set;
+    CPU_ZERO( &set );
+    CPU_SET( cpu, &set );
+    return pthread_setaffinity_np( pthread_self(), sizeof( set ), &set ) == 0;
+#else
+    return false;
+#endif
+}
+
+/// the synchronization of the measured regions of count worker threads (plus the measuring thread).
+/// the times are taken when the last thread arrives at the barrier (not when the measuring thread wakes up).
+struct ThreadRegion
+{
+    using TimePoint = std::chrono::steady_clock::time_point;
+
+    struct TakeTime
+    {
+        TimePoint *pTime;
+        void operator()() noexcept { *pTime = std::chrono::steady_clock::now(); }
+    };
+
+    TimePoint                 start_time;
+    TimePoint                 stop_time;
+    std::barrier<TakeTime>    start;
+    std::barrier<TakeTime>    stop;
+
+    explicit ThreadRegion( std::ptrdiff_t const workers )
+        : start( workers + 1, TakeTime{ &start_time } )
+        , stop( workers + 1, TakeTime{ &stop_time } )
+    {
+    }
+};
+
+namespace detail {
+
+struct WorkerState
+{
+    ThreadRegion  *region  = nullptr;  // nullptr if not a worker
+    int            index   = -1;
+    bool           started = false;
+    bool           stopped = false;
+};
+
+/// the state of the calling thread as a worker of a ThreadRegion.
+inline WorkerState &CurrentWorker() noexcept
+{
+    thread_local WorkerState  state;
+    return state;
+}
+
+} // namespace detail
+
+/// the index of the calling worker thread or -1 if it is not a worker.
+inline int WorkerIndex() noexcept
+{
+    return detail::CurrentWorker().index;
+}
+
+} // namespace bench
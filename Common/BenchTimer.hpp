@@ -0,0 +1,264 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (C) 2024 Florian Thake, <contact |at| tea-age.solutions>.
+ * SPDX-License-Identifier: MIT
+ */
+#pragma once
+
+// A low overhead timer and helpers for measuring short regions (e.g. the C++ references).
+//
+// bench::Ticks() reads the time stamp counter (TSC) if it is invariant (x86), otherwise the steady_clock.
+// The ticks per second and the overhead of reading the timer are calibrated once on first use (see GetTimer()).
+// bench::DoNotOptimize() and bench::ClobberMemory() prevent the compiler from folding or eliminating the computation
+// of a region (e.g. fib_loop( 25 ) with a constant input could be calculated at compile time).
+// bench::MeasureBatched() repeats a short region in one batch until it takes at least Config::min_batch_secs,
+// so the resolution and the overhead of the timer do not dominate the result.
+
+
+#include "BenchCore.hpp"
+#include "BenchIsolate.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <type_traits>
+
+#if defined( _MSC_VER ) && (defined( _M_X64 ) || defined( _M_IX86 ))
+# include <intrin.h>
+# define BENCH_HAS_TSC 1
+#elif (defined( __GNUC__ ) || defined( __clang__ )) && (defined( __x86_64__ ) || defined( __i386__ ))
+# include <cpuid.h>
+# include <x86intrin.h>
+# define BENCH_HAS_TSC 1
+#else
+# define BENCH_HAS_TSC 0
+#endif
+#if defined( _MSC_VER ) && !defined( __clang__ )
+# include <intrin.h> // _ReadWriteBarrier
+#endif
+
+
+namespace bench {
+
+// for preventing optimizations...
+
+#if defined( _MSC_VER ) && !defined( __clang__ )
+namespace detail {
+inline void const volatile *volatile gOptimizerSink = nullptr;
+} // namespace detail
+
+/// the value must be computed (and is treated as read) at this point.
+template< typename T >
+inline void DoNotOptimize( T const &value ) noexcept
+{
+    detail::gOptimizerSink = &value;
+    _ReadWriteBarrier();
+}
+
+/// all pending writes to memory must be done at this point.
+inline void ClobberMemory() noexcept
+{
+    _ReadWriteBarrier();
+}
+#else
+/// the value must be computed (and is treated as read) at this point.
+template< typename T >
+inline void DoNotOptimize( T const &value ) noexcept
+{
+    asm volatile( "" : : "r,m"( value ) : "memory" );
+}
+
+/// the value must be computed and is treated as modified at this point (e.g. for an input, which is known at compile time).
+template< typename T >
+inline void DoNotOptimize( T &value ) noexcept
+{
+    if constexpr( std::is_trivially_copyable_v<T> && sizeof( T ) <= sizeof( void * ) ) {
+        asm volatile( "" : "+r,m"( value ) : : "memory" );
+    } else {
+        asm volatile( "" : "+m"( value ) : : "memory" );
+    }
+}
+
+/// all pending writes to memory must be done at this point.
+inline void ClobberMemory() noexcept
+{
+    asm volatile( "" : : : "memory" );
+}
+#endif
+
+
+// for time measurement of short regions...
+
+/// The calibrated timer.
+struct TimerInfo
+{
+    bool    tsc            = false;  // true if the TSC is used, otherwise the steady_clock (in ns).
+    double  ticks_per_sec  = 1e9;
+    double  overhead_ticks = 0.0;    // the minimum ticks between two consecutive reads.
+};
+
+namespace detail {
+
+inline std::uint64_t ReadTsc() noexcept
+{
+#if BENCH_HAS_TSC
+    // the fences keep the read in order with the measured code.
+    _mm_lfence();
+    auto const t = __rdtsc();
+    _mm_lfence();
+    return t;
+#else
+    return 0;
+#endif
+}
+
+inline std::uint64_t ReadSteadyNs() noexcept
+{
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>( Clock::now().time_since_epoch() ).count());
+}
+
+/// true if the TSC runs with a constant rate in all power states (otherwise it cannot be used as a timer).
+inline bool HasInvariantTsc() noexcept
+{
+#if BENCH_HAS_TSC
+# if defined( _MSC_VER )
+    int regs[4] = {};
+    __cpuid( regs, static_cast<int>(0x80000000u) );
+    if( static_cast<unsigned int>(regs[0]) < 0x80000007u ) {
+        return false;
+    }
+    __cpuid( regs, static_cast<int>(0x80000007u) );
+    return (regs[3] & (1 << 8)) != 0;
+# else
+    unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+    if( __get_cpuid( 0x80000007u, &eax, &ebx, &ecx, &edx ) == 0 ) {
+        return false;
+    }
+    return (edx & (1u << 8)) != 0;
+# endif
+#else
+    return false;
+#endif
+}
+
+template< typename Read >
+double MeasureTimerOverhead( Read &&read ) noexcept
+{
+    auto best = std::numeric_limits<std::uint64_t>::max();
+    for( int i = 0; i < 1000; ++i ) {
+        auto const a = read();
+        auto const b = read();
+        best = std::min<std::uint64_t>( best, b - a );
+    }
+    return static_cast<double>(best);
+}
+
+inline TimerInfo CalibrateTimer( bool const use_tsc )
+{
+    TimerInfo  info;
+    if( use_tsc && HasInvariantTsc() ) {
+        // the rate of the TSC against the steady_clock.
+        auto const c0 = Clock::now();
+        auto const t0 = ReadTsc();
+        while( Clock::now() - c0 < std::chrono::milliseconds( 20 ) ) {
+        }
+        auto const t1 = ReadTsc();
+        auto const c1 = Clock::now();
+        info.tsc            = true;
+        info.ticks_per_sec  = static_cast<double>(t1 - t0) / CalcTimeInSecs( c0, c1 );
+        info.overhead_ticks = MeasureTimerOverhead( &ReadTsc );
+    } else {
+        info.overhead_ticks = MeasureTimerOverhead( &ReadSteadyNs );
+    }
+
+    auto const flags = std::cout.flags();
+    auto const prec  = std::cout.precision();
+    std::cout << std::fixed << std::setprecision( 2 ) << "timer: ";
+    if( info.tsc ) {
+        std::cout << "TSC " << info.ticks_per_sec / 1e9 << " GHz";
+    } else {
+        std::cout << "steady_clock" << (use_tsc ? " (no invariant TSC)" : "");
+    }
+    std::cout << ", overhead " << info.overhead_ticks / info.ticks_per_sec * 1e9 << " ns (subtracted)" << std::endl;
+    std::cout.flags( flags );
+    std::cout.precision( prec );
+    return info;
+}
+
+} // namespace detail
+
+/// the timer, it is calibrated on first use (--timer=steady for use the steady_clock).
+inline TimerInfo const &GetTimer()
+{
+    static TimerInfo const  info = detail::CalibrateTimer( GetConfig().use_tsc );
+    return info;
+}
+
+namespace detail {
+// calibrate once in the parent and not in each child process of --isolate.
+inline bool const gTimerBeforeFork = (BeforeForkFuncs().push_back( [] { (void)GetTimer(); } ), true);
+} // namespace detail
+
+/// reads the timer, see GetTimer().
+inline std::uint64_t Ticks() noexcept
+{
+    return GetTimer().tsc ? detail::ReadTsc() : detail::ReadSteadyNs();
+}
+
+/// the time in seconds between the ticks s and e, the overhead of reading the timer is subtracted.
+inline double TicksToSecs( std::uint64_t const s, std::uint64_t const e ) noexcept
+{
+    auto const &timer = GetTimer();
+    double const ticks = std::max( static_cast<double>(e - s) - timer.overhead_ticks, 0.0 );
+    return ticks / timer.ticks_per_sec;
+}
+
+/// measures a short region: func() is repeated in one batch until the batch takes at least Config::min_batch_secs
+/// (the count of repetitions is determined in untimed rounds before). The batch is enclosed by Start() / Stop() and
+/// timed with Ticks(). Returns the time of one call of func in seconds and adds the metric batch-reps.
+/// func should use DoNotOptimize() for its input and result, otherwise the repetitions might be folded.
+/// NOTE: the metrics of the RegionHooks (e.g. --perf) are for the whole batch.
+///       in a worker thread of RunThreaded() the region is not batched (the wall time of all threads is measured there)
+///       and batch-reps is not added.
+template< typename F >
+double MeasureBatched( F &&func )
+{
+    (void)GetTimer(); // calibrate before.
+    double const min_secs = GetConfig().min_batch_secs;
+    long long    reps     = 1;
+    if( WorkerIndex() < 0 && min_secs > 0.0 ) {
+        for( ;; ) {
+            auto const t0 = Ticks();
+            for( long long i = 0; i < reps; ++i ) {
+                func();
+            }
+            auto const t1 = Ticks();
+            double const secs = TicksToSecs( t0, t1 );
+            if( secs >= min_secs || reps >= (1LL << 40) ) {
+                break;
+            }
+            // at least double, at most 100 times more, with some headroom.
+            double const factor = secs > 0.0 ? std::clamp( min_secs / secs * 1.2, 2.0, 100.0 ) : 100.0;
+            reps = static_cast<long long>(static_cast<double>(reps) * factor);
+        }
+    }
+
+    auto start = Start();
+    auto const t0 = Ticks();
+    for( long long i = 0; i < reps; ++i ) {
+        func();
+    }
+    auto const t1 = Ticks();
+    auto end = Stop();
+    (void)start;
+    (void)end;
+
+    if( WorkerIndex() < 0 ) { // the metrics are not thread safe (and no batching is done in the workers).
+        AddMetric( "batch-reps", static_cast<double>(reps) );
+    }
+    return TicksToSecs( t0, t1 ) / static_cast<double>(reps);
+}
+
+} // namespace bench